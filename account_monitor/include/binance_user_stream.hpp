@@ -9,6 +9,8 @@
 
 #include "https_rest_client.hpp"
 #include "json_utils.hpp"
+#include "reconnect_policy.hpp"
+#include "websocket_connector.hpp"
 
 #include "account_stream/binance_order_info.hpp"
 #include "account_stream/user_scheduled_task.hpp"
@@ -22,12 +24,9 @@ namespace ip = net::ip;
 
 // https://binance-docs.github.io/apidocs/spot/en/#user-data-streams
 class binance_stream_t : public std::enable_shared_from_this<binance_stream_t> {
-  using resolver = ip::tcp::resolver;
   using string_t = json::string_t;
   using inumber_t = json::number_integer_t;
   using fnumber_t = json::number_float_t;
-  using ssl_websocket_stream_t =
-      websocket::stream<beast::ssl_stream<beast::tcp_stream>>;
 
   static char const *const ws_host;
   static char const *const ws_port_number;
@@ -39,12 +38,11 @@ class binance_stream_t : public std::enable_shared_from_this<binance_stream_t> {
   account_info_t const m_userInfo;
 
   std::unique_ptr<https_rest_api_t> m_httpClient = nullptr;
-  std::unique_ptr<ip::tcp::resolver> m_resolver = nullptr;
   std::unique_ptr<ssl_websocket_stream_t> m_sslWebStream = nullptr;
   std::unique_ptr<beast::flat_buffer> m_buffer = nullptr;
-  std::unique_ptr<net::high_resolution_timer> m_onErrorTimer = nullptr;
   std::unique_ptr<net::high_resolution_timer> m_listenKeyTimer = nullptr;
   std::unique_ptr<std::string> m_listenKey = nullptr;
+  reconnect_policy_t m_reconnect;
   bool m_isStopped = false;
 
   friend void removeBinanceAccountStream(
@@ -55,9 +53,6 @@ private:
   void rest_api_initiate_connection();
   void rest_api_on_data_received(std::string const &data);
   void ws_initiate_connection();
-  void ws_connect_to_names(resolver::results_type const &);
-  void ws_perform_ssl_handshake(resolver::results_type::endpoint_type const &);
-  void ws_upgrade_to_websocket();
   void ws_wait_for_messages();
   void ws_interpret_generic_messages();
   void ws_process_orders_execution_report(json::object_t const &);
@@ -11,6 +11,8 @@
 #include "account_stream/user_scheduled_task.hpp"
 #include "enumerations.hpp"
 #include "json_utils.hpp"
+#include "reconnect_policy.hpp"
+#include "websocket_connector.hpp"
 #include "uri.hpp"
 #include <optional>
 #include <set>
@@ -48,14 +50,10 @@ class kucoin_user_account_stream_t
     nothing_left,
   };
 
-  using resolver = ip::tcp::resolver;
-  using results_type = resolver::results_type;
 
   net::io_context &m_ioContext;
   ssl::context &m_sslContext;
-  std::optional<resolver> m_resolver = std::nullopt;
-  std::optional<ws::stream<beast::ssl_stream<beast::tcp_stream>>>
-      m_sslWebStream = std::nullopt;
+  std::optional<ssl_websocket_stream_t> m_sslWebStream = std::nullopt;
   std::optional<beast::flat_buffer> m_readWriteBuffer = std::nullopt;
   std::optional<net::deadline_timer> m_pingTimer;
   std::unique_ptr<https_rest_api_t> m_httpClient = nullptr;
@@ -68,6 +66,7 @@ class kucoin_user_account_stream_t
   account_info_t const m_accountInfo;
   trade_type_e const m_tradeType;
   subscription_stage_e m_stage = subscription_stage_e::none;
+  reconnect_policy_t m_reconnect;
 
 public:
   kucoin_user_account_stream_t(net::io_context &ioContext,
@@ -95,11 +94,7 @@ private:
   void reset_ping_timer();
   void on_ping_timer_tick(boost::system::error_code const &);
   void report_error_and_retry(beast::error_code const);
-  void negotiate_websocket_connection();
   void initiate_websocket_connection();
-  void websocket_perform_ssl_handshake();
-  void websocket_connect_to_resolved_names(results_type const &);
-  void perform_websocket_handshake();
   void wait_for_messages();
   void send_next_subscription();
   void interpret_generic_messages();
@@ -14,6 +14,8 @@
 #include "account_stream/okex_order_info.hpp"
 #include "account_stream/user_scheduled_task.hpp"
 #include "json_utils.hpp"
+#include "reconnect_policy.hpp"
+#include "websocket_connector.hpp"
 
 namespace keep_my_journal {
 namespace net = boost::asio;
@@ -28,24 +30,17 @@ class okex_stream_t : public std::enable_shared_from_this<okex_stream_t> {
 
   net::io_context &m_ioContext;
   net::ssl::context &m_sslContext;
-  std::optional<net::ip::tcp::resolver> m_resolver = std::nullopt;
-  std::optional<websocket::stream<beast::ssl_stream<beast::tcp_stream>>>
-      m_sslWebStream = std::nullopt;
+  std::optional<ssl_websocket_stream_t> m_sslWebStream = std::nullopt;
   std::optional<account_info_t> m_accountInfo = std::nullopt;
   std::optional<std::string> m_sendingBufferText = std::nullopt;
   std::optional<beast::flat_buffer> m_buffer = std::nullopt;
-  std::optional<net::high_resolution_timer> m_timer = std::nullopt;
   okex::okex_container_t &m_streamResult;
+  reconnect_policy_t m_reconnect;
   bool m_stopped = false;
   bool m_accountsSubscribedTo = false;
 
-  using resolver_results_t = ip::tcp::resolver::results_type;
-
 private:
   void initiate_websocket_connection();
-  void connect_to_resolved_names(resolver_results_t const &);
-  void perform_ssl_handshake(resolver_results_t::endpoint_type const &);
-  void perform_websocket_handshake();
   void perform_user_login();
   void read_login_response();
   void interpret_login_response();
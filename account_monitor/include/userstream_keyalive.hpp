@@ -25,7 +25,7 @@ namespace keep_my_journal {
 class userstream_keyalive_t
     : public std::enable_shared_from_this<userstream_keyalive_t> {
 
-  using resolver = ip::tcp::resolver;
+  using results_type = ip::tcp::resolver::results_type;
 
   static char const *const host_name;
 
@@ -34,7 +34,6 @@ class userstream_keyalive_t
   std::unique_ptr<beast::flat_buffer> m_buffer;
   std::unique_ptr<http::request<http::empty_body>> m_httpRequest;
   std::unique_ptr<http::response<http::string_body>> m_httpResponse;
-  std::unique_ptr<net::ip::tcp::resolver> m_resolver;
   std::unique_ptr<beast::ssl_stream<beast::tcp_stream>> m_sslStream;
 
   std::string m_listenKey;
@@ -42,8 +41,8 @@ class userstream_keyalive_t
 
 private:
   void resolve_name();
-  void connect_to_names(resolver::results_type const &);
-  void perform_ssl_connection(resolver::results_type::endpoint_type const &);
+  void connect_to_names(results_type const &);
+  void perform_ssl_connection(results_type::endpoint_type const &);
   void renew_listen_key();
   void prepare_request();
   void send_request();
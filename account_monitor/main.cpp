@@ -2,12 +2,18 @@
 
 // monitor all account activities, buying selling deposit withdrawal (all
 // read-only)
+#include <CLI/CLI11.hpp>
 #include <boost/asio/io_context.hpp>
 #include <boost/asio/signal_set.hpp>
 #include <boost/asio/ssl/context.hpp>
 
 #include <iostream>
+#include <string>
 #include <thread>
+#include <vector>
+
+#include "dns_cache.hpp"
+#include "websocket_connector.hpp"
 
 namespace net = boost::asio;
 namespace ssl = net::ssl;
@@ -19,13 +25,38 @@ void externalAccountMessageMonitor(net::io_context &, ssl::context &,
 }
 #endif
 
-int main() {
+int main(int argc, char *argv[]) {
+  CLI::App cli_parser{"monitors the accounts' activities on the exchanges"};
+  std::vector<std::string> hostOverrides{};
+  std::string caFile{};
+  cli_parser.add_option("--host-override", hostOverrides,
+                        "host=address:port, connect to address:port whenever "
+                        "host is asked for; '*' matches every host");
+  cli_parser.add_option("--ca-file", caFile,
+                        "verify the exchanges' certificates against this CA "
+                        "file");
+  CLI11_PARSE(cli_parser, argc, argv)
+
+  auto &dnsCache = keep_my_journal::dns_cache_t::instance();
+  for (auto const &hostOverride : hostOverrides) {
+    if (!dnsCache.add_override(hostOverride)) {
+      std::cerr << "invalid host override: " << hostOverride << std::endl;
+      return EXIT_FAILURE;
+    }
+  }
+
   net::io_context ioContext(std::thread::hardware_concurrency());
   ssl::context sslContext(ssl::context::tlsv12_client);
   bool isRunning = true;
 
   sslContext.set_default_verify_paths();
-  sslContext.set_verify_mode(ssl::verify_none);
+  if (caFile.empty()) {
+    sslContext.set_verify_mode(ssl::verify_none);
+  } else {
+    sslContext.set_verify_mode(ssl::verify_peer);
+    sslContext.load_verify_file(caFile);
+  }
+  keep_my_journal::tls_session_cache_t::install(sslContext);
 
   net::signal_set signalSet(ioContext, SIGTERM);
   signalSet.add(SIGABRT);
@@ -18,14 +18,14 @@ binance_stream_t::binance_stream_t(net::io_context &ioContext,
                                    account_info_t userInfo)
     : m_ioContext(ioContext), m_sslContext(sslContext),
       m_results(binance::account_stream_sink_t::get_account_stream()),
-      m_userInfo(std::move(userInfo)), m_sslWebStream{}, m_resolver{} {}
+      m_userInfo(std::move(userInfo)), m_sslWebStream{},
+      m_reconnect(ioContext, "Binance user stream") {}
 
 binance_stream_t::~binance_stream_t() {
   if (m_sslWebStream)
     m_sslWebStream->close({});
 
   m_buffer.reset();
-  m_onErrorTimer.reset();
   m_listenKeyTimer.reset();
   m_sslWebStream.reset();
 }
@@ -34,6 +34,7 @@ void binance_stream_t::run() { rest_api_initiate_connection(); }
 
 void binance_stream_t::stop() {
   m_isStopped = true;
+  m_reconnect.cancel();
 
   if (m_sslWebStream) {
     m_sslWebStream->async_close(
@@ -47,22 +48,23 @@ void binance_stream_t::rest_api_initiate_connection() {
     return;
 
   m_listenKeyTimer.reset();
-  m_onErrorTimer.reset();
-  auto onError = [](beast::error_code const &errorCode) {
+  auto onError = [self = shared_from_this()](
+                     beast::error_code const &errorCode) {
     spdlog::error(errorCode.message());
+    self->m_reconnect.schedule(
+        [self] { self->rest_api_initiate_connection(); });
   };
 
   auto onSuccess = [self = shared_from_this()](std::string const &data) {
     self->rest_api_on_data_received(data);
   };
 
-  m_resolver = std::make_unique<resolver>(m_ioContext);
   m_sslWebStream =
       std::make_unique<ssl_websocket_stream_t>(m_ioContext, m_sslContext);
 
   m_httpClient = std::make_unique<https_rest_api_t>(
-      m_ioContext, m_sslContext, m_sslWebStream->next_layer(), *m_resolver,
-      rest_api_host, "https", "/api/v3/userDataStream");
+      m_ioContext, m_sslContext, m_sslWebStream->next_layer(), rest_api_host,
+      "https", "/api/v3/userDataStream");
   m_httpClient->insert_header("X-MBX-APIKEY", m_userInfo.apiKey);
   m_httpClient->set_method(http_method_e::post);
   m_httpClient->set_callbacks(std::move(onError), std::move(onSuccess));
@@ -89,76 +91,13 @@ void binance_stream_t::rest_api_on_data_received(std::string const &data) {
   return ws_initiate_connection();
 }
 
+// https://binance-docs.github.io/apidocs/spot/en/#user-data-streams
 void binance_stream_t::ws_initiate_connection() {
   if (m_isStopped || !m_listenKey)
     return;
 
   m_sslWebStream =
       std::make_unique<ssl_websocket_stream_t>(m_ioContext, m_sslContext);
-  m_resolver = std::make_unique<resolver>(m_ioContext);
-
-  m_resolver->async_resolve(
-      ws_host, ws_port_number,
-      [self = shared_from_this()](
-          auto const error_code,
-          net::ip::tcp::resolver::results_type const &results) {
-        if (error_code) {
-          return spdlog::error(error_code.message());
-        }
-        self->ws_connect_to_names(results);
-      });
-}
-
-void binance_stream_t::ws_connect_to_names(
-    net::ip::tcp::resolver::results_type const &resolved_names) {
-  m_resolver.reset();
-  beast::get_lowest_layer(*m_sslWebStream)
-      .expires_after(std::chrono::seconds(30));
-
-  beast::get_lowest_layer(*m_sslWebStream)
-      .async_connect(
-          resolved_names,
-          [self = shared_from_this()](
-              auto const error_code,
-              net::ip::tcp::resolver::results_type::endpoint_type const
-                  &connected_name) {
-            if (error_code) {
-              return spdlog::error(error_code.message());
-            }
-            self->ws_perform_ssl_handshake(connected_name);
-          });
-}
-
-void binance_stream_t::ws_perform_ssl_handshake(
-    net::ip::tcp::resolver::results_type::endpoint_type const &ep) {
-  auto const host = fmt::format("{}:{}", ws_host, ep.port());
-  // Set a timeout on the operation
-  beast::get_lowest_layer(*m_sslWebStream)
-      .expires_after(std::chrono::seconds(30));
-
-  // Set SNI Hostname (many hosts need this to handshake successfully)
-  if (!SSL_set_tlsext_host_name(m_sslWebStream->next_layer().native_handle(),
-                                host.c_str())) {
-    auto const ec = beast::error_code(static_cast<int>(::ERR_get_error()),
-                                      net::error::get_ssl_category());
-    return spdlog::error(ec.message());
-  }
-  m_sslWebStream->next_layer().async_handshake(
-      net::ssl::stream_base::client,
-      [self = shared_from_this()](beast::error_code const ec) {
-        if (ec) {
-          return spdlog::error(ec.message());
-        }
-        beast::get_lowest_layer(*self->m_sslWebStream).expires_never();
-        return self->ws_upgrade_to_websocket();
-      });
-}
-
-// this sends an upgrade from HTTPS to ws protocol and thus ws handshake begins
-// https://binance-docs.github.io/apidocs/spot/en/#user-data-streams
-
-void binance_stream_t::ws_upgrade_to_websocket() {
-  auto const binance_handshake_path = "/ws/" + *m_listenKey;
 
   auto opt = websock::stream_base::timeout();
   opt.idle_timeout = std::chrono::minutes(5);
@@ -168,22 +107,22 @@ void binance_stream_t::ws_upgrade_to_websocket() {
   opt.keep_alive_pings = true;
   m_sslWebStream->set_option(opt);
 
-  m_sslWebStream->control_callback(
-      [self = shared_from_this()](auto const frame_type, auto const &) {
-        if (frame_type == websock::frame_type::close) {
-          if (!self->m_isStopped)
-            return self->on_ws_connection_severed();
-        } else if (frame_type == websock::frame_type::pong) {
-          spdlog::info("pong...");
-        }
-      });
+  // a close frame fails the pending read with websocket::error::closed,
+  // which is where the connection is re-established
+  m_sslWebStream->control_callback([](auto const frame_type, auto const &) {
+    if (frame_type == websock::frame_type::pong)
+      spdlog::info("pong...");
+  });
 
-  m_sslWebStream->async_handshake(
-      ws_host, binance_handshake_path,
-      [self = shared_from_this()](beast::error_code const ec) {
-        if (ec)
-          return spdlog::error(ec.message());
+  websocket_connector_t::connect(
+      *m_sslWebStream, {ws_host, ws_port_number, "/ws/" + *m_listenKey},
+      [self = shared_from_this()](beast::error_code const &ec) {
+        if (ec) {
+          spdlog::error(ec.message());
+          return self->on_ws_connection_severed();
+        }
 
+        self->m_reconnect.on_connected();
         if (!self->m_listenKeyTimer)
           self->activate_listen_key_keepalive();
         self->ws_wait_for_messages();
@@ -333,8 +272,13 @@ void binance_stream_t::on_periodic_time_timeout() {
 }
 
 void binance_stream_t::on_ws_connection_severed() {
+  if (m_isStopped)
+    return;
+
   if (m_sslWebStream) {
-    m_sslWebStream->close({});
+    // the stream may never have been opened, or already be broken
+    beast::error_code ec{};
+    m_sslWebStream->close({}, ec);
     m_sslWebStream.reset();
   }
 
@@ -342,14 +286,8 @@ void binance_stream_t::on_ws_connection_severed() {
   m_listenKeyTimer.reset();
   m_buffer.reset();
 
-  m_onErrorTimer = std::make_unique<net::high_resolution_timer>(m_ioContext);
-  m_onErrorTimer->expires_after(std::chrono::seconds(10));
-  m_onErrorTimer->async_wait([self = shared_from_this()](auto const &ec) {
-    if (ec)
-      return spdlog::error(ec.message());
-
-    self->rest_api_initiate_connection();
-  });
+  m_reconnect.schedule(
+      [self = shared_from_this()] { self->rest_api_initiate_connection(); });
 }
 
 void binance_stream_t::activate_listen_key_keepalive() {
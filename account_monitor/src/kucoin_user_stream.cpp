@@ -11,7 +11,9 @@ kucoin_user_account_stream_t::kucoin_user_account_stream_t(
     net::io_context &ioContext, ssl::context &sslContext,
     account_info_t const &info, trade_type_e const tradeType)
     : m_ioContext(ioContext), m_sslContext(sslContext), m_accountInfo(info),
-      m_tradeType(tradeType) {}
+      m_tradeType(tradeType),
+      m_reconnect(ioContext,
+                  fmt::format("KuCoin user stream '{}'", (int)tradeType)) {}
 
 void kucoin_user_account_stream_t::run() {
   m_apiHost = rest_api_host();
@@ -19,15 +21,15 @@ void kucoin_user_account_stream_t::run() {
   rest_api_obtain_token();
 }
 
-void kucoin_user_account_stream_t::stop() {}
+void kucoin_user_account_stream_t::stop() { m_reconnect.cancel(); }
 
 void kucoin_user_account_stream_t::rest_api_obtain_token() {
-  m_resolver.emplace(m_ioContext);
   m_sslWebStream.emplace(m_ioContext, m_sslContext);
 
   auto onError = [self = shared_from_this()](beast::error_code const ec) {
     spdlog::error("KuCoin -> '{}' gave this error: {}", (int)self->m_tradeType,
                   ec.message());
+    self->report_error_and_retry(ec);
   };
 
   auto onSuccess = [self = shared_from_this()](std::string const &data) {
@@ -44,7 +46,7 @@ void kucoin_user_account_stream_t::rest_api_obtain_token() {
   message.apiVersion = {"KC-API-KEY-VERSION", "2"};
 
   m_httpClient = std::make_unique<https_rest_api_t>(
-      m_ioContext, m_sslContext, m_sslWebStream->next_layer(), *m_resolver,
+      m_ioContext, m_sslContext, m_sslWebStream->next_layer(),
       m_apiHost.c_str(), m_apiService.c_str(), "/api/v1/bullet-private");
   m_httpClient->set_method(http_method_e::post);
   m_httpClient->install_auth(std::move(message));
@@ -112,70 +114,16 @@ void kucoin_user_account_stream_t::initiate_websocket_connection() {
 
   m_uri = uri_t(m_instanceServers.back().endpoint);
   auto const service = m_uri.protocol() != "wss" ? m_uri.protocol() : "443";
-  m_resolver.emplace(m_ioContext);
-  m_resolver->async_resolve(
-      m_uri.host(), service,
-      [self = shared_from_this()](auto const &errorCode,
-                                  resolver::results_type const &results) {
-        if (errorCode)
-          return self->report_error_and_retry(errorCode);
-        self->websocket_connect_to_resolved_names(results);
-      });
-}
-
-void kucoin_user_account_stream_t::websocket_connect_to_resolved_names(
-    resolver::results_type const &resolvedNames) {
-  m_resolver.reset();
-  m_sslWebStream.emplace(m_ioContext, m_sslContext);
-
-  beast::get_lowest_layer(*m_sslWebStream)
-      .expires_after(std::chrono::seconds(30));
-  beast::get_lowest_layer(*m_sslWebStream)
-      .async_connect(resolvedNames,
-                     [self = shared_from_this()](
-                         auto const errorCode,
-                         resolver::results_type::endpoint_type const &) {
-                       if (errorCode)
-                         return self->report_error_and_retry(errorCode);
-                       self->websocket_perform_ssl_handshake();
-                     });
-}
-
-void kucoin_user_account_stream_t::websocket_perform_ssl_handshake() {
-  auto const host = m_uri.host();
-  beast::get_lowest_layer(*m_sslWebStream)
-      .expires_after(std::chrono::seconds(10));
-  if (!SSL_set_tlsext_host_name(m_sslWebStream->next_layer().native_handle(),
-                                host.c_str())) {
-    auto const errorCode = beast::error_code(
-        static_cast<int>(::ERR_get_error()), net::error::get_ssl_category());
-    return spdlog::error(errorCode.message());
-  }
-
-  negotiate_websocket_connection();
-}
-
-void kucoin_user_account_stream_t::negotiate_websocket_connection() {
-  m_sslWebStream->next_layer().async_handshake(
-      ssl::stream_base::client,
-      [self = shared_from_this()](beast::error_code const &ec) {
-        if (ec) {
-          if (ec.category() == net::error::get_ssl_category())
-            spdlog::error("SSL Category error");
-          return;
-        }
-        beast::get_lowest_layer(*self->m_sslWebStream).expires_never();
-        self->perform_websocket_handshake();
-      });
-}
-
-void kucoin_user_account_stream_t::perform_websocket_handshake() {
   auto const path = m_uri.path() + "?token=" + m_requestToken +
                     "&connectId=" + utils::getRandomString(10);
-  m_sslWebStream->async_handshake(
-      m_uri.host(), path, [self = shared_from_this()](auto const errorCode) {
+  m_sslWebStream.emplace(m_ioContext, m_sslContext);
+
+  websocket_connector_t::connect(
+      *m_sslWebStream, {m_uri.host(), service, path},
+      [self = shared_from_this()](beast::error_code const &errorCode) {
         if (errorCode)
           return self->report_error_and_retry(errorCode);
+        self->m_reconnect.on_connected();
         self->start_ping_timer();
         self->wait_for_messages();
       });
@@ -276,10 +224,8 @@ void kucoin_user_account_stream_t::report_error_and_retry(
   spdlog::error(ec.message());
   reset_ping_timer();
   reset_counter();
-
-  // wait a bit and then retry
-  std::this_thread::sleep_for(std::chrono::seconds(5));
-  rest_api_obtain_token();
+  m_reconnect.schedule(
+      [self = shared_from_this()] { self->rest_api_obtain_token(); });
 }
 
 // ======================SPOT=============================
@@ -50,14 +50,20 @@ okex_stream_t::okex_stream_t(net::io_context &ioContext,
                              ssl::context &sslContext,
                              account_info_t &&accountInfo)
     : m_ioContext{ioContext}, m_sslContext{sslContext},
-      m_sslWebStream(std::nullopt), m_resolver(std::nullopt),
-      m_accountInfo(std::move(accountInfo)),
-      m_streamResult(okex::account_stream_sink_t::get_account_stream()) {}
-
-void okex_stream_t::run() { initiate_websocket_connection(); }
+      m_sslWebStream(std::nullopt), m_accountInfo(std::move(accountInfo)),
+      m_streamResult(okex::account_stream_sink_t::get_account_stream()),
+      m_reconnect(ioContext, "OKX user stream") {}
+
+void okex_stream_t::run() {
+  // the balance snapshot is pushed when the channel is subscribed to, so a
+  // new connection has to subscribe again to catch up on what it missed
+  m_reconnect.set_resync_handler([this] { m_accountsSubscribedTo = false; });
+  initiate_websocket_connection();
+}
 
 void okex_stream_t::stop() {
   m_stopped = true;
+  m_reconnect.cancel();
 
   if (m_sslWebStream) {
     m_sslWebStream->async_close(
@@ -70,112 +76,43 @@ void okex_stream_t::stop() {
 
 void okex_stream_t::on_ws_connection_severed(std::string const &errorString) {
   spdlog::error(errorString);
+  if (m_stopped)
+    return;
 
   if (m_sslWebStream) {
-    m_sslWebStream->close({});
+    // the stream may never have been opened, or already be broken
+    beast::error_code ec{};
+    m_sslWebStream->close({}, ec);
     m_sslWebStream.reset();
   }
 
   m_buffer.reset();
-  m_stopped = false;
-
-  m_timer.emplace(m_ioContext);
-  m_timer->expires_after(std::chrono::seconds(10));
-  m_timer->async_wait([self = shared_from_this()](auto const &ec) {
-    if (ec)
-      return spdlog::error(ec.message());
-
-    self->initiate_websocket_connection();
-  });
+  m_reconnect.schedule(
+      [self = shared_from_this()] { self->initiate_websocket_connection(); });
 }
 
 void okex_stream_t::initiate_websocket_connection() {
   if (m_stopped)
     return;
 
-  m_resolver.emplace(m_ioContext);
-  m_resolver->async_resolve(
-      ws_api_host, ws_api_service,
-      [self = shared_from_this()](
-          auto const error_code,
-          net::ip::tcp::resolver::results_type const &results) {
-        if (error_code)
-          return self->on_ws_connection_severed(error_code.message());
-        self->connect_to_resolved_names(results);
-      });
-}
-
-void okex_stream_t::connect_to_resolved_names(
-    net::ip::tcp::resolver::results_type const &resolved_names) {
-
-  m_resolver.reset();
-  m_timer.reset();
-
   m_sslWebStream.emplace(m_ioContext, m_sslContext);
-  beast::get_lowest_layer(*m_sslWebStream)
-      .expires_after(std::chrono::seconds(30));
-
-  beast::get_lowest_layer(*m_sslWebStream)
-      .async_connect(
-          resolved_names,
-          [self = shared_from_this()](
-              auto const error_code,
-              net::ip::tcp::resolver::results_type::endpoint_type const
-                  &connected_name) {
-            if (error_code)
-              return self->on_ws_connection_severed(error_code.message());
-            self->perform_ssl_handshake(connected_name);
-          });
-}
-
-void okex_stream_t::perform_ssl_handshake(
-    resolver_results_t::endpoint_type const &ep) {
-  auto const host = fmt::format("{}:{}", ws_api_host, ep.port());
-
-  // Set a timeout on the operation
-  beast::get_lowest_layer(*m_sslWebStream)
-      .expires_after(std::chrono::seconds(30));
-
-  // Set SNI Hostname (many hosts need this to handshake successfully)
-  if (!SSL_set_tlsext_host_name(m_sslWebStream->next_layer().native_handle(),
-                                host.c_str())) {
-    auto const ec = beast::error_code(static_cast<int>(::ERR_get_error()),
-                                      net::error::get_ssl_category());
-    return on_ws_connection_severed(ec.message());
-  }
-
-  m_sslWebStream->next_layer().async_handshake(
-      ssl::stream_base::client,
-      [self = shared_from_this()](beast::error_code const ec) {
-        if (ec)
-          return self->on_ws_connection_severed(ec.message());
-        beast::get_lowest_layer(*self->m_sslWebStream).expires_never();
-        return self->perform_websocket_handshake();
-      });
-}
 
-void okex_stream_t::perform_websocket_handshake() {
-  static auto const okex_handshake_path = "/ws/v5/private";
   auto opt = websocket::stream_base::timeout();
-
   opt.idle_timeout = std::chrono::seconds(25);
   opt.handshake_timeout = std::chrono::seconds(20);
   // enable the automatic keepalive pings
   opt.keep_alive_pings = true;
   m_sslWebStream->set_option(opt);
-  m_sslWebStream->control_callback(
-      [self = shared_from_this()](auto const frame_type, auto const &) {
-        if (frame_type == websocket::frame_type::close) {
-          if (!self->m_stopped)
-            return self->on_ws_connection_severed("remote reset connection");
-        } else if (frame_type == websocket::frame_type::pong) {
-          spdlog::info("pong...");
-        }
-      });
+  // a close frame fails the pending read with websocket::error::closed,
+  // which is where the connection is re-established
+  m_sslWebStream->control_callback([](auto const frame_type, auto const &) {
+    if (frame_type == websocket::frame_type::pong)
+      spdlog::info("pong...");
+  });
 
-  m_sslWebStream->async_handshake(
-      ws_api_host, ws_api_service,
-      [self = shared_from_this()](beast::error_code const ec) {
+  websocket_connector_t::connect(
+      *m_sslWebStream, {ws_api_host, ws_api_service, "/ws/v5/private"},
+      [self = shared_from_this()](beast::error_code const &ec) {
         if (ec)
           return self->on_ws_connection_severed(ec.message());
         // if we're here, everything went well.
@@ -243,6 +180,7 @@ void okex_stream_t::interpret_login_response() {
     return on_ws_connection_severed(e.what());
   }
   m_buffer.reset();
+  m_reconnect.on_connected();
   subscribe_to_orders_channels();
 }
 
@@ -1,5 +1,6 @@
 // Copyright (C) 2023 Joshua and Jordan Ogunyinka
 #include "userstream_keyalive.hpp"
+#include "dns_cache.hpp"
 
 #include <boost/beast/http/read.hpp>
 #include <boost/beast/http/write.hpp>
@@ -20,7 +21,6 @@ userstream_keyalive_t::~userstream_keyalive_t() {
   m_buffer.reset();
   m_httpRequest.reset();
   m_httpResponse.reset();
-  m_resolver.reset();
   m_sslStream.reset();
 }
 
@@ -29,11 +29,10 @@ void userstream_keyalive_t::run() { resolve_name(); }
 void userstream_keyalive_t::resolve_name() {
   spdlog::info("Running keepalive_t to keep it alive...");
 
-  m_resolver = std::make_unique<resolver>(m_ioContext);
-  m_resolver->async_resolve(
-      host_name, "https",
-      [self = shared_from_this()](auto const error_code,
-                                  resolver::results_type const &results) {
+  dns_cache_t::instance().async_resolve(
+      m_ioContext.get_executor(), host_name, "https",
+      [self = shared_from_this()](auto const &error_code,
+                                  results_type const &results) {
         if (error_code)
           return spdlog::error(error_code.message());
         self->connect_to_names(results);
@@ -41,8 +40,7 @@ void userstream_keyalive_t::resolve_name() {
 }
 
 void userstream_keyalive_t::connect_to_names(
-    resolver::results_type const &resolved_names) {
-  m_resolver.reset();
+    results_type const &resolved_names) {
   m_sslStream = std::make_unique<beast::ssl_stream<beast::tcp_stream>>(
       m_ioContext, m_sslContext);
   beast::get_lowest_layer(*m_sslStream).expires_after(std::chrono::seconds(30));
@@ -50,15 +48,17 @@ void userstream_keyalive_t::connect_to_names(
       .async_connect(resolved_names,
                      [self = shared_from_this()](
                          beast::error_code const error_code,
-                         resolver::results_type::endpoint_type const &ip) {
-                       if (error_code)
+                         results_type::endpoint_type const &ip) {
+                       if (error_code) {
+                         dns_cache_t::instance().invalidate(host_name, "https");
                          return spdlog::error(error_code.message());
+                       }
                        self->perform_ssl_connection(ip);
                      });
 }
 
 void userstream_keyalive_t::perform_ssl_connection(
-    resolver::results_type::endpoint_type const &connected_name) {
+    results_type::endpoint_type const &connected_name) {
   auto const host = fmt::format("{}:{}", host_name, connected_name.port());
 
   // Set a timeout on the operation
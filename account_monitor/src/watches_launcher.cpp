@@ -10,8 +10,10 @@
 #include "account_stream/binance_order_info.hpp"
 #include "account_stream/okex_order_info.hpp"
 #include "account_stream/user_scheduled_task.hpp"
+#include "allocation_counter.hpp"
 #include "macro_defines.hpp"
 #include "string_utils.hpp"
+#include "zmq_buffer.hpp"
 
 namespace net = boost::asio;
 namespace ssl = net::ssl;
@@ -70,14 +72,16 @@ void exchangeResultWatcher(std::string const &exchangeName,
   zmq::socket_t writerSocket(msgContext, zmq::socket_type::pub);
   writerSocket.bind(address);
   msgpack::sbuffer outBuffer;
+  allocation_stats_t allocationStats(
+      fmt::format("account_monitor {} results", exchangeName));
 
   while (isRunning) {
     variant_type_t data = resultStream.get();
     msgpack::pack(outBuffer, data);
-    zmq::message_t msg(outBuffer.data(), outBuffer.size());
+    // handed to zmq as packed, `outBuffer` starts over empty
+    auto msg = release_to_message(outBuffer);
     writerSocket.send(msg, zmq::send_flags::none);
-
-    outBuffer.clear();
+    allocationStats.messages_done();
   }
 }
 
@@ -6,10 +6,12 @@
 
 #include "account_stream/binance_order_info.hpp"
 #include "account_stream/okex_order_info.hpp"
+#include "allocation_counter.hpp"
 #include "container.hpp"
 #include "http_rest_client.hpp"
 #include "json_utils.hpp"
 #include "macro_defines.hpp"
+#include "msgpack_reader.hpp"
 
 namespace keep_my_journal {
 namespace utils {
@@ -55,17 +57,24 @@ template <typename AccountMsgType>
     http_send_result(ioContext, resultContainer, exchange);
   }}.detach();
 
+  msgpack_reader_t reader{};
+  zmq::message_t message{};
+  allocation_stats_t allocationStats(fmt::format(
+      "account_tasks {} results", utils::exchangesToString(exchange)));
+
   while (true) {
-    zmq::message_t message{};
     if (auto const optRecv = receivingSocket.recv(message);
         !optRecv.has_value()) {
       spdlog::error("unable to receive valid message from socket");
       continue;
     }
 
-    auto oh = msgpack::unpack((char const *)message.data(), message.size());
-    AccountMsgType accountMsgType{oh.get().as<AccountMsgType>()};
+    // the zone is reused and strings are read out of the message itself,
+    // only the result handed on is allocated
+    AccountMsgType accountMsgType{};
+    reader.read(message.to_string_view(), accountMsgType);
     resultContainer.append(std::move(accountMsgType));
+    allocationStats.messages_done();
   }
 }
 } // namespace keep_my_journal
@@ -0,0 +1,89 @@
+// Copyright (C) 2023-2024 Joshua and Jordan Ogunyinka
+
+// what turning an exchange's price string into a number costs: std::stod on
+// a std::string, as the streams did, against `parse_decimal` on the view
+// into the frame. The strings look like the ones exchanges send, 2 to 10
+// decimal places and prices from fractions of a cent to tens of thousands.
+//
+//   decimal_parse_bench [strings] [rounds]
+#include <spdlog/spdlog.h>
+
+#include <chrono>
+#include <cmath>
+#include <cstdlib>
+#include <random>
+#include <string>
+#include <string_view>
+#include <vector>
+
+#include "decimal.hpp"
+
+namespace keep_my_journal {
+namespace {
+std::vector<std::string> make_prices(std::size_t const count) {
+  std::mt19937 random(42);
+  std::uniform_real_distribution<double> magnitude(-4.0, 5.0);
+  std::uniform_int_distribution<int> places(2, 10);
+  std::vector<std::string> prices(count);
+  for (auto &price : prices)
+    price = fmt::format("{:.{}f}", std::pow(10.0, magnitude(random)),
+                        places(random));
+  return prices;
+}
+
+template <typename Func>
+double nanos_per_string(std::vector<std::string> const &prices,
+                        std::size_t const rounds, Func &&func) {
+  auto const start = std::chrono::steady_clock::now();
+  for (std::size_t round = 0; round < rounds; ++round) {
+    for (auto const &price : prices)
+      func(price);
+  }
+  return std::chrono::duration<double, std::nano>(
+             std::chrono::steady_clock::now() - start)
+             .count() /
+         static_cast<double>(rounds * prices.size());
+}
+} // namespace
+} // namespace keep_my_journal
+
+int main(int argc, char *argv[]) {
+  using namespace keep_my_journal;
+
+  std::size_t const count =
+      argc > 1 ? std::strtoull(argv[1], nullptr, 10) : 10'000;
+  std::size_t const rounds =
+      argc > 2 ? std::strtoull(argv[2], nullptr, 10) : 100;
+  if (count == 0 || rounds == 0) {
+    spdlog::error("usage: {} [strings] [rounds]", argv[0]);
+    return EXIT_FAILURE;
+  }
+
+  auto const prices = make_prices(count);
+  // sums of what was parsed, so neither loop can be optimised out
+  double doubleSum = 0.0;
+  std::uint64_t decimalSum = 0;
+  std::size_t failures = 0;
+
+  auto const stodNanos =
+      nanos_per_string(prices, rounds, [&](std::string const &price) {
+        // the streams copied the json string out before converting it
+        std::string const copy(std::string_view{price});
+        doubleSum += std::stod(copy);
+      });
+  auto const decimalNanos =
+      nanos_per_string(prices, rounds, [&](std::string const &price) {
+        decimal_t value;
+        if (parse_decimal(price, value))
+          decimalSum += static_cast<std::uint64_t>(value.mantissa);
+        else
+          ++failures;
+      });
+
+  spdlog::info("{} strings, {} rounds", count, rounds);
+  spdlog::info("std::stod       {:>8.1f} ns/string (sum {:.3f})", stodNanos,
+               doubleSum);
+  spdlog::info("parse_decimal   {:>8.1f} ns/string (sum {}, {} failed)",
+               decimalNanos, decimalSum, failures);
+  return failures == 0 ? EXIT_SUCCESS : EXIT_FAILURE;
+}
@@ -0,0 +1,163 @@
+// Copyright (C) 2023-2024 Joshua and Jordan Ogunyinka
+
+// the latest-price store under the load a consumer puts on it: one thread
+// writes batches of prices the way the feed client does, at a set rate,
+// while reader threads look single instruments up as fast as they can,
+// every hundredth lookup listing the whole store as /trading_pairs does. It
+// runs against `instrument_store_t` and the single-mutex set it replaced,
+// and prints the lookups done per second across the readers and how long
+// the writer took per batch.
+//
+//   instrument_store_bench [seconds per run] [symbols] [prices per second]
+//
+// A rate of 0 has the writer store batches back to back.
+#include <spdlog/spdlog.h>
+
+#include <atomic>
+#include <chrono>
+#include <cstdlib>
+#include <random>
+#include <string>
+#include <thread>
+#include <vector>
+
+#include "container.hpp"
+#include "latency_histogram.hpp"
+#include "price_stream/instrument_store.hpp"
+
+namespace keep_my_journal {
+namespace {
+constexpr std::size_t batch_size = 64;
+// one in this many lookups lists every instrument
+constexpr std::size_t list_every = 100;
+
+struct config_t {
+  std::chrono::milliseconds duration{2000};
+  std::size_t symbols = 2000;
+  std::size_t pricesPerSecond = 50'000;
+};
+
+// each reader's count on a cache line of its own
+struct alignas(64) reader_count_t {
+  std::uint64_t lookups = 0;
+};
+
+std::vector<instrument_type_t> make_instruments(std::size_t const count) {
+  std::vector<instrument_type_t> instruments(count);
+  for (std::size_t i = 0; i < count; ++i) {
+    auto &instrument = instruments[i];
+    instrument.name = "BENCH" + std::to_string(i) + "USDT";
+    instrument.tradeType = trade_type_e::spot;
+    instrument.currentPrice = decimal_t(1'234'567 + std::int64_t(i), -4);
+    instrument.open24h = decimal_t(1'200'000 + std::int64_t(i), -4);
+  }
+  return instruments;
+}
+
+template <typename Store>
+void run(char const *name, std::size_t const readerCount,
+         config_t const &config) {
+  Store store;
+  auto instruments = make_instruments(config.symbols);
+  store.insert_list(instruments.begin(), instruments.end());
+
+  std::atomic<bool> isRunning{true};
+  std::vector<reader_count_t> counts(readerCount);
+  std::vector<std::thread> readers;
+  readers.reserve(readerCount);
+  for (std::size_t r = 0; r < readerCount; ++r) {
+    readers.emplace_back([&, r] {
+      std::mt19937 random(static_cast<unsigned>(r));
+      auto &count = counts[r].lookups;
+      while (isRunning.load(std::memory_order_relaxed)) {
+        if (++count % list_every == 0) {
+          auto const list = store.to_list();
+          (void)list;
+        } else {
+          auto const found =
+              store.find_item(instruments[random() % instruments.size()]);
+          (void)found;
+        }
+      }
+    });
+  }
+
+  // nanoseconds per batch, in the histogram's power-of-two buckets
+  latency_histogram_t batchTimes;
+  std::size_t written = 0;
+  std::mt19937 random(42);
+  auto const interval =
+      config.pricesPerSecond == 0
+          ? std::chrono::nanoseconds::zero()
+          : std::chrono::nanoseconds(1'000'000'000 * std::int64_t(batch_size) /
+                                     std::int64_t(config.pricesPerSecond));
+  auto const start = std::chrono::steady_clock::now();
+  auto const end = start + config.duration;
+  auto next = start;
+  std::vector<instrument_type_t> batch(batch_size);
+
+  while (std::chrono::steady_clock::now() < end) {
+    for (auto &instrument : batch) {
+      instrument = instruments[random() % instruments.size()];
+      instrument.currentPrice.mantissa += std::int64_t(random() % 201) - 100;
+    }
+
+    auto const before = std::chrono::steady_clock::now();
+    store.insert_list(batch.begin(), batch.end());
+    batchTimes.record(std::chrono::duration_cast<std::chrono::nanoseconds>(
+                          std::chrono::steady_clock::now() - before)
+                          .count());
+    written += batch.size();
+
+    if (interval != std::chrono::nanoseconds::zero()) {
+      next += interval;
+      std::this_thread::sleep_until(next);
+    }
+  }
+  auto const elapsed = std::chrono::duration<double>(
+                           std::chrono::steady_clock::now() - start)
+                           .count();
+
+  isRunning = false;
+  for (auto &reader : readers)
+    reader.join();
+
+  std::uint64_t lookups = 0;
+  for (auto const &count : counts)
+    lookups += count.lookups;
+  auto const summary = batchTimes.summary();
+  spdlog::info("{:<18} {:>2} readers {:>12.0f} lookups/s, {:>9.0f} prices/s "
+               "written, batch p50 {} ns p99 {} ns max {} ns",
+               name, readerCount, static_cast<double>(lookups) / elapsed,
+               static_cast<double>(written) / elapsed, summary.p50,
+               summary.p99, summary.max);
+}
+} // namespace
+} // namespace keep_my_journal
+
+int main(int argc, char *argv[]) {
+  using namespace keep_my_journal;
+
+  config_t config{};
+  if (argc > 1)
+    config.duration = std::chrono::milliseconds(
+        1000 * std::strtoull(argv[1], nullptr, 10));
+  if (argc > 2)
+    config.symbols = std::strtoull(argv[2], nullptr, 10);
+  if (argc > 3)
+    config.pricesPerSecond = std::strtoull(argv[3], nullptr, 10);
+  if (config.duration.count() == 0 || config.symbols == 0) {
+    spdlog::error("usage: {} [seconds per run] [symbols] [prices per second]",
+                  argv[0]);
+    return EXIT_FAILURE;
+  }
+
+  spdlog::info("{} symbols, {} prices/s in batches of {}", config.symbols,
+               config.pricesPerSecond, batch_size);
+  for (std::size_t const readers : {1, 4, 16}) {
+    run<utils::unique_elements_t<instrument_type_t>>("mutexed set", readers,
+                                                      config);
+    run<instrument_store_t>("instrument store", readers, config);
+  }
+  return EXIT_SUCCESS;
+}
@@ -0,0 +1,207 @@
+// Copyright (C) 2023-2024 Joshua and Jordan Ogunyinka
+
+// what an instrument costs to keep and to look up in a flat table, columns
+// indexed by an `instrument_index_t` row behind one mutex, against
+// `utils::unique_elements_t` that it would be a drop-in for and the
+// `instrument_store_t` consumers use. Each container is
+// filled with the same instruments, then every one of them is looked up in
+// a shuffled order, then their prices are stored again in batches. Memory
+// is what the heap grew by while filling, where glibc can tell.
+//
+//   instrument_table_bench [symbols] [rounds]
+#include <spdlog/spdlog.h>
+
+#include <algorithm>
+#include <chrono>
+#include <cstdlib>
+#include <memory>
+#include <mutex>
+#include <optional>
+#include <random>
+#include <string>
+#include <vector>
+
+#ifdef __GLIBC__
+#include <malloc.h>
+#endif
+
+#include "container.hpp"
+#include "price_stream/instrument_index.hpp"
+#include "price_stream/instrument_store.hpp"
+
+namespace keep_my_journal {
+namespace {
+constexpr std::size_t batch_size = 64;
+
+struct config_t {
+  std::size_t symbols = 5000;
+  std::size_t rounds = 200;
+};
+
+// the latest price of every instrument as `unique_elements_t` keeps them,
+// but flat: each field in a column of its own, indexed by the instrument's
+// row in the index
+class instrument_table_t {
+  mutable std::mutex m_mutex{};
+  instrument_index_t m_index{};
+  std::vector<std::int64_t> m_priceMantissas{};
+  std::vector<std::int64_t> m_open24hMantissas{};
+  std::vector<std::int32_t> m_priceExponents{};
+  std::vector<std::int32_t> m_open24hExponents{};
+  std::vector<std::int64_t> m_exchangeTimes{};
+  std::vector<std::int64_t> m_receivedTimes{};
+  std::vector<std::int64_t> m_publishedTimes{};
+
+  void insert_impl(instrument_type_t const &instrument) {
+    if (instrument.tradeType >= trade_type_e::total)
+      return;
+
+    auto const row = m_index.insert(instrument.tradeType, instrument.name);
+    if (row == m_priceMantissas.size()) {
+      m_priceMantissas.emplace_back();
+      m_open24hMantissas.emplace_back();
+      m_priceExponents.emplace_back();
+      m_open24hExponents.emplace_back();
+      m_exchangeTimes.emplace_back();
+      m_receivedTimes.emplace_back();
+      m_publishedTimes.emplace_back();
+    }
+
+    m_priceMantissas[row] = instrument.currentPrice.mantissa;
+    m_priceExponents[row] = instrument.currentPrice.exponent;
+    m_open24hMantissas[row] = instrument.open24h.mantissa;
+    m_open24hExponents[row] = instrument.open24h.exponent;
+    m_exchangeTimes[row] = instrument.timestamps.exchange;
+    m_receivedTimes[row] = instrument.timestamps.received;
+    m_publishedTimes[row] = instrument.timestamps.published;
+  }
+
+public:
+  template <typename Iter> void insert_list(Iter first, Iter const last) {
+    std::lock_guard<std::mutex> lockGuard(m_mutex);
+    for (; first != last; ++first)
+      insert_impl(*first);
+  }
+
+  std::optional<instrument_type_t>
+  find_item(instrument_type_t const &instrument) const {
+    std::lock_guard<std::mutex> lockGuard(m_mutex);
+    auto const row = m_index.find(instrument.tradeType, instrument.name);
+    if (row == instrument_index_t::npos)
+      return std::nullopt;
+
+    instrument_type_t result{};
+    result.name = m_index.name(row);
+    result.tradeType = m_index.trade_type(row);
+    result.currentPrice =
+        decimal_t(m_priceMantissas[row], m_priceExponents[row]);
+    result.open24h =
+        decimal_t(m_open24hMantissas[row], m_open24hExponents[row]);
+    result.timestamps.exchange = m_exchangeTimes[row];
+    result.timestamps.received = m_receivedTimes[row];
+    result.timestamps.published = m_publishedTimes[row];
+    return result;
+  }
+};
+
+std::size_t heap_in_use() {
+#if defined(__GLIBC__) && (__GLIBC__ > 2 || __GLIBC_MINOR__ >= 33)
+  return mallinfo2().uordblks;
+#else
+  return 0;
+#endif
+}
+
+std::vector<instrument_type_t> make_instruments(std::size_t const count) {
+  static constexpr trade_type_e trade_types[] = {
+      trade_type_e::spot, trade_type_e::futures, trade_type_e::swap};
+  std::vector<instrument_type_t> instruments(count);
+  for (std::size_t i = 0; i < count; ++i) {
+    auto &instrument = instruments[i];
+    // real symbols are mostly short enough for the small-string buffer
+    instrument.name = "B" + std::to_string(i / 3) + "USDT";
+    instrument.tradeType = trade_types[i % 3];
+    instrument.currentPrice = decimal_t(1'234'567 + std::int64_t(i), -4);
+    instrument.open24h = decimal_t(1'200'000 + std::int64_t(i), -4);
+  }
+  return instruments;
+}
+
+double nanos_since(std::chrono::steady_clock::time_point const start) {
+  return std::chrono::duration<double, std::nano>(
+             std::chrono::steady_clock::now() - start)
+      .count();
+}
+
+template <typename Store>
+void run(char const *name, std::vector<instrument_type_t> const &instruments,
+         std::vector<std::size_t> const &order, config_t const &config) {
+  auto const heapBefore = heap_in_use();
+  auto store = std::make_unique<Store>();
+  store->insert_list(instruments.begin(), instruments.end());
+  auto const heapUsed = heap_in_use() - heapBefore;
+
+  // a checksum of what's found, so the lookups can't be optimised out
+  std::int64_t found = 0;
+  auto start = std::chrono::steady_clock::now();
+  for (std::size_t round = 0; round < config.rounds; ++round) {
+    for (auto const i : order) {
+      if (auto const item = store->find_item(instruments[i]); item)
+        found += item->currentPrice.mantissa;
+    }
+  }
+  auto const lookups = config.rounds * order.size();
+  auto const nanosPerLookup =
+      nanos_since(start) / static_cast<double>(lookups);
+
+  std::vector<instrument_type_t> batch(batch_size);
+  std::mt19937 random(42);
+  start = std::chrono::steady_clock::now();
+  for (std::size_t round = 0; round < config.rounds; ++round) {
+    for (std::size_t i = 0; i < instruments.size(); i += batch_size) {
+      for (auto &instrument : batch)
+        instrument = instruments[random() % instruments.size()];
+      store->insert_list(batch.begin(), batch.end());
+    }
+  }
+  auto const writes =
+      config.rounds * ((instruments.size() + batch_size - 1) / batch_size) *
+      batch_size;
+  auto const nanosPerWrite = nanos_since(start) / static_cast<double>(writes);
+
+  spdlog::info("{:<16} {:>6} B/instrument, lookup {:>6.1f} ns, "
+               "write {:>6.1f} ns (checksum {})",
+               name, heapUsed / instruments.size(), nanosPerLookup,
+               nanosPerWrite, found);
+}
+} // namespace
+} // namespace keep_my_journal
+
+int main(int argc, char *argv[]) {
+  using namespace keep_my_journal;
+
+  config_t config{};
+  if (argc > 1)
+    config.symbols = std::strtoull(argv[1], nullptr, 10);
+  if (argc > 2)
+    config.rounds = std::strtoull(argv[2], nullptr, 10);
+  if (config.symbols == 0 || config.rounds == 0) {
+    spdlog::error("usage: {} [symbols] [rounds]", argv[0]);
+    return EXIT_FAILURE;
+  }
+
+  auto const instruments = make_instruments(config.symbols);
+  std::vector<std::size_t> order(instruments.size());
+  for (std::size_t i = 0; i < order.size(); ++i)
+    order[i] = i;
+  std::shuffle(order.begin(), order.end(), std::mt19937(7));
+
+  if (heap_in_use() == 0)
+    spdlog::warn("the heap can't be measured here, memory shows as 0");
+  spdlog::info("{} instruments, {} rounds", config.symbols, config.rounds);
+  run<utils::unique_elements_t<instrument_type_t>>("unique elements",
+                                                   instruments, order, config);
+  run<instrument_store_t>("instrument store", instruments, order, config);
+  run<instrument_table_t>("instrument table", instruments, order, config);
+  return EXIT_SUCCESS;
+}
@@ -0,0 +1,226 @@
+// Copyright (C) 2023-2024 Joshua and Jordan Ogunyinka
+
+// what the price pipeline pays per message at either end of zmq:
+//   send    packing a batch and copying it into a zmq message, or handing
+//           the packed buffer to zmq as it is
+//   decode  unpacking a batch into a fresh vector and moving that into the
+//           instrument set (as the watchers did), or decoding into reused
+//           state and writing into the store, or the same from the binary
+//           format of price_binary.hpp
+// Allocations are only counted when built with ENABLE_ALLOCATION_COUNTING.
+//
+//   msgpack_zmq_bench [messages] [records per message]
+#include <cppzmq/zmq.hpp>
+#include <spdlog/spdlog.h>
+
+#include <chrono>
+#include <cstdlib>
+#include <string>
+#include <thread>
+#include <vector>
+
+#include "allocation_counter.hpp"
+#include "latency_histogram.hpp"
+#include "price_stream/commodity.hpp"
+#include "price_stream/instrument_store.hpp"
+#include "price_stream/price_wire.hpp"
+#include "price_stream/symbol_registry.hpp"
+#include "zmq_buffer.hpp"
+
+namespace keep_my_journal {
+namespace {
+constexpr auto bench_exchange = exchange_e::binance;
+
+struct result_t {
+  double nanosPerMessage = 0.0;
+  double allocationsPerMessage = 0.0;
+};
+
+template <typename Func>
+result_t measure(std::size_t const count, Func &&func) {
+  auto const allocations = thread_allocations();
+  auto const start = std::chrono::steady_clock::now();
+  for (std::size_t i = 0; i < count; ++i)
+    func(i);
+  auto const elapsed = std::chrono::steady_clock::now() - start;
+
+  result_t result{};
+  result.nanosPerMessage =
+      static_cast<double>(
+          std::chrono::duration_cast<std::chrono::nanoseconds>(elapsed)
+              .count()) /
+      static_cast<double>(count);
+  result.allocationsPerMessage =
+      static_cast<double>(thread_allocations() - allocations) /
+      static_cast<double>(count);
+  return result;
+}
+
+void print(char const *name, result_t const &result) {
+  if (allocations_counted())
+    spdlog::info("{:<24} {:>10.1f} ns/message {:>8.2f} allocations/message",
+                 name, result.nanosPerMessage, result.allocationsPerMessage);
+  else
+    spdlog::info("{:<24} {:>10.1f} ns/message", name, result.nanosPerMessage);
+}
+
+std::vector<price_record_t> make_records(std::size_t const count) {
+  auto &registry = symbol_registry_t::get(bench_exchange);
+  std::vector<price_record_t> records(count);
+  for (std::size_t i = 0; i < count; ++i) {
+    auto &record = records[i];
+    record.id = registry.intern(trade_type_e::spot,
+                                "BENCH" + std::to_string(i) + "USDT");
+    record.currentPrice = decimal_t(1'234'567 + std::int64_t(i), -4);
+    record.open24h = decimal_t(1'200'000 + std::int64_t(i), -4);
+    record.timestamps.received = micros_since_epoch();
+  }
+  return records;
+}
+
+// `copy` picks how the packed buffer becomes a message; the receiving end
+// only drains the socket
+result_t bench_send(zmq::context_t &context, std::size_t const messages,
+                    std::vector<price_record_t> const &records,
+                    bool const copy) {
+  auto const address =
+      std::string("inproc://msgpack_zmq_bench_") + (copy ? "copy" : "zero");
+  zmq::socket_t receiver(context, zmq::socket_type::pull);
+  receiver.bind(address);
+  std::thread drain([&receiver, messages] {
+    zmq::message_t message;
+    for (std::size_t i = 0; i < messages; ++i)
+      (void)receiver.recv(message, zmq::recv_flags::none);
+  });
+
+  zmq::socket_t sender(context, zmq::socket_type::push);
+  sender.connect(address);
+  msgpack::sbuffer buffer;
+  auto const result = measure(messages, [&](std::size_t) {
+    pack_price_batch(buffer, records.data(), records.size());
+    if (copy) {
+      zmq::message_t message(std::string_view(buffer.data(), buffer.size()));
+      buffer.clear();
+      (void)sender.send(message, zmq::send_flags::none);
+    } else {
+      auto message = release_to_message(buffer);
+      (void)sender.send(message, zmq::send_flags::none);
+    }
+  });
+
+  drain.join();
+  return result;
+}
+
+// the watchers' decoding before `price_message_decoder_t`
+void fresh_unpack(std::string_view const message,
+                  symbol_registry_t const &registry,
+                  std::vector<instrument_type_t> &result) {
+  std::size_t offset = 0;
+  auto const header = msgpack::unpack(message.data(), message.size(), offset);
+  (void)header.get().as<price_message_type_e>();
+  auto const payload = msgpack::unpack(message.data(), message.size(), offset);
+  auto const &records = payload.get();
+  price_record_t record;
+  for (std::uint32_t i = 0; i < records.via.array.size; ++i) {
+    records.via.array.ptr[i].convert(record);
+    auto const *symbol = registry.find_symbol(record.id);
+    if (!symbol)
+      continue;
+
+    instrument_type_t instrument;
+    instrument.name = symbol->name;
+    instrument.tradeType = symbol->tradeType;
+    instrument.currentPrice = record.currentPrice;
+    instrument.open24h = record.open24h;
+    instrument.timestamps = record.timestamps;
+    result.push_back(std::move(instrument));
+  }
+}
+
+result_t bench_decode(std::size_t const messages,
+                      std::vector<price_record_t> const &records,
+                      bool const fresh) {
+  msgpack::sbuffer buffer;
+  pack_price_batch(buffer, records.data(), records.size());
+  std::string_view const message(buffer.data(), buffer.size());
+  auto &registry = symbol_registry_t::get(bench_exchange);
+
+  if (fresh) {
+    utils::unique_elements_t<instrument_type_t> instruments;
+    std::vector<instrument_type_t> decoded;
+    return measure(messages, [&](std::size_t) {
+      decoded.clear();
+      fresh_unpack(message, registry, decoded);
+      instruments.insert_list(std::move(decoded));
+    });
+  }
+
+  instrument_store_t instruments;
+  price_message_decoder_t decoder;
+  return measure(messages, [&](std::size_t) {
+    decoder.decode(message, registry);
+    instruments.insert_list(decoder.begin(), decoder.end());
+  });
+}
+result_t bench_binary_decode(std::size_t const messages,
+                             std::vector<price_record_t> const &records) {
+  // all full records: a delta frame decoded twice would be dropped
+  msgpack::sbuffer buffer;
+  price_binary_encoder_t{}.encode_batch(buffer, records.data(),
+                                        records.size());
+  std::string_view const message(buffer.data(), buffer.size());
+  auto &registry = symbol_registry_t::get(bench_exchange);
+  instrument_store_t instruments;
+
+  price_message_decoder_t decoder;
+  return measure(messages, [&](std::size_t) {
+    decoder.decode(message, registry);
+    instruments.insert_list(decoder.begin(), decoder.end());
+  });
+}
+
+// bytes per frame: msgpack, binary in full, and binary once every price
+// has moved a little since the last frame
+void print_frame_sizes(std::vector<price_record_t> records) {
+  msgpack::sbuffer buffer;
+  pack_price_batch(buffer, records.data(), records.size());
+  auto const msgpackSize = buffer.size();
+
+  price_binary_encoder_t encoder;
+  buffer.clear();
+  encoder.encode_batch(buffer, records.data(), records.size());
+  auto const fullSize = buffer.size();
+
+  for (auto &record : records)
+    record.currentPrice.mantissa += 25;
+  buffer.clear();
+  encoder.encode_batch(buffer, records.data(), records.size());
+  spdlog::info("frame bytes: msgpack {}, binary full {}, binary deltas {}",
+               msgpackSize, fullSize, buffer.size());
+}
+} // namespace
+} // namespace keep_my_journal
+
+int main(int argc, char *argv[]) {
+  using namespace keep_my_journal;
+
+  std::size_t const messages = argc > 1 ? std::strtoull(argv[1], nullptr, 10)
+                                        : 100'000;
+  std::size_t const batch = argc > 2 ? std::strtoull(argv[2], nullptr, 10) : 64;
+  if (messages == 0 || batch == 0) {
+    spdlog::error("usage: {} [messages] [records per message]", argv[0]);
+    return EXIT_FAILURE;
+  }
+
+  auto const records = make_records(batch);
+  zmq::context_t context{1};
+  spdlog::info("{} messages of {} records", messages, batch);
+  print("send, copied", bench_send(context, messages, records, true));
+  print("send, zero-copy", bench_send(context, messages, records, false));
+  print("decode, fresh", bench_decode(messages, records, true));
+  print("decode, reused", bench_decode(messages, records, false));
+  print("decode, binary", bench_binary_decode(messages, records));
+  print_frame_sizes(records);
+  return EXIT_SUCCESS;
+}
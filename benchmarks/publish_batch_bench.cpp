@@ -0,0 +1,241 @@
+// Copyright (C) 2023-2024 Joshua and Jordan Ogunyinka
+
+// what the publisher's batch size (--batch-size, with --batch-interval-us
+// at its 250us default) does to throughput and latency. Three threads play
+// a price_monitor stream, its publisher and a subscriber: the stream pushes
+// frames of prices into the FIFO sink, the publisher batches them the way
+// store_exchanges_price_into_storage does and encodes every batch, and the
+// subscriber decodes them. Frames are handed over through a queue rather
+// than zmq, so only batching and the codec are measured. For each batch size
+// the stream sends the same number of prices twice: at a set rate, for the
+// latency from stream to subscriber per price, then flat out, for how many
+// prices per second get through.
+//
+//   publish_batch_bench [msgpack|binary] [prices per second] [seconds]
+#include <spdlog/spdlog.h>
+
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <cstdlib>
+#include <string>
+#include <string_view>
+#include <thread>
+#include <vector>
+
+#include "container.hpp"
+#include "latency_histogram.hpp"
+#include "price_stream/instrument_sink.hpp"
+#include "price_stream/price_binary.hpp"
+#include "price_stream/price_wire.hpp"
+#include "price_stream/symbol_registry.hpp"
+
+namespace keep_my_journal {
+namespace {
+constexpr auto bench_exchange = exchange_e::binance;
+constexpr std::size_t symbol_count = 1000;
+// prices per websocket frame, as a Binance !ticker@arr push carries
+constexpr std::size_t frame_size = 100;
+
+struct config_t {
+  bool isBinary = true;
+  std::size_t pricesPerSecond = 50'000;
+  std::chrono::seconds duration{2};
+};
+
+struct result_t {
+  double pricesPerSecond = 0.0;
+  double pricesPerFrame = 0.0;
+  latency_summary_t latency{};
+};
+
+using frame_channel_t = utils::waitable_container_t<std::string>;
+
+void stream(fifo_instrument_queue_t &sink, std::size_t const pricesPerSecond,
+            std::size_t const total) {
+  std::vector<price_record_t> frame(frame_size);
+  auto const interval =
+      pricesPerSecond == 0
+          ? std::chrono::nanoseconds::zero()
+          : std::chrono::nanoseconds(1'000'000'000 * std::int64_t(frame_size) /
+                                     std::int64_t(pricesPerSecond));
+  auto next = std::chrono::steady_clock::now();
+  std::size_t nextId = 0;
+  std::int64_t tick = 0;
+  for (std::size_t sent = 0; sent < total; sent += frame_size) {
+    auto const received = micros_since_epoch();
+    for (auto &record : frame) {
+      record.id = static_cast<instrument_id_t>(nextId++ % symbol_count);
+      record.currentPrice = decimal_t(1'234'567 + (++tick % 500), -4);
+      record.open24h = decimal_t(1'200'000, -4);
+      record.timestamps.received = received;
+    }
+    sink.append_list(std::vector<price_record_t>(frame));
+
+    if (interval != std::chrono::nanoseconds::zero()) {
+      next += interval;
+      std::this_thread::sleep_until(next);
+    }
+  }
+}
+
+// store_exchanges_price_into_storage's batching, without the topics and
+// snapshots
+void publish(fifo_instrument_queue_t &sink, frame_channel_t &channel,
+             std::atomic<bool> const &isStreaming,
+             std::size_t const maxRecords,
+             config_t const &config, std::size_t &frames) {
+  price_batch_config_t const batching{maxRecords};
+  msgpack::sbuffer buffer;
+  price_binary_encoder_t encoder;
+  std::vector<price_record_t> pending;
+  auto firstPendingTime = std::chrono::steady_clock::now();
+  auto feedSequence = static_cast<std::uint64_t>(micros_since_epoch());
+
+  auto send = [&](std::size_t const first, std::size_t const count) {
+    auto const published = micros_since_epoch();
+    for (auto i = first; i < first + count; ++i)
+      pending[i].timestamps.published = published;
+    if (config.isBinary)
+      encoder.encode_batch(buffer, pending.data() + first, count);
+    else if (count == 1)
+      pack_price_record(buffer, pending[first]);
+    else
+      pack_price_batch(buffer, pending.data() + first, count);
+    channel.append(std::string(buffer.data(), buffer.size()));
+    buffer.clear();
+    ++frames;
+  };
+
+  while (isStreaming || !pending.empty() || !sink.empty()) {
+    auto const alreadyPending = pending.size();
+    if (pending.empty()) {
+      sink.get_all(pending);
+      firstPendingTime = std::chrono::steady_clock::now();
+    } else if (!sink.empty()) {
+      sink.get_all(pending);
+    } else {
+      auto const waited = std::chrono::steady_clock::now() - firstPendingTime;
+      if (waited < batching.maxDelay && isStreaming)
+        std::this_thread::sleep_for(std::min<std::chrono::microseconds>(
+            std::chrono::duration_cast<std::chrono::microseconds>(
+                batching.maxDelay - waited),
+            std::chrono::microseconds(20)));
+    }
+    for (auto i = alreadyPending; i < pending.size(); ++i)
+      pending[i].sequence = ++feedSequence;
+
+    std::size_t sent = 0;
+    for (; pending.size() - sent >= maxRecords; sent += maxRecords)
+      send(sent, maxRecords);
+    if (sent != pending.size() &&
+        (std::chrono::steady_clock::now() - firstPendingTime >=
+             batching.maxDelay ||
+         !isStreaming)) {
+      send(sent, pending.size() - sent);
+      sent = pending.size();
+    }
+    pending.erase(pending.begin(), pending.begin() + (std::ptrdiff_t)sent);
+  }
+  // an empty frame tells the subscriber that's all
+  channel.append(std::string{});
+}
+
+void subscribe(frame_channel_t &channel, config_t const &config,
+               latency_histogram_t &latencies, std::size_t &prices) {
+  auto &registry = symbol_registry_t::get(bench_exchange);
+  price_message_decoder_t decoder;
+  price_binary_decoder_t binaryDecoder;
+  std::vector<price_record_t> records;
+
+  for (;;) {
+    for (auto const &frame : channel.get_all()) {
+      if (frame.empty())
+        return;
+
+      auto const now = micros_since_epoch();
+      if (config.isBinary) {
+        records.clear();
+        binaryDecoder.decode(frame, records);
+        for (auto const &record : records)
+          latencies.record(now - record.timestamps.received);
+        prices += records.size();
+      } else {
+        decoder.decode(frame, registry);
+        for (auto const &instrument : decoder)
+          latencies.record(now - instrument.timestamps.received);
+        prices += decoder.size();
+      }
+    }
+  }
+}
+
+result_t run(std::size_t const maxRecords, std::size_t const pricesPerSecond,
+             config_t const &config) {
+  fifo_instrument_queue_t sink;
+  frame_channel_t channel;
+  latency_histogram_t latencies;
+  std::atomic<bool> isStreaming{true};
+  std::size_t frames = 0;
+  std::size_t prices = 0;
+
+  auto const start = std::chrono::steady_clock::now();
+  std::thread subscriber(
+      [&] { subscribe(channel, config, latencies, prices); });
+  std::thread publisher([&] {
+    publish(sink, channel, isStreaming, maxRecords, config, frames);
+  });
+  stream(sink, pricesPerSecond,
+         config.pricesPerSecond * std::size_t(config.duration.count()));
+  isStreaming = false;
+  publisher.join();
+  subscriber.join();
+  auto const elapsed = std::chrono::duration<double>(
+                           std::chrono::steady_clock::now() - start)
+                           .count();
+
+  result_t result{};
+  result.pricesPerSecond = static_cast<double>(prices) / elapsed;
+  result.pricesPerFrame =
+      static_cast<double>(prices) / static_cast<double>(std::max<std::size_t>(
+                                        frames, 1));
+  result.latency = latencies.summary();
+  return result;
+}
+} // namespace
+} // namespace keep_my_journal
+
+int main(int argc, char *argv[]) {
+  using namespace keep_my_journal;
+
+  config_t config{};
+  if (argc > 1)
+    config.isBinary = std::string_view(argv[1]) != "msgpack";
+  if (argc > 2)
+    config.pricesPerSecond = std::strtoull(argv[2], nullptr, 10);
+  if (argc > 3)
+    config.duration = std::chrono::seconds(std::strtoull(argv[3], nullptr, 10));
+  if (config.pricesPerSecond == 0 || config.duration.count() == 0) {
+    spdlog::error("usage: {} [msgpack|binary] [prices per second] [seconds]",
+                  argv[0]);
+    return EXIT_FAILURE;
+  }
+
+  // the subscriber resolves ids through the same registry
+  auto &registry = symbol_registry_t::get(bench_exchange);
+  for (std::size_t i = 0; i < symbol_count; ++i)
+    registry.intern(trade_type_e::spot, "BENCH" + std::to_string(i) + "USDT");
+
+  spdlog::info("{} frames, paced at {} prices/s, {}s per run",
+               config.isBinary ? "binary" : "msgpack", config.pricesPerSecond,
+               config.duration.count());
+  for (std::size_t const batchSize : {1, 8, 32, 64, 256}) {
+    auto const paced = run(batchSize, config.pricesPerSecond, config);
+    auto const flatOut = run(batchSize, 0, config);
+    spdlog::info("batch {:>3}: paced {:>5.1f}/frame, latency mean {:>5} us "
+                 "p50 {:>5} us p99 {:>6} us; flat out {:>9.0f} prices/s",
+                 batchSize, paced.pricesPerFrame, paced.latency.mean,
+                 paced.latency.p50, paced.latency.p99, flatOut.pricesPerSecond);
+  }
+  return EXIT_SUCCESS;
+}
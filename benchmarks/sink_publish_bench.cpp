@@ -0,0 +1,122 @@
+// Copyright (C) 2023-2024 Joshua and Jordan Ogunyinka
+
+// what handing a websocket frame's prices to the publisher costs through
+// the FIFO sink, one ticker at a time (append per ticker, get per price, as
+// the streams and the publisher did) against a frame at a time (append_list
+// per frame, get_all per wake-up). A stream thread pushes frames at a set
+// pace while the publisher thread drains them. It prints the sink's lock
+// acquisitions per frame on either side and how long a frame took from the
+// stream starting to push it to the publisher having taken its last price.
+//
+//   sink_publish_bench [frames] [tickers per frame] [microseconds between]
+#include <spdlog/spdlog.h>
+
+#include <chrono>
+#include <cstdlib>
+#include <limits>
+#include <thread>
+#include <vector>
+
+#include "latency_histogram.hpp"
+#include "price_stream/commodity.hpp"
+
+namespace keep_my_journal {
+namespace {
+// marks the end of the run for the publisher
+constexpr auto last_id = std::numeric_limits<instrument_id_t>::max();
+
+struct config_t {
+  std::size_t frames = 2000;
+  std::size_t tickers = 500;
+  std::chrono::microseconds interval{1000};
+};
+
+void run(char const *name, bool const isPerFrame, config_t const &config) {
+  price_record_list_t sink;
+  latency_histogram_t frameTimes;
+  // every call into the sink takes its mutex once
+  std::uint64_t streamLocks = 0;
+  std::uint64_t publisherLocks = 0;
+
+  std::thread publisher([&] {
+    auto onRecord = [&](price_record_t const &record) {
+      if (record.id + 1 == config.tickers)
+        frameTimes.record(micros_since_epoch() - record.timestamps.received);
+      return record.id != last_id;
+    };
+
+    bool isRunning = true;
+    while (isRunning) {
+      ++publisherLocks;
+      if (isPerFrame) {
+        for (auto const &record : sink.get_all())
+          isRunning = onRecord(record) && isRunning;
+      } else {
+        isRunning = onRecord(sink.get());
+      }
+    }
+  });
+
+  std::vector<price_record_t> frame(config.tickers);
+  auto next = std::chrono::steady_clock::now();
+  for (std::size_t f = 0; f < config.frames; ++f) {
+    std::this_thread::sleep_until(next);
+    next += config.interval;
+
+    auto const startedAt = micros_since_epoch();
+    for (std::size_t i = 0; i < frame.size(); ++i) {
+      auto &record = frame[i];
+      record.id = static_cast<instrument_id_t>(i);
+      record.currentPrice = decimal_t(1'234'567 + std::int64_t(i), -4);
+      record.timestamps.received = startedAt;
+      if (!isPerFrame) {
+        ++streamLocks;
+        sink.append(record);
+      }
+    }
+    if (isPerFrame) {
+      ++streamLocks;
+      sink.append_list(std::vector<price_record_t>(frame));
+    }
+  }
+
+  price_record_t end{};
+  end.id = last_id;
+  sink.append(end);
+  publisher.join();
+
+  auto const frames = static_cast<double>(config.frames);
+  auto const summary = frameTimes.summary();
+  spdlog::info("{:<16} locks/frame: stream {:>7.1f} publisher {:>7.1f}, "
+               "frame latency mean {} us p50 {} us p99 {} us max {} us",
+               name, static_cast<double>(streamLocks) / frames,
+               static_cast<double>(publisherLocks) / frames, summary.mean,
+               summary.p50, summary.p99, summary.max);
+}
+} // namespace
+} // namespace keep_my_journal
+
+int main(int argc, char *argv[]) {
+  using namespace keep_my_journal;
+
+  config_t config{};
+  if (argc > 1)
+    config.frames = std::strtoull(argv[1], nullptr, 10);
+  if (argc > 2)
+    config.tickers = std::strtoull(argv[2], nullptr, 10);
+  if (argc > 3)
+    config.interval =
+        std::chrono::microseconds(std::strtoull(argv[3], nullptr, 10));
+  if (config.frames == 0 || config.tickers == 0) {
+    spdlog::error(
+        "usage: {} [frames] [tickers per frame] [microseconds between]",
+        argv[0]);
+    return EXIT_FAILURE;
+  }
+
+  spdlog::info("{} frames of {} tickers, one every {} us", config.frames,
+               config.tickers, config.interval.count());
+  run("per ticker", false, config);
+  run("per frame", true, config);
+  return EXIT_SUCCESS;
+}
@@ -0,0 +1,286 @@
+// Copyright (C) 2023-2024 Joshua and Jordan Ogunyinka
+
+// what it costs to get the tickers out of captured websocket frames, the
+// way the streams used to (nlohmann::json trees and std::stod) against the
+// in-place cursor of ticker_parser.hpp. The frames come from a capture
+// recorded with price_monitor --capture-file, see frame_capture.hpp, and are
+// read into memory first so that only parsing is timed. Interning and the
+// sink are the same either way and are left out.
+// Allocations are only counted when built with ENABLE_ALLOCATION_COUNTING.
+//
+//   ticker_parser_bench <capture file> [rounds]
+#include <spdlog/spdlog.h>
+
+#include <chrono>
+#include <cstdlib>
+#include <cstring>
+#include <fstream>
+#include <iterator>
+#include <string>
+#include <string_view>
+#include <vector>
+
+#include "allocation_counter.hpp"
+#include "frame_capture.hpp"
+#include "json_utils.hpp"
+#include "ticker_parser.hpp"
+
+namespace keep_my_journal {
+namespace {
+struct captured_frame_t {
+  exchange_e exchange = exchange_e::total;
+  trade_type_e tradeType = trade_type_e::total;
+  std::string_view frame;
+};
+
+struct capture_t {
+  std::string bytes;
+  std::vector<captured_frame_t> frames;
+  std::size_t frameBytes = 0;
+};
+
+// what the streams kept of a ticker before prices were decimals
+struct legacy_ticker_t {
+  std::string name;
+  double currentPrice = 0.0;
+  double open24h = 0.0;
+};
+
+struct result_t {
+  double nanosPerFrame = 0.0;
+  double allocationsPerFrame = 0.0;
+  std::size_t tickers = 0;
+};
+
+bool read_capture(std::string const &path, capture_t &capture) {
+  std::ifstream file(path, std::ios::binary);
+  if (!file)
+    return false;
+  capture.bytes.assign(std::istreambuf_iterator<char>(file),
+                       std::istreambuf_iterator<char>());
+  auto const &bytes = capture.bytes;
+  if (bytes.size() < sizeof(capture_magic) ||
+      std::memcmp(bytes.data(), capture_magic, sizeof(capture_magic)) != 0)
+    return false;
+
+  std::size_t offset = sizeof(capture_magic);
+  while (offset + sizeof(capture_record_header_t) <= bytes.size()) {
+    capture_record_header_t header;
+    std::memcpy(&header, bytes.data() + offset, sizeof(header));
+    offset += sizeof(header);
+    if (header.size == 0 || offset + header.size > bytes.size())
+      break;
+
+    captured_frame_t frame;
+    frame.exchange = static_cast<exchange_e>(header.exchange);
+    frame.tradeType = static_cast<trade_type_e>(header.tradeType);
+    frame.frame = std::string_view(bytes.data() + offset, header.size);
+    offset += (header.size + 7) & ~std::size_t(7);
+    if (frame.exchange < exchange_e::total &&
+        frame.tradeType < trade_type_e::total) {
+      capture.frames.push_back(frame);
+      capture.frameBytes += header.size;
+    }
+  }
+  return true;
+}
+
+// ========================= as the streams were ===========================
+
+void legacy_binance(std::string_view const frame,
+                    std::vector<legacy_ticker_t> &tickers) {
+  auto const dataList = json::parse(frame).get<json::array_t>();
+  for (auto const &dataJson : dataList) {
+    auto const dataObject = dataJson.get<json::object_t>();
+    legacy_ticker_t data;
+    data.name = dataObject.at("s").get<json::string_t>();
+    data.currentPrice = std::stod(dataObject.at("c").get<json::string_t>());
+    data.open24h = std::stod(dataObject.at("o").get<json::string_t>());
+    tickers.push_back(std::move(data));
+  }
+}
+
+void legacy_okex(std::string_view const frame,
+                 std::vector<legacy_ticker_t> &tickers) {
+  json::object_t const root = json::parse(frame).get<json::object_t>();
+  auto const argIter = root.find("arg");
+  auto const dataIter = root.find("data");
+  if (root.find("event") != root.end() || argIter == root.end() ||
+      dataIter == root.end())
+    return;
+  auto const argObject = argIter->second.get<json::object_t>();
+  if (argObject.at("channel").get<json::string_t>() != "tickers")
+    return;
+
+  for (auto const &dataJson : dataIter->second.get<json::array_t>()) {
+    auto const dataObject = dataJson.get<json::object_t>();
+    legacy_ticker_t data;
+    data.name = dataObject.at("instId").get<json::string_t>();
+    data.currentPrice = std::stod(dataObject.at("last").get<json::string_t>());
+    data.open24h = std::stod(dataObject.at("sodUtc8").get<json::string_t>());
+    tickers.push_back(std::move(data));
+  }
+}
+
+void legacy_kucoin(std::string_view const frame, trade_type_e const tradeType,
+                   std::vector<legacy_ticker_t> &tickers) {
+  json::object_t const jsonObject = json::parse(frame);
+  auto const dataIter = jsonObject.find("data");
+  if (dataIter == jsonObject.end() || !dataIter->second.is_object())
+    return;
+
+  auto const dataObject = dataIter->second.get<json::object_t>();
+  legacy_ticker_t data;
+  if (tradeType == trade_type_e::spot) {
+    auto const subjectIter = jsonObject.find("subject");
+    auto const priceIter = dataObject.find("price");
+    if (subjectIter == jsonObject.end() || priceIter == dataObject.end())
+      return;
+    data.name = subjectIter->second.get<json::string_t>();
+    data.currentPrice = std::stod(priceIter->second.get<json::string_t>());
+  } else {
+    auto const symbolIter = dataObject.find("symbol");
+    auto const bidIter = dataObject.find("bestBidPrice");
+    auto const askIter = dataObject.find("bestAskPrice");
+    if (symbolIter == dataObject.end() || bidIter == dataObject.end() ||
+        askIter == dataObject.end())
+      return;
+    data.name = symbolIter->second.get<json::string_t>();
+    data.currentPrice =
+        (std::stod(bidIter->second.get<json::string_t>()) +
+         std::stod(askIter->second.get<json::string_t>())) /
+        2.0;
+  }
+  tickers.push_back(std::move(data));
+}
+
+std::size_t legacy_parse(captured_frame_t const &frame,
+                         std::vector<legacy_ticker_t> &tickers) {
+  tickers.clear();
+  try {
+    switch (frame.exchange) {
+    case exchange_e::binance:
+      legacy_binance(frame.frame, tickers);
+      break;
+    case exchange_e::okex:
+      legacy_okex(frame.frame, tickers);
+      break;
+    case exchange_e::kucoin:
+      legacy_kucoin(frame.frame, frame.tradeType, tickers);
+      break;
+    default:
+      break;
+    }
+  } catch (std::exception const &) {
+    // subscription replies and pings, the streams logged and moved on
+  }
+  return tickers.size();
+}
+
+// ============================ as they are now ============================
+
+std::size_t cursor_parse(captured_frame_t const &frame,
+                         std::vector<price_record_t> &records) {
+  records.clear();
+  auto onTicker = [&records](ticker_view_t const &ticker) {
+    price_record_t data{};
+    if (!parse_price_string(ticker.currentPrice, data.currentPrice) ||
+        !parse_price_string(ticker.open24h, data.open24h))
+      return;
+    records.push_back(data);
+  };
+
+  switch (frame.exchange) {
+  case exchange_e::binance:
+    parse_binance_tickers(frame.frame, onTicker);
+    break;
+  case exchange_e::okex:
+    if (okex_frame_view_t okex;
+        parse_okex_frame(frame.frame, okex) && okex.channel == "tickers")
+      parse_okex_tickers(okex.data, onTicker);
+    break;
+  case exchange_e::kucoin: {
+    kucoin_ticker_view_t ticker;
+    price_record_t data{};
+    if (!parse_kucoin_ticker(frame.frame, ticker))
+      break;
+    if (frame.tradeType == trade_type_e::spot) {
+      if (parse_price_string(ticker.price, data.currentPrice))
+        records.push_back(data);
+    } else if (decimal_t bid, ask;
+               parse_price_string(ticker.bestBidPrice, bid) &&
+               parse_price_string(ticker.bestAskPrice, ask)) {
+      data.currentPrice = (bid + ask) * decimal_t(5, -1);
+      records.push_back(data);
+    }
+    break;
+  }
+  default:
+    break;
+  }
+  return records.size();
+}
+
+template <typename Func>
+result_t measure(capture_t const &capture, std::size_t const rounds,
+                 Func &&func) {
+  result_t result{};
+  auto const allocations = thread_allocations();
+  auto const start = std::chrono::steady_clock::now();
+  for (std::size_t round = 0; round < rounds; ++round) {
+    for (auto const &frame : capture.frames)
+      result.tickers += func(frame);
+  }
+  auto const elapsed = std::chrono::steady_clock::now() - start;
+
+  auto const frames = static_cast<double>(rounds * capture.frames.size());
+  result.nanosPerFrame =
+      static_cast<double>(
+          std::chrono::duration_cast<std::chrono::nanoseconds>(elapsed)
+              .count()) /
+      frames;
+  result.allocationsPerFrame =
+      static_cast<double>(thread_allocations() - allocations) / frames;
+  return result;
+}
+
+void print(char const *name, result_t const &result) {
+  if (allocations_counted())
+    spdlog::info("{:<16} {:>10.1f} ns/frame {:>8.2f} allocations/frame, "
+                 "{} tickers",
+                 name, result.nanosPerFrame, result.allocationsPerFrame,
+                 result.tickers);
+  else
+    spdlog::info("{:<16} {:>10.1f} ns/frame, {} tickers", name,
+                 result.nanosPerFrame, result.tickers);
+}
+} // namespace
+} // namespace keep_my_journal
+
+int main(int argc, char *argv[]) {
+  using namespace keep_my_journal;
+
+  std::size_t const rounds =
+      argc > 2 ? std::strtoull(argv[2], nullptr, 10) : 20;
+  capture_t capture;
+  if (argc < 2 || rounds == 0) {
+    spdlog::error("usage: {} <capture file> [rounds]", argv[0]);
+    return EXIT_FAILURE;
+  }
+  if (!read_capture(argv[1], capture) || capture.frames.empty()) {
+    spdlog::error("{} is not a capture file or has no frames", argv[1]);
+    return EXIT_FAILURE;
+  }
+
+  spdlog::info("{} frames ({} bytes), {} rounds", capture.frames.size(),
+               capture.frameBytes, rounds);
+  std::vector<legacy_ticker_t> tickers;
+  print("json + stod", measure(capture, rounds, [&](auto const &frame) {
+          return legacy_parse(frame, tickers);
+        }));
+  std::vector<price_record_t> records;
+  print("cursor", measure(capture, rounds, [&](auto const &frame) {
+          return cursor_parse(frame, records);
+        }));
+  return EXIT_SUCCESS;
+}
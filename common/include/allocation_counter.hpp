@@ -0,0 +1,34 @@
+// Copyright (C) 2023-2024 Joshua and Jordan Ogunyinka
+#pragma once
+
+#include <chrono>
+#include <cstdint>
+#include <string>
+
+namespace keep_my_journal {
+// whether this build counts allocations, see ENABLE_ALLOCATION_COUNTING. It
+// replaces the global operator new with one that counts per thread.
+bool allocations_counted();
+// operator new calls made by the calling thread so far, 0 if not counted
+std::uint64_t thread_allocations();
+
+// the allocations a pipeline makes per message, counted on the one thread
+// that runs it: everything that thread allocates between two reports is
+// put down to the messages it handled in between.
+class allocation_stats_t {
+  std::string const m_name;
+  std::chrono::seconds const m_interval;
+  std::chrono::steady_clock::time_point m_lastReport;
+  std::uint64_t m_lastAllocations = 0;
+  std::uint64_t m_messages = 0;
+
+public:
+  explicit allocation_stats_t(std::string name,
+                              std::chrono::seconds interval =
+                                  std::chrono::seconds(30));
+
+  // `count` more messages were handled, logs the average once every
+  // `interval`. Does nothing if allocations aren't counted.
+  void messages_done(std::uint64_t count = 1);
+};
+} // namespace keep_my_journal
@@ -0,0 +1,234 @@
+// Copyright (C) 2023-2024 Joshua and Jordan Ogunyinka
+#pragma once
+
+#include <atomic>
+#include <chrono>
+#include <condition_variable>
+#include <cstddef>
+#include <memory>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+#include "enumerations.hpp"
+
+namespace keep_my_journal::utils {
+struct ring_buffer_stats_t {
+  std::size_t pushed = 0;
+  std::size_t droppedOldest = 0;
+  std::size_t droppedNewest = 0;
+  std::size_t blocked = 0;
+};
+
+// A bounded multi-producer/multi-consumer queue over a fixed array of slots
+// (D. Vyukov's sequence-per-cell design). Producers and consumers never take
+// a lock; the only mutex is used to park the consumer when the ring has been
+// empty for a while and is touched by producers only while it is parked.
+template <typename T> class bounded_ring_buffer_t {
+  static constexpr std::size_t cache_line_size = 64;
+
+  struct cell_t {
+    std::atomic<std::size_t> sequence;
+    T data;
+  };
+
+  std::unique_ptr<cell_t[]> m_cells;
+  std::size_t const m_mask;
+  queue_overflow_policy_e const m_policy;
+
+  alignas(cache_line_size) std::atomic<std::size_t> m_enqueuePosition{0};
+  alignas(cache_line_size) std::atomic<std::size_t> m_dequeuePosition{0};
+
+  alignas(cache_line_size) std::atomic<std::size_t> m_pushedCount{0};
+  std::atomic<std::size_t> m_droppedOldestCount{0};
+  std::atomic<std::size_t> m_droppedNewestCount{0};
+  std::atomic<std::size_t> m_blockedCount{0};
+
+  std::atomic_bool m_consumerSleeping{false};
+  std::mutex m_mutex{};
+  std::condition_variable m_cv{};
+
+  static std::size_t round_up_capacity(std::size_t const capacity) {
+    std::size_t result = 2;
+    while (result < capacity)
+      result <<= 1;
+    return result;
+  }
+
+  // moves from `item` only when it succeeds. The claiming CAS is seq_cst so
+  // that it and the consumer's parking (see pop_all) are totally ordered
+  bool try_push_impl(T &item) {
+    std::size_t position = m_enqueuePosition.load(std::memory_order_relaxed);
+    for (;;) {
+      cell_t &cell = m_cells[position & m_mask];
+      std::size_t const sequence =
+          cell.sequence.load(std::memory_order_acquire);
+      auto const diff =
+          static_cast<std::ptrdiff_t>(sequence) -
+          static_cast<std::ptrdiff_t>(position);
+      if (diff == 0) {
+        if (m_enqueuePosition.compare_exchange_weak(
+                position, position + 1, std::memory_order_seq_cst,
+                std::memory_order_relaxed)) {
+          cell.data = std::move(item);
+          cell.sequence.store(position + 1, std::memory_order_release);
+          return true;
+        }
+      } else if (diff < 0) {
+        return false; // full
+      } else {
+        position = m_enqueuePosition.load(std::memory_order_relaxed);
+      }
+    }
+  }
+
+  // no fence: the seq_cst CAS that claimed the cell comes before this load
+  // in the total order, so either the consumer saw the cell claimed or this
+  // sees it parking
+  void wake_consumer() {
+    if (m_consumerSleeping.load(std::memory_order_seq_cst)) {
+      std::lock_guard<std::mutex> lock_g{m_mutex};
+      m_cv.notify_one();
+    }
+  }
+
+public:
+  using value_type = T;
+
+  explicit bounded_ring_buffer_t(std::size_t const capacity,
+                                 queue_overflow_policy_e const policy =
+                                     queue_overflow_policy_e::drop_oldest)
+      : m_cells(new cell_t[round_up_capacity(capacity)]),
+        m_mask(round_up_capacity(capacity) - 1), m_policy(policy) {
+    for (std::size_t i = 0; i <= m_mask; ++i)
+      m_cells[i].sequence.store(i, std::memory_order_relaxed);
+  }
+
+  bounded_ring_buffer_t(bounded_ring_buffer_t const &) = delete;
+  bounded_ring_buffer_t &operator=(bounded_ring_buffer_t const &) = delete;
+  ~bounded_ring_buffer_t() = default;
+
+  std::size_t capacity() const { return m_mask + 1; }
+  queue_overflow_policy_e policy() const { return m_policy; }
+
+  bool try_pop(T &item) {
+    std::size_t position = m_dequeuePosition.load(std::memory_order_relaxed);
+    for (;;) {
+      cell_t &cell = m_cells[position & m_mask];
+      std::size_t const sequence =
+          cell.sequence.load(std::memory_order_acquire);
+      auto const diff =
+          static_cast<std::ptrdiff_t>(sequence) -
+          static_cast<std::ptrdiff_t>(position + 1);
+      if (diff == 0) {
+        if (m_dequeuePosition.compare_exchange_weak(
+                position, position + 1, std::memory_order_relaxed)) {
+          item = std::move(cell.data);
+          cell.sequence.store(position + m_mask + 1,
+                              std::memory_order_release);
+          return true;
+        }
+      } else if (diff < 0) {
+        return false; // empty
+      } else {
+        position = m_dequeuePosition.load(std::memory_order_relaxed);
+      }
+    }
+  }
+
+  // returns false only if the item was discarded (drop_newest)
+  bool push(T item) {
+    if (!try_push_impl(item)) {
+      switch (m_policy) {
+      case queue_overflow_policy_e::drop_newest:
+        m_droppedNewestCount.fetch_add(1, std::memory_order_relaxed);
+        return false;
+      case queue_overflow_policy_e::drop_oldest: {
+        T discarded{};
+        do {
+          if (try_pop(discarded))
+            m_droppedOldestCount.fetch_add(1, std::memory_order_relaxed);
+        } while (!try_push_impl(item));
+        break;
+      }
+      case queue_overflow_policy_e::block:
+      default:
+        m_blockedCount.fetch_add(1, std::memory_order_relaxed);
+        do {
+          wake_consumer();
+          std::this_thread::yield();
+        } while (!try_push_impl(item));
+        break;
+      }
+    }
+
+    m_pushedCount.fetch_add(1, std::memory_order_relaxed);
+    wake_consumer();
+    return true;
+  }
+
+  // takes everything currently in the ring, at most `capacity()` items
+  std::size_t try_pop_all(std::vector<T> &result) {
+    std::size_t count = 0;
+    T item{};
+    while (count <= m_mask && try_pop(item)) {
+      result.push_back(std::move(item));
+      ++count;
+    }
+    return count;
+  }
+
+  // blocks until at least one item is available (or `timeout` elapses) and
+  // then drains the ring into `result`
+  template <typename Rep, typename Period>
+  std::size_t pop_all(std::vector<T> &result,
+                      std::chrono::duration<Rep, Period> const timeout) {
+    if (auto const count = try_pop_all(result); count != 0)
+      return count;
+
+    // spin a little before parking, a busy feed refills the ring quickly
+    for (int i = 0; i < 64; ++i) {
+      std::this_thread::yield();
+      if (auto const count = try_pop_all(result); count != 0)
+        return count;
+    }
+
+    std::unique_lock<std::mutex> u_lock{m_mutex};
+    m_consumerSleeping.store(true, std::memory_order_seq_cst);
+    // a cell claimed before the store above is seen here even if its data is
+    // still being written; one claimed after it sees the consumer parking
+    auto const claimed = [this] {
+      return m_enqueuePosition.load(std::memory_order_seq_cst) !=
+             m_dequeuePosition.load(std::memory_order_relaxed);
+    };
+    m_cv.wait_for(u_lock, timeout, claimed);
+    std::size_t count = try_pop_all(result);
+    while (count == 0 && claimed()) {
+      std::this_thread::yield();
+      count = try_pop_all(result);
+    }
+    m_consumerSleeping.store(false, std::memory_order_relaxed);
+    return count;
+  }
+
+  bool empty() const {
+    return m_enqueuePosition.load(std::memory_order_acquire) ==
+           m_dequeuePosition.load(std::memory_order_acquire);
+  }
+
+  void clear() {
+    T discarded{};
+    while (try_pop(discarded))
+      ;
+  }
+
+  ring_buffer_stats_t stats() const {
+    ring_buffer_stats_t result;
+    result.pushed = m_pushedCount.load(std::memory_order_relaxed);
+    result.droppedOldest = m_droppedOldestCount.load(std::memory_order_relaxed);
+    result.droppedNewest = m_droppedNewestCount.load(std::memory_order_relaxed);
+    result.blocked = m_blockedCount.load(std::memory_order_relaxed);
+    return result;
+  }
+};
+} // namespace keep_my_journal::utils
@@ -2,8 +2,10 @@
 #pragma once
 
 #include <algorithm>
+#include <chrono>
 #include <condition_variable>
 #include <deque>
+#include <iterator>
 #include <map>
 #include <mutex>
 #include <optional>
@@ -93,6 +95,22 @@ public:
     insert_impl(std::forward<U>(item));
   }
 
+  // replaces or inserts every item under one lock acquisition, the items
+  // are moved from
+  void insert_list(std::vector<T> &&items) {
+    std::lock_guard<std::mutex> lock_g{m_mutex};
+    for (auto &item : items)
+      insert_impl(std::move(item));
+  }
+
+  // as above but copies the items in, so that an item that's already there
+  // is assigned to and keeps its strings' capacity
+  template <typename Iter> void insert_list(Iter first, Iter const last) {
+    std::lock_guard<std::mutex> lock_g{m_mutex};
+    for (; first != last; ++first)
+      insert_impl(*first);
+  }
+
   template <typename Func> std::vector<T> all_items_matching(Func &&filter) {
     std::vector<T> items{};
     std::lock_guard<std::mutex> lock_g{m_mutex};
@@ -180,6 +198,48 @@ public:
     return value;
   }
 
+  // waits until there's at least one item and then takes everything queued
+  // in one lock acquisition
+  Container get_all() {
+    Container values{};
+    std::unique_lock<std::mutex> u_lock{m_mutex};
+    m_cv.wait(u_lock, [this] { return !m_container.empty(); });
+    values.swap(m_container);
+    return values;
+  }
+
+  // as above, but gives up after `timeout` and then returns nothing
+  template <typename Rep, typename Period>
+  Container get_all(std::chrono::duration<Rep, Period> const timeout) {
+    Container values{};
+    std::unique_lock<std::mutex> u_lock{m_mutex};
+    auto const hasData = [this] { return !m_container.empty(); };
+    if (m_cv.wait_for(u_lock, timeout, hasData))
+      values.swap(m_container);
+    return values;
+  }
+
+  // as above, but moves what's queued into `result`. An empty `result`
+  // trades buffers with the container, so once both have grown neither
+  // side allocates again
+  template <typename Rep, typename Period>
+  bool get_all(Container &result,
+               std::chrono::duration<Rep, Period> const timeout) {
+    std::unique_lock<std::mutex> u_lock{m_mutex};
+    auto const hasData = [this] { return !m_container.empty(); };
+    if (!m_cv.wait_for(u_lock, timeout, hasData))
+      return false;
+    if (result.empty()) {
+      result.swap(m_container);
+    } else {
+      result.insert(std::end(result),
+                    std::make_move_iterator(std::begin(m_container)),
+                    std::make_move_iterator(std::end(m_container)));
+      m_container.clear();
+    }
+    return true;
+  }
+
   template <typename U> void append(U &&data) {
     std::lock_guard<std::mutex> lock_g{m_mutex};
     m_container.push_back(std::forward<U>(data));
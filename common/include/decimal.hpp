@@ -0,0 +1,74 @@
+// Copyright (C) 2023-2024 Joshua and Jordan Ogunyinka
+#pragma once
+
+#include <cstdint>
+#include <string>
+#include <string_view>
+
+#ifdef CRYPTOLOG_USING_MSGPACK
+#include <msgpack.hpp>
+#endif
+
+namespace keep_my_journal {
+// a base-10 fixed-point number: mantissa * 10^exponent. Prices arrive as
+// decimal strings and are kept exactly as sent, so comparisons against
+// thresholds don't suffer from binary floating-point rounding.
+// Values are compared by what they represent, "1.50" == "1.5".
+struct decimal_t {
+  std::int64_t mantissa = 0;
+  std::int32_t exponent = 0;
+
+  constexpr decimal_t() = default;
+  explicit constexpr decimal_t(std::int64_t const m, std::int32_t const e = 0)
+      : mantissa(m), exponent(e) {}
+
+  // rounds to 15 significant digits, which is all a double can hold
+  static decimal_t from_double(double value);
+
+  double to_double() const;
+  std::string to_string() const;
+
+  bool is_zero() const { return mantissa == 0; }
+  bool is_negative() const { return mantissa < 0; }
+  decimal_t abs() const {
+    return decimal_t(mantissa < 0 ? -mantissa : mantissa, exponent);
+  }
+  // multiplies by 10^power
+  decimal_t scaled(std::int32_t const power) const {
+    return decimal_t(mantissa, exponent + power);
+  }
+
+  decimal_t operator-() const { return decimal_t(-mantissa, exponent); }
+  friend decimal_t operator+(decimal_t const &a, decimal_t const &b);
+  friend decimal_t operator-(decimal_t const &a, decimal_t const &b);
+  friend decimal_t operator*(decimal_t const &a, decimal_t const &b);
+
+  friend int compare(decimal_t const &a, decimal_t const &b);
+  friend bool operator==(decimal_t const &a, decimal_t const &b) {
+    return compare(a, b) == 0;
+  }
+  friend bool operator!=(decimal_t const &a, decimal_t const &b) {
+    return compare(a, b) != 0;
+  }
+  friend bool operator<(decimal_t const &a, decimal_t const &b) {
+    return compare(a, b) < 0;
+  }
+  friend bool operator<=(decimal_t const &a, decimal_t const &b) {
+    return compare(a, b) <= 0;
+  }
+  friend bool operator>(decimal_t const &a, decimal_t const &b) {
+    return compare(a, b) > 0;
+  }
+  friend bool operator>=(decimal_t const &a, decimal_t const &b) {
+    return compare(a, b) >= 0;
+  }
+
+#ifdef CRYPTOLOG_USING_MSGPACK
+  MSGPACK_DEFINE(mantissa, exponent);
+#endif
+};
+
+// locale-independent; accepts [+-]digits[.digits][(e|E)[+-]digits]. Digits
+// past the 18th significant one are dropped.
+bool parse_decimal(std::string_view str, decimal_t &result);
+} // namespace keep_my_journal
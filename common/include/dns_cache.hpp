@@ -0,0 +1,88 @@
+// Copyright (C) 2023-2024 Joshua and Jordan Ogunyinka
+#pragma once
+
+#include <boost/asio/any_io_executor.hpp>
+#include <boost/asio/ip/tcp.hpp>
+#include <chrono>
+#include <functional>
+#include <map>
+#include <mutex>
+#include <string>
+#include <string_view>
+#include <utility>
+#include <vector>
+
+namespace keep_my_journal {
+namespace net = boost::asio;
+
+struct dns_cache_config_t {
+  // getaddrinfo doesn't hand out the records' TTL, so these are fixed
+  std::chrono::seconds ttl{120};
+  std::chrono::seconds negativeTtl{5};
+  // a hit this close to expiry re-resolves the name in the background, so
+  // busy hosts never actually expire
+  std::chrono::seconds refreshAhead{20};
+};
+
+// process-wide resolver cache shared by every outbound connection. All the
+// streams and REST calls go to the same handful of hosts, so after the first
+// lookup they get their addresses without going through getaddrinfo, and
+// concurrent lookups of the same name share one resolve.
+class dns_cache_t {
+public:
+  using results_type = net::ip::tcp::resolver::results_type;
+  using handler_t =
+      std::function<void(boost::system::error_code const &, results_type)>;
+
+  static dns_cache_t &instance();
+
+  void set_config(dns_cache_config_t const &config);
+  // `handler` is always posted to `executor`, never called inline
+  void async_resolve(net::any_io_executor const &executor,
+                     std::string const &host, std::string const &service,
+                     handler_t handler);
+  // to be called when none of the cached addresses could be connected to
+  void invalidate(std::string const &host, std::string const &service);
+  // sends every connection to `host`, whatever its service, to `address`
+  // and `service` instead; "*" matches any host that has no override of its
+  // own. TLS and HTTP still see the original name, which is how a local
+  // stand-in for the exchanges tells them apart.
+  void add_override(std::string host, std::string address,
+                    std::string service);
+  // `spec` is "host=address:port", returns false if it isn't
+  bool add_override(std::string_view spec);
+
+private:
+  struct waiter_t {
+    net::any_io_executor executor;
+    handler_t handler;
+  };
+
+  struct entry_t {
+    results_type results{};
+    boost::system::error_code error{};
+    std::chrono::steady_clock::time_point expiry{};
+    std::vector<waiter_t> waiters{};
+    bool resolving = false;
+  };
+
+  struct override_t {
+    std::string address;
+    std::string service;
+  };
+
+  dns_cache_t() = default;
+  // the name that is actually looked up for `host` and `service`
+  std::pair<std::string, std::string>
+  apply_override(std::string const &host, std::string const &service);
+  void start_resolve(net::any_io_executor const &executor,
+                     std::string const &host, std::string const &service);
+  void on_resolved(std::string const &key, boost::system::error_code ec,
+                   results_type results);
+
+  std::mutex m_mutex{};
+  std::map<std::string, entry_t, std::less<>> m_entries{};
+  std::map<std::string, override_t, std::less<>> m_overrides{};
+  dns_cache_config_t m_config{};
+};
+} // namespace keep_my_journal
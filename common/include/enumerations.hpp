@@ -63,6 +63,39 @@ enum class duration_unit_e : size_t {
   weeks,
   invalid
 };
+
+enum class price_message_type_e : size_t {
+  symbol_mapping,
+  price_record,
+  price_batch,
+  price_snapshot,
+  unknown,
+};
+
+enum class price_wire_format_e : size_t {
+  msgpack,
+  binary, // see price_binary.hpp
+};
+
+enum class queue_overflow_policy_e : size_t {
+  block,
+  drop_oldest,
+  drop_newest,
+};
+
+enum class io_threading_model_e : size_t {
+  shared,
+  per_exchange,
+  per_stream,
+};
+
+enum class latency_stage_e : size_t {
+  exchange_to_receive, // exchange event time -> websocket frame read
+  receive_to_publish,  // websocket frame read -> zmq send in price_monitor
+  publish_to_consume,  // zmq send -> decoded by a price watcher
+  end_to_end,          // exchange event time -> decoded by a price watcher
+  total,
+};
 } // namespace keep_my_journal
 
 #ifdef CRYPTOLOG_USING_MSGPACK
@@ -74,4 +107,5 @@ MSGPACK_ADD_ENUM(keep_my_journal::exchange_e);
 MSGPACK_ADD_ENUM(keep_my_journal::social_channel_e);
 MSGPACK_ADD_ENUM(keep_my_journal::price_direction_e);
 MSGPACK_ADD_ENUM(keep_my_journal::duration_unit_e);
+MSGPACK_ADD_ENUM(keep_my_journal::price_message_type_e);
 #endif
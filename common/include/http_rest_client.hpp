@@ -8,8 +8,7 @@
 
 namespace keep_my_journal {
 class http_rest_client_t {
-  using resolver = ip::tcp::resolver;
-  using results_type = resolver::results_type;
+  using results_type = ip::tcp::resolver::results_type;
 
   net::io_context &m_ioContext;
 
@@ -20,7 +19,6 @@ class http_rest_client_t {
 
   std::map<std::string, std::string> m_optHeader;
   std::optional<beast::flat_buffer> m_buffer = std::nullopt;
-  std::optional<resolver> m_resolver = std::nullopt;
   std::optional<http::request<http::string_body>> m_httpRequest = std::nullopt;
   std::optional<http::response<http::string_body>> m_httpResponse =
       std::nullopt;
@@ -6,13 +6,11 @@
 
 namespace keep_my_journal {
 class https_rest_api_t {
-  using resolver = ip::tcp::resolver;
-  using results_type = resolver::results_type;
+  using results_type = ip::tcp::resolver::results_type;
 
   net::io_context &m_ioContext;
   net::ssl::context &m_sslContext;
   beast::ssl_stream<beast::tcp_stream> &m_sslStream;
-  resolver &m_resolver;
   char const *const m_hostApi;
   char const *const m_service;
   std::string const m_target;
@@ -41,8 +39,8 @@ class https_rest_api_t {
 public:
   https_rest_api_t(net::io_context &, net::ssl::context &,
                    beast::ssl_stream<beast::tcp_stream> &m_sslStream,
-                   resolver &resolver, char const *const host,
-                   char const *const service, std::string const &target);
+                   char const *const host, char const *const service,
+                   std::string const &target);
 
   void set_method(http_method_e);
   void insert_header(std::string const &key, std::string const &value);
@@ -38,6 +38,7 @@ void get_object_member(json::object_t const &json_object,
 std::optional<json::object_t> read_object_json_file(std::string const &);
 } // namespace utils
 
+void to_json(json &j, decimal_t const &data);
 void to_json(json &j, scheduled_price_task_t const &data);
 void to_json(json &j, instrument_type_t const &instr);
 namespace binance {
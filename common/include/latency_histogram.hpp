@@ -0,0 +1,58 @@
+// Copyright (C) 2023-2024 Joshua and Jordan Ogunyinka
+#pragma once
+
+#include <array>
+#include <atomic>
+#include <chrono>
+#include <cstdint>
+#include <string>
+
+#include "enumerations.hpp"
+#include "price_stream/commodity.hpp"
+
+namespace keep_my_journal {
+struct latency_summary_t {
+  std::uint64_t count = 0;
+  // all in microseconds, percentiles are the upper bound of their bucket
+  std::int64_t mean = 0;
+  std::int64_t p50 = 0;
+  std::int64_t p90 = 0;
+  std::int64_t p99 = 0;
+  std::int64_t max = 0;
+};
+
+// a lock-free histogram of microsecond latencies in power-of-two buckets:
+// bucket 0 holds samples under 1us and bucket i those in [2^(i-1), 2^i)us.
+// Any thread may record into it while any other reads it.
+class latency_histogram_t {
+public:
+  static constexpr std::size_t bucket_count = 40;
+
+  void record(std::int64_t micros);
+  latency_summary_t summary() const;
+  std::array<std::uint64_t, bucket_count> buckets() const;
+
+private:
+  std::array<std::atomic<std::uint64_t>, bucket_count> m_buckets{};
+  std::atomic<std::uint64_t> m_count = 0;
+  std::atomic<std::uint64_t> m_sum = 0;
+  std::atomic<std::int64_t> m_max = 0;
+};
+
+// the process' histogram for each `latency_stage_e`
+class latency_stats_t {
+public:
+  static latency_histogram_t &stage(latency_stage_e stage);
+  // records `to - from`, unless either end wasn't stamped
+  static void record(latency_stage_e stage, std::int64_t from, std::int64_t to);
+  // what a price watcher records once it has decoded a price
+  static void record_consumed(price_timestamps_t const &timestamps);
+  // logs every stage with samples, at most once per `interval` whichever
+  // thread calls it
+  static void report_every(std::chrono::seconds interval);
+  static std::string report();
+};
+
+std::int64_t micros_since_epoch();
+char const *latency_stage_to_string(latency_stage_e stage);
+} // namespace keep_my_journal
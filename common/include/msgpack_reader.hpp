@@ -0,0 +1,40 @@
+// Copyright (C) 2023-2024 Joshua and Jordan Ogunyinka
+#pragma once
+
+#include <cstddef>
+#include <msgpack.hpp>
+#include <string_view>
+
+namespace keep_my_journal {
+// unpacks messages into one zone that is kept from message to message, so
+// that once it has grown to fit them unpacking allocates nothing. Strings
+// and binaries aren't copied into the zone but point into the message:
+// what `next` returns is valid while the message is alive and until the
+// next `clear`.
+class msgpack_reader_t {
+  msgpack::zone m_zone{};
+
+  static bool reference_all(msgpack::type::object_type, std::size_t,
+                            void *) {
+    return true;
+  }
+
+public:
+  // releases what the previous message was unpacked into
+  void clear() { m_zone.clear(); }
+
+  // the object that starts at `offset`, which is moved past it
+  msgpack::object next(std::string_view const message, std::size_t &offset) {
+    return msgpack::unpack(m_zone, message.data(), message.size(), offset,
+                           &msgpack_reader_t::reference_all);
+  }
+
+  // a whole message holding one object, converted into `result` whose
+  // strings and containers keep their capacity
+  template <typename T> void read(std::string_view const message, T &result) {
+    clear();
+    std::size_t offset = 0;
+    next(message, offset).convert(result);
+  }
+};
+} // namespace keep_my_journal
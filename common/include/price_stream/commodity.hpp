@@ -2,6 +2,7 @@
 #pragma once
 
 #include "container.hpp"
+#include "decimal.hpp"
 #include "enumerations.hpp"
 
 #ifdef CRYPTOLOG_USING_MSGPACK
@@ -9,35 +10,69 @@
 #endif
 
 #include <boost/functional/hash.hpp>
-#include <map>
+#include <cstdint>
 #include <string>
 
 namespace keep_my_journal {
+// when a price went through each stage, in microseconds since the epoch (the
+// system clock, as they're compared across processes); 0 when not known
+struct price_timestamps_t {
+  std::int64_t exchange = 0;  // the exchange's own event time
+  std::int64_t received = 0;  // its websocket frame was read
+  std::int64_t published = 0; // price_monitor handed it to zmq
+
+#ifdef CRYPTOLOG_USING_MSGPACK
+  MSGPACK_DEFINE(exchange, received, published);
+#endif
+};
+
 struct instrument_type_t {
   std::string name;
-  double currentPrice = 0.0;
-  double open24h = 0.0;
+  decimal_t currentPrice;
+  decimal_t open24h;
   trade_type_e tradeType;
+  // not part of the instrument's identity and not serialised with it
+  price_timestamps_t timestamps{};
 
 #ifdef CRYPTOLOG_USING_MSGPACK
   MSGPACK_DEFINE(name, currentPrice, open24h, tradeType);
 #endif
 };
 
-using instrument_list_t = utils::waitable_container_t<instrument_type_t>;
-using instrument_set_t = utils::unique_elements_t<instrument_type_t>;
-using instrument_exchange_set_t =
-    utils::locked_map_t<keep_my_journal::exchange_e,
-                        keep_my_journal::instrument_set_t>;
-
-struct instrument_sink_t {
-  using list_t = keep_my_journal::instrument_list_t;
-  static list_t &get_all_listed_instruments(exchange_e const e) {
-    static std::map<exchange_e, list_t> instrumentsSink{};
-    return instrumentsSink[e];
-  }
+using instrument_id_t = std::uint32_t;
+// far more than any exchange lists; ids are dense, so one at or past this
+// off the wire is malformed rather than something to make room for
+inline constexpr instrument_id_t max_instrument_ids = 1 << 20;
+
+// an instrument's price once its name has been interned, see
+// `symbol_registry_t`. This is what price_monitor queues and publishes.
+struct price_record_t {
+  instrument_id_t id = 0;
+  decimal_t currentPrice;
+  decimal_t open24h;
+  price_timestamps_t timestamps{};
+  // price_monitor numbers an exchange's records in the order it publishes
+  // them, carrying on from a higher number after a restart; 0 if unknown
+  std::uint64_t sequence = 0;
+
+#ifdef CRYPTOLOG_USING_MSGPACK
+  MSGPACK_DEFINE(id, currentPrice, open24h, timestamps, sequence);
+#endif
+};
+
+struct symbol_mapping_t {
+  instrument_id_t id = 0;
+  trade_type_e tradeType;
+  std::string name;
+
+#ifdef CRYPTOLOG_USING_MSGPACK
+  MSGPACK_DEFINE(id, tradeType, name);
+#endif
 };
 
+using instrument_list_t = utils::waitable_container_t<instrument_type_t>;
+using price_record_list_t = utils::waitable_container_t<price_record_t>;
+
 } // namespace keep_my_journal
 
 namespace std {
@@ -0,0 +1,54 @@
+// Copyright (C) 2023-2024 Joshua and Jordan Ogunyinka
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <string>
+#include <string_view>
+#include <vector>
+
+#include "price_stream/commodity.hpp"
+
+namespace keep_my_journal {
+// (trade type, name) pairs numbered 0, 1, 2... in the order they're added.
+// The names are kept once, end to end in a single string, and found by open
+// addressing: linear probing over a power-of-two array of buckets that's
+// never more than half full. A bucket holds a row and 32 bits of its key's
+// hash, so a probe only compares names when those match. Not thread safe.
+class instrument_index_t {
+  static constexpr std::uint32_t empty_row = UINT32_MAX;
+
+  struct bucket_t {
+    std::uint32_t row = empty_row;
+    std::uint32_t tag = 0;
+  };
+
+  std::vector<bucket_t> m_buckets{};
+  std::string m_names{};
+  // where each row's name ends in `m_names`, it starts where the last ends
+  std::vector<std::uint32_t> m_nameEnds{};
+  std::vector<std::uint8_t> m_tradeTypes{};
+
+  static std::uint64_t hash_of(trade_type_e tradeType, std::string_view name);
+  // the bucket holding the pair, or the empty one it would go in
+  std::size_t probe(std::uint64_t hash, trade_type_e tradeType,
+                    std::string_view name) const;
+  void grow();
+
+public:
+  static constexpr std::size_t npos = static_cast<std::size_t>(-1);
+
+  // the pair's row, `npos` if it hasn't been added
+  std::size_t find(trade_type_e tradeType, std::string_view name) const;
+  // the pair's row, added as the next one if it's new. Throws
+  // std::length_error past 4GB of names.
+  std::size_t insert(trade_type_e tradeType, std::string_view name);
+
+  std::string_view name(std::size_t row) const;
+  trade_type_e trade_type(std::size_t row) const {
+    return static_cast<trade_type_e>(m_tradeTypes[row]);
+  }
+  std::size_t size() const { return m_nameEnds.size(); }
+  void clear();
+};
+} // namespace keep_my_journal
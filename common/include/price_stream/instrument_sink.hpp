@@ -0,0 +1,188 @@
+// Copyright (C) 2023-2024 Joshua and Jordan Ogunyinka
+#pragma once
+
+#include <array>
+#include <chrono>
+#include <condition_variable>
+#include <memory>
+#include <mutex>
+#include <vector>
+
+#include "bounded_ring_buffer.hpp"
+#include "price_stream/commodity.hpp"
+
+namespace keep_my_journal {
+struct instrument_queue_config_t {
+  // 0 keeps the unbounded, mutex-guarded FIFO
+  std::size_t capacity = 0;
+  queue_overflow_policy_e policy = queue_overflow_policy_e::drop_oldest;
+  // keep only the latest price per instrument, `capacity` is then unused
+  bool conflate = false;
+};
+
+// what the price streams write into and the zmq publisher drains from
+struct instrument_queue_t {
+  virtual ~instrument_queue_t() = default;
+  virtual void append(price_record_t record) = 0;
+  virtual void append_list(std::vector<price_record_t> &&records) = 0;
+  // waits (up to a short timeout) for data, then moves everything queued
+  // into `result`
+  virtual void get_all(std::vector<price_record_t> &result) = 0;
+  virtual void clear() = 0;
+  virtual bool empty() = 0;
+  virtual utils::ring_buffer_stats_t stats() const { return {}; }
+};
+
+class fifo_instrument_queue_t : public instrument_queue_t {
+  // a vector rather than price_record_list_t's deque, so that get_all can
+  // hand its buffer to the caller's
+  utils::waitable_container_t<price_record_t, std::vector<price_record_t>>
+      m_list{};
+
+public:
+  void append(price_record_t record) override { m_list.append(record); }
+
+  void append_list(std::vector<price_record_t> &&records) override {
+    m_list.append_list(std::move(records));
+  }
+
+  void get_all(std::vector<price_record_t> &result) override {
+    m_list.get_all(result, std::chrono::milliseconds(100));
+  }
+
+  void clear() override { m_list.clear(); }
+  bool empty() override { return m_list.empty(); }
+};
+
+class bounded_instrument_queue_t : public instrument_queue_t {
+  utils::bounded_ring_buffer_t<price_record_t> m_ring;
+
+public:
+  bounded_instrument_queue_t(std::size_t const capacity,
+                             queue_overflow_policy_e const policy)
+      : m_ring(capacity, policy) {}
+
+  void append(price_record_t record) override { m_ring.push(record); }
+
+  void append_list(std::vector<price_record_t> &&records) override {
+    for (auto const &record : records)
+      m_ring.push(record);
+  }
+
+  void get_all(std::vector<price_record_t> &result) override {
+    m_ring.pop_all(result, std::chrono::milliseconds(100));
+  }
+
+  void clear() override { m_ring.clear(); }
+  bool empty() override { return m_ring.empty(); }
+  utils::ring_buffer_stats_t stats() const override { return m_ring.stats(); }
+};
+
+// holds at most one pending price per instrument: a newer tick overwrites
+// the one that hasn't been published yet, so under bursts the backlog is
+// bounded by the number of instruments, not the number of ticks
+class conflating_instrument_queue_t : public instrument_queue_t {
+  std::mutex m_mutex{};
+  std::condition_variable m_cv{};
+  // all indexed by the (dense) instrument id
+  std::vector<price_record_t> m_latest{};
+  std::vector<char> m_isDirty{};
+  std::vector<instrument_id_t> m_dirtyIds{};
+
+  void update_impl(price_record_t const &record) {
+    if (record.id >= m_latest.size()) {
+      m_latest.resize(record.id + 1);
+      m_isDirty.resize(record.id + 1, 0);
+    }
+
+    m_latest[record.id] = record;
+    if (!m_isDirty[record.id]) {
+      m_isDirty[record.id] = 1;
+      m_dirtyIds.push_back(record.id);
+    }
+  }
+
+public:
+  void append(price_record_t record) override {
+    std::lock_guard<std::mutex> lock_g{m_mutex};
+    bool const wasEmpty = m_dirtyIds.empty();
+    update_impl(record);
+    if (wasEmpty)
+      m_cv.notify_one();
+  }
+
+  void append_list(std::vector<price_record_t> &&records) override {
+    std::lock_guard<std::mutex> lock_g{m_mutex};
+    bool const wasEmpty = m_dirtyIds.empty();
+    for (auto const &record : records)
+      update_impl(record);
+    if (wasEmpty && !m_dirtyIds.empty())
+      m_cv.notify_one();
+  }
+
+  // publishes in the order the instruments first changed since the last drain
+  void get_all(std::vector<price_record_t> &result) override {
+    std::unique_lock<std::mutex> u_lock{m_mutex};
+    m_cv.wait_for(u_lock, std::chrono::milliseconds(100),
+                  [this] { return !m_dirtyIds.empty(); });
+    result.reserve(result.size() + m_dirtyIds.size());
+    for (auto const id : m_dirtyIds) {
+      result.push_back(m_latest[id]);
+      m_isDirty[id] = 0;
+    }
+    m_dirtyIds.clear();
+  }
+
+  void clear() override {
+    std::lock_guard<std::mutex> lock_g{m_mutex};
+    for (auto const id : m_dirtyIds)
+      m_isDirty[id] = 0;
+    m_dirtyIds.clear();
+  }
+
+  bool empty() override {
+    std::lock_guard<std::mutex> lock_g{m_mutex};
+    return m_dirtyIds.empty();
+  }
+};
+
+struct instrument_sink_t {
+  using list_t = instrument_queue_t;
+
+  // must be called before the first `get_all_listed_instruments`, i.e.
+  // before any price stream is started
+  static void configure(instrument_queue_config_t const &config) {
+    get_config() = config;
+  }
+
+  static list_t &get_all_listed_instruments(exchange_e const e) {
+    // function-local statics are initialised exactly once even when the
+    // streams of different exchanges ask for their sink concurrently
+    static auto instrumentsSink = make_sinks(get_config());
+    return *instrumentsSink[static_cast<std::size_t>(e)];
+  }
+
+private:
+  using sink_list_t = std::array<std::unique_ptr<list_t>,
+                                 static_cast<std::size_t>(exchange_e::total)>;
+
+  static instrument_queue_config_t &get_config() {
+    static instrument_queue_config_t config{};
+    return config;
+  }
+
+  static sink_list_t make_sinks(instrument_queue_config_t const &config) {
+    sink_list_t sinks;
+    for (auto &sink : sinks) {
+      if (config.conflate)
+        sink = std::make_unique<conflating_instrument_queue_t>();
+      else if (config.capacity == 0)
+        sink = std::make_unique<fifo_instrument_queue_t>();
+      else
+        sink = std::make_unique<bounded_instrument_queue_t>(config.capacity,
+                                                            config.policy);
+    }
+    return sinks;
+  }
+};
+} // namespace keep_my_journal
@@ -0,0 +1,176 @@
+// Copyright (C) 2023-2024 Joshua and Jordan Ogunyinka
+#pragma once
+
+#include <array>
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+#include <mutex>
+#include <optional>
+#include <string>
+#include <string_view>
+#include <vector>
+
+#include "price_stream/commodity.hpp"
+#include "price_stream/tick_history.hpp"
+
+namespace keep_my_journal {
+// the latest price of every instrument of one exchange, as a consumer's
+// price feed stores them and its tasks and requests read them. Neither side
+// ever waits on the other: an instrument's slot is made once, the first time
+// it's stored, and its price is then written under a seqlock the way
+// `shared_price_table_t`'s are. Slots are found the way that table's are
+// too, through buckets of atomic rows, so a new instrument is published
+// without a lock readers could be holding.
+//
+// Every price stored is numbered, one after the other, so a reader can ask
+// for only what changed since it last looked. The numbers start again with
+// the process, so they only mean something together with `epoch()`. Each
+// instrument's recent prices can also be kept, see `keep_history`.
+class instrument_store_t {
+  // a whole cache line or more, so readers of one slot don't slow the
+  // writer of its neighbours. `sequence` is odd while a write is in
+  // progress and 0 until the first one.
+  struct alignas(64) slot_t {
+    // set before the slot is published and never again
+    std::string name{};
+    trade_type_e tradeType = trade_type_e::total;
+    // null unless the store keeps history
+    std::unique_ptr<tick_history_t> history{};
+
+    std::atomic<std::uint32_t> sequence{0};
+    std::atomic<std::int32_t> priceExponent{0};
+    std::atomic<std::int32_t> open24hExponent{0};
+    std::atomic<std::int64_t> priceMantissa{0};
+    std::atomic<std::int64_t> open24hMantissa{0};
+    std::atomic<std::int64_t> exchangeTime{0};
+    std::atomic<std::int64_t> receivedTime{0};
+    std::atomic<std::int64_t> publishedTime{0};
+    // the store's sequence as of this slot's last write
+    std::atomic<std::uint64_t> updated{0};
+  };
+
+  // open addressing over a power-of-two array that's never more than half
+  // full. A bucket holds 32 bits of its key's hash above its slot's row + 1,
+  // and is 0 when it's empty, so a probe only reads a slot when those match.
+  struct bucket_table_t {
+    std::size_t const mask;
+    std::unique_ptr<std::atomic<std::uint64_t>[]> const entries;
+
+    explicit bucket_table_t(std::size_t count);
+  };
+
+  // the slots live in segments of 64, 128, 256... that are never moved or
+  // freed, so a row found unlocked stays valid. 26 of them hold as many
+  // rows as a bucket's 32 bits can name.
+  static constexpr std::size_t first_segment_size = 64;
+  static constexpr std::size_t segment_count = 26;
+
+  // writers take turns; the feed is the only one in practice
+  std::mutex m_writeMutex{};
+  // every segment and bucket table made, owned for readers still in them.
+  // Only writers touch these, readers go through the atomics below.
+  std::vector<std::unique_ptr<slot_t[]>> m_ownedSegments{};
+  std::vector<std::unique_ptr<bucket_table_t>> m_ownedBuckets{};
+  std::array<std::atomic<slot_t *>, segment_count> m_segments{};
+  // replaced by a table twice the size when it's half full
+  std::atomic<bucket_table_t const *> m_buckets{nullptr};
+  // the number of slots, published once a new one is in the buckets
+  std::atomic<std::uint32_t> m_size{0};
+  // the number of the last price stored, published once its slot is
+  // written so that `changed_since` never skips a write it hasn't seen
+  std::atomic<std::uint64_t> m_sequence{0};
+  // when the store was made, in microseconds since the epoch
+  std::int64_t const m_epoch;
+  std::size_t m_historySeconds = 0;
+
+  slot_t &slot_at(std::size_t row) const;
+  // null if the instrument has no slot yet
+  slot_t *find_slot(trade_type_e tradeType, std::string_view name) const;
+  // the slot's row goes in whichever table is current, growing it first
+  void add_to_buckets(std::uint32_t row, std::uint64_t hash);
+  // null for an instrument without a trade type
+  slot_t *slot_for(instrument_type_t const &instrument);
+  static void write(slot_t &slot, instrument_type_t const &instrument,
+                    std::uint64_t sequence);
+  // everything but the name, which the caller has or takes from the slot
+  static bool read(slot_t const &slot, instrument_type_t &result);
+
+public:
+  instrument_store_t();
+  instrument_store_t(instrument_store_t const &) = delete;
+  instrument_store_t &operator=(instrument_store_t const &) = delete;
+
+  // keeps the last `seconds` one-second prices of every instrument first
+  // stored from then on, so call it before the feed starts
+  void keep_history(std::size_t seconds);
+
+  // replaces the instrument's price, or adds it
+  void insert(instrument_type_t const &instrument);
+  // as above for every item, taking the write lock once
+  template <typename Iter> void insert_list(Iter first, Iter const last) {
+    std::lock_guard<std::mutex> lockGuard(m_writeMutex);
+    auto sequence = m_sequence.load(std::memory_order_relaxed);
+    for (; first != last; ++first) {
+      if (auto *slot = slot_for(*first); slot)
+        write(*slot, *first, ++sequence);
+    }
+    m_sequence.store(sequence, std::memory_order_release);
+  }
+
+  // looked up by name and trade type, the rest of `instrument` is ignored
+  std::optional<instrument_type_t>
+  find_item(instrument_type_t const &instrument) const;
+  // those of `names` that have a price, in the same order, into `result`
+  // whose capacity is reused
+  void find_all(trade_type_e tradeType, std::vector<std::string> const &names,
+                std::vector<instrument_type_t> &result) const;
+  // as above but only those stored since `sequence()` returned `since`, the
+  // way `changed_since` has them, without going through every instrument of
+  // the exchange. Returns what to pass next time.
+  std::uint64_t find_all(trade_type_e tradeType,
+                         std::vector<std::string> const &names,
+                         std::uint64_t since,
+                         std::vector<instrument_type_t> &result) const;
+  std::vector<instrument_type_t> to_list() const;
+  bool empty() const;
+
+  // tells this store's sequence apart from that of one made before it, by
+  // an earlier run of the process
+  std::int64_t epoch() const { return m_epoch; }
+  // the number of the last price stored, 0 before the first
+  std::uint64_t sequence() const {
+    return m_sequence.load(std::memory_order_acquire);
+  }
+  // the instruments stored since `sequence()` returned `since`, into
+  // `result` whose capacity is reused; returns what to pass next time.
+  // A price stored while this runs may come again in the next call, but
+  // none is ever missed.
+  std::uint64_t changed_since(std::uint64_t since,
+                              std::vector<instrument_type_t> &result) const;
+
+  // the instrument's prices from `from` to `to`, in seconds since the
+  // epoch, into `result`; false if it's unknown or has no history
+  bool find_history(trade_type_e tradeType, std::string const &name,
+                    std::int64_t from, std::int64_t to,
+                    std::vector<price_tick_t> &result) const;
+};
+
+// one store per exchange, all made up front so that finding one takes no
+// lock
+class instrument_exchange_set_t {
+  std::array<instrument_store_t, static_cast<std::size_t>(exchange_e::total)>
+      m_stores{};
+
+public:
+  instrument_store_t &operator[](exchange_e const exchange) {
+    return m_stores[static_cast<std::size_t>(exchange)];
+  }
+
+  void keep_history(std::size_t const seconds) {
+    for (auto &store : m_stores)
+      store.keep_history(seconds);
+  }
+};
+} // namespace keep_my_journal
@@ -0,0 +1,101 @@
+// Copyright (C) 2023-2024 Joshua and Jordan Ogunyinka
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <msgpack.hpp>
+#include <string_view>
+#include <vector>
+
+#include "price_stream/commodity.hpp"
+
+namespace keep_my_journal {
+// price_monitor's compact price format, sent instead of the msgpack records
+// of price_wire.hpp to subscribers that ask for it. Every part has a fixed
+// size and all integers are little-endian:
+//
+//   frame header, 24 bytes
+//     u8[2] magic "CP", u8 version (2), u8 flags, u16 record count,
+//     u16 reserved, i64 published (micros since the epoch),
+//     u64 feed sequence of the first record
+//   full record, 36 bytes
+//     u8 kind (1), i8 price exponent, i8 open24h exponent, u8 reserved,
+//     u32 symbol id, u16 sequence, u16 reserved,
+//     i64 price mantissa, i64 open24h mantissa,
+//     i32 published - received, i32 published - exchange
+//   delta record, 24 bytes
+//     u8 kind (2), u8 reserved, u16 sequence, u32 symbol id,
+//     i32 price mantissa change, i32 open24h mantissa change,
+//     i32 published - received, i32 published - exchange
+//
+// Symbols are `symbol_registry_t` ids, their names only go out in the
+// mappings. A symbol's records are numbered in sequence and a delta applies
+// to the one numbered just before it, with the same exponents; one whose
+// previous record went missing is dropped until the next full record. Time
+// offsets of INT32_MIN stand for a stamp that isn't known. A frame's records
+// have consecutive feed sequences (`price_record_t::sequence`), starting at
+// the header's.
+inline constexpr std::uint8_t price_binary_version = 2;
+inline constexpr std::size_t price_binary_header_size = 24;
+inline constexpr std::size_t price_binary_full_record_size = 36;
+inline constexpr std::size_t price_binary_delta_record_size = 24;
+inline constexpr std::size_t price_binary_max_records = 0xFFFF;
+
+// whether `message` starts like a binary price frame, of any version
+bool is_binary_price_frame(std::string_view message);
+
+// encodes one stream's frames, remembering what it last sent of every
+// symbol to send the next price as a delta of it
+class price_binary_encoder_t {
+  struct symbol_state_t {
+    decimal_t currentPrice;
+    decimal_t open24h;
+    std::uint16_t sequence = 0;
+    std::uint16_t sinceFull = 0;
+    bool isKnown = false;
+  };
+
+  std::vector<symbol_state_t> m_symbols{};
+  std::uint16_t const m_fullEvery;
+
+public:
+  // every symbol is sent in full at least once every `fullEvery` records,
+  // which bounds how long a subscriber that missed one waits
+  explicit price_binary_encoder_t(std::uint16_t fullEvery = 32);
+
+  // `count` (at most `price_binary_max_records`) records from `first` as
+  // one frame, published at the first record's time. Their feed sequences
+  // must follow on from the first's. Throws std::range_error, with nothing
+  // written, if any record's exponents don't fit a byte.
+  void encode_batch(msgpack::sbuffer &buffer, price_record_t const *first,
+                    std::size_t count);
+  // sends every symbol in full next, for subscribers that just joined
+  void reset();
+
+  // a frame of one full record outside of any stream: it's neither a base
+  // for deltas nor numbered. False, with nothing written, if its exponents
+  // don't fit.
+  static bool encode_record(msgpack::sbuffer &buffer,
+                            price_record_t const &record);
+};
+
+// the other end of a `price_binary_encoder_t`, one per stream subscribed to
+class price_binary_decoder_t {
+  struct symbol_state_t {
+    decimal_t currentPrice;
+    decimal_t open24h;
+    std::uint16_t sequence = 0;
+    bool isKnown = false;
+  };
+
+  std::vector<symbol_state_t> m_symbols{};
+  std::uint64_t m_droppedDeltas = 0;
+
+public:
+  // appends the frame's records to `result`, bar the deltas whose base
+  // went missing. Throws std::runtime_error on a malformed frame or one of
+  // a version this build doesn't read.
+  void decode(std::string_view message, std::vector<price_record_t> &result);
+  std::uint64_t dropped_deltas() const { return m_droppedDeltas; }
+};
+} // namespace keep_my_journal
@@ -0,0 +1,68 @@
+// Copyright (C) 2023-2024 Joshua and Jordan Ogunyinka
+#pragma once
+
+#include <cppzmq/zmq.hpp>
+#include <functional>
+#include <memory>
+#include <string>
+#include <vector>
+
+#include "price_stream/instrument_store.hpp"
+
+namespace keep_my_journal {
+struct price_feed_options_t {
+  // names the client in the logs
+  std::string name;
+  price_wire_format_e format = price_wire_format_e::msgpack;
+  // every price, or only those of the symbols the process's tasks watch,
+  // see `price_subscriptions_t`
+  bool wholeFeed = true;
+};
+
+// subscribes to price_monitor's feed of every exchange and handles them all
+// on the one thread that runs it, polling their sockets together. Each
+// message's prices are stored into `store` and then handed to the update
+// callback, so callers can act on prices as they arrive. The whole feed's
+// latest prices are loaded from a snapshot first, and a symbol's come on
+// its topic as soon as it's subscribed to, so the store is complete without
+// waiting for every symbol to tick.
+class price_feed_client_t {
+public:
+  // the instruments of one message, once they've been stored
+  using update_callback_t =
+      std::function<void(exchange_e exchange, instrument_type_t const *first,
+                         instrument_type_t const *last)>;
+
+  price_feed_client_t(zmq::context_t &context,
+                      instrument_exchange_set_t &store,
+                      price_feed_options_t options);
+  ~price_feed_client_t();
+  price_feed_client_t(price_feed_client_t const &) = delete;
+  price_feed_client_t &operator=(price_feed_client_t const &) = delete;
+
+  // called on the thread running the client, set it before `run`
+  void on_update(update_callback_t callback);
+  // connects to the feeds and handles them until `isRunning` turns false
+  void run(bool &isRunning);
+
+private:
+  struct feed_t;
+
+  bool connect();
+  void apply_subscription_changes(feed_t &feed);
+  // asks for a snapshot of the whole feed, at most one at a time
+  void request_snapshot(feed_t &feed);
+  // for when the snapshot never came or was no good
+  void ask_again(feed_t &feed);
+  void receive_snapshot(feed_t &feed);
+  // handles what's waiting on the feed's socket, up to a limit so that
+  // one busy exchange doesn't hold up the others
+  void drain(feed_t &feed);
+
+  zmq::context_t &m_context;
+  instrument_exchange_set_t &m_store;
+  price_feed_options_t const m_options;
+  update_callback_t m_onUpdate{};
+  std::vector<std::unique_ptr<feed_t>> m_feeds{};
+};
+} // namespace keep_my_journal
@@ -0,0 +1,44 @@
+// Copyright (C) 2023-2024 Joshua and Jordan Ogunyinka
+#pragma once
+
+#include <array>
+#include <map>
+#include <mutex>
+#include <string>
+#include <vector>
+
+#include "price_stream/commodity.hpp"
+
+namespace keep_my_journal {
+struct price_subscription_change_t {
+  std::string topic;
+  bool subscribe = true;
+};
+
+// the instruments a process's tasks are watching, counted per exchange, so
+// its price subscribers ask price_monitor for those symbols' topics only.
+// Tasks watch and unwatch from any thread; each exchange's subscriber
+// thread takes the resulting changes and applies them to its own socket.
+class price_subscriptions_t {
+  static constexpr auto exchange_count =
+      static_cast<std::size_t>(exchange_e::total);
+
+  std::mutex m_mutex{};
+  std::array<std::map<std::string, std::size_t>, exchange_count> m_counts{};
+  // only the first watch and the last unwatch of a topic make a change
+  std::array<std::vector<price_subscription_change_t>, exchange_count>
+      m_changes{};
+
+public:
+  static price_subscriptions_t &instance();
+
+  void watch(exchange_e exchange, trade_type_e tradeType,
+             std::vector<std::string> const &symbols);
+  void unwatch(exchange_e exchange, trade_type_e tradeType,
+               std::vector<std::string> const &symbols);
+  // moves the changes made since the last call into `result`, in the order
+  // they were made
+  void take_changes(exchange_e exchange,
+                    std::vector<price_subscription_change_t> &result);
+};
+} // namespace keep_my_journal
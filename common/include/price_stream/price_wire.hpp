@@ -0,0 +1,121 @@
+// Copyright (C) 2023-2024 Joshua and Jordan Ogunyinka
+#pragma once
+
+#include <chrono>
+#include <msgpack.hpp>
+#include <string>
+#include <string_view>
+#include <vector>
+
+#include "msgpack_reader.hpp"
+#include "price_stream/commodity.hpp"
+#include "price_stream/price_binary.hpp"
+
+namespace keep_my_journal {
+class symbol_registry_t;
+
+// how price_monitor groups records into frames: one is sent once
+// `maxRecords` are pending or the oldest has waited `maxDelay`, whichever
+// comes first. A `maxRecords` of 1 sends every record on its own.
+struct price_batch_config_t {
+  std::size_t maxRecords = 64;
+  std::chrono::microseconds maxDelay{250};
+};
+
+// Every publication from price_monitor is two zmq frames, a topic and then
+// the message. Subscribers filter on the topic's prefix:
+//   "mappings"   the symbol mappings, resent whenever someone subscribes to
+//                them; needed to resolve the ids in every price
+//   "all"        every price, in batches
+//   "prices/<exchange>/<trade type>/<symbol>/"
+//                one instrument's prices as they arrive, a record per
+//                message. Only sent while someone subscribes to a prefix
+//                of it, e.g. "prices/binance/spot/" for every spot symbol.
+//
+// Prices go out in msgpack on the topics above and in the binary format of
+// price_binary.hpp on the same topics behind "bin2/", e.g. "bin2/all". Each
+// is only sent while someone subscribes to it, so every subscriber picks
+// the format it reads and processes can move from one to the other one at
+// a time. The mappings are only ever sent in msgpack.
+//
+// A subscriber that joins late gets the latest prices rather than waiting
+// for each symbol to tick again. Subscribing to an instrument's topic, or a
+// prefix of it, is answered with the latest record of every symbol it
+// covers, on their own topics; sent once the subscription is live, nothing
+// goes missing between it and the stream. For the batched topics there's a
+// snapshot: a REQ socket connected to
+// "ipc://<deposit path>/<exchange>_snapshot" sends a msgpack list of msgpack
+// topics, or prefixes of them, the empty list for every symbol, and gets a
+// `price_snapshot_t` back. Taking the snapshot once its subscription is live
+// and then only applying stream records newer than it, by their feed
+// sequence, leaves no gap; the decoder below does it, and drops the repeats
+// a symbol's subscription can cause.
+inline constexpr std::string_view price_topic_mappings = "mappings";
+inline constexpr std::string_view price_topic_all = "all";
+inline constexpr std::string_view price_topic_prefix = "prices/";
+inline constexpr std::string_view price_topic_binary_prefix = "bin2/";
+inline constexpr std::string_view price_snapshot_suffix = "_snapshot";
+std::string price_topic(exchange_e exchange, trade_type_e tradeType,
+                        std::string_view symbol);
+// what to subscribe to for `topic`'s prices in `format`
+std::string price_topic_in(price_wire_format_e format, std::string_view topic);
+
+// the latest record of every symbol asked for, with their mappings, as of
+// the feed sequence `sequence`
+struct price_snapshot_t {
+  std::uint64_t sequence = 0;
+  std::vector<symbol_mapping_t> mappings;
+  std::vector<price_record_t> records;
+
+  MSGPACK_DEFINE(sequence, mappings, records);
+};
+
+// The message is a msgpack `price_message_type_e` followed by its payload:
+// a list of `symbol_mapping_t`, one `price_record_t`, a list of
+// `price_record_t` or a `price_snapshot_t`.
+void pack_symbol_mappings(msgpack::sbuffer &buffer,
+                          std::vector<symbol_mapping_t> const &mappings);
+void pack_price_record(msgpack::sbuffer &buffer, price_record_t const &record);
+// packs `count` records starting at `first` into one frame
+void pack_price_batch(msgpack::sbuffer &buffer, price_record_t const *first,
+                      std::size_t count);
+void pack_price_snapshot(msgpack::sbuffer &buffer,
+                         price_snapshot_t const &snapshot);
+
+// decodes the messages of one feed. The zone, the records and the
+// instruments with their names are reused from one message to the next,
+// so once warmed up decoding a price allocates nothing. A record no newer
+// than the last one applied for its symbol, by feed sequence, is dropped.
+class price_message_decoder_t {
+  msgpack_reader_t m_reader{};
+  price_binary_decoder_t m_binary{};
+  std::vector<price_record_t> m_records{};
+  price_record_t m_record{};
+  std::vector<symbol_mapping_t> m_mappings{};
+  price_snapshot_t m_snapshot{};
+  // the feed sequence last applied, by id
+  std::vector<std::uint64_t> m_appliedSequences{};
+  // only the first `m_size` are the last message's
+  std::vector<instrument_type_t> m_instruments{};
+  std::size_t m_size = 0;
+
+  void resolve(price_record_t const &record, symbol_registry_t const &registry);
+
+public:
+  // mappings, including a snapshot's, are recorded into `registry`; a
+  // price record (or each record of a batch or snapshot) for a known id is
+  // resolved into an instrument, valid until the next call. Binary frames
+  // are told apart by their header. Throws msgpack::type_error,
+  // msgpack::unpack_error or std::runtime_error on malformed input.
+  price_message_type_e decode(std::string_view message,
+                              symbol_registry_t &registry);
+
+  instrument_type_t const *begin() const { return m_instruments.data(); }
+  instrument_type_t const *end() const {
+    return m_instruments.data() + m_size;
+  }
+  std::size_t size() const { return m_size; }
+  // the feed sequence of the last snapshot decoded
+  std::uint64_t snapshot_sequence() const { return m_snapshot.sequence; }
+};
+} // namespace keep_my_journal
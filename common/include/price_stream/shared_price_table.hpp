@@ -0,0 +1,108 @@
+// Copyright (C) 2023-2024 Joshua and Jordan Ogunyinka
+#pragma once
+
+#include <array>
+#include <atomic>
+#include <cstddef>
+#include <memory>
+#include <mutex>
+#include <optional>
+#include <string>
+#include <string_view>
+#include <vector>
+
+#include "price_stream/commodity.hpp"
+
+namespace keep_my_journal {
+namespace details {
+struct shared_table_header_t;
+struct shared_price_slot_t;
+} // namespace details
+
+// the latest price of every instrument of one exchange, kept by price_monitor
+// in a POSIX shared memory object (/dev/shm/cryptolog_prices_<exchange>).
+// Each instrument has a fixed slot, its `symbol_registry_t` id, guarded by
+// a seqlock: price_monitor is the only writer and never waits on readers,
+// readers retry the few times they race with a write. The writer also
+// keeps the names hashed into a table of buckets after the slots, each
+// written once, so readers find a slot with no lock and no allocation.
+// Consumers map it read-only and look prices up without deserialising
+// anything or keeping a copy of their own.
+class shared_price_table_t {
+  exchange_e const m_exchange;
+  bool const m_isWriter;
+  void *m_address = nullptr;
+  std::size_t m_mappedSize = 0;
+  details::shared_table_header_t *m_header = nullptr;
+  details::shared_price_slot_t *m_slots = nullptr;
+
+  shared_price_table_t(exchange_e exchange, bool isWriter);
+  bool map(int fd, std::size_t size);
+  // each holds a slot's id + 1, 0 while it's empty
+  std::atomic<std::uint32_t> *buckets() const;
+  // the slot named `name`, `capacity()` if there's none
+  std::size_t find_slot(trade_type_e tradeType, std::string_view name) const;
+  bool read_slot(instrument_id_t id, instrument_type_t &result) const;
+
+public:
+  // longest symbol name a slot can hold, longer ones are never tabled
+  static constexpr std::size_t max_name_length = 39;
+
+  // (re)creates the exchange's table with room for `capacity` instruments,
+  // readers still mapping a previous table see it marked closed
+  static std::unique_ptr<shared_price_table_t> create(exchange_e exchange,
+                                                      std::size_t capacity);
+  // maps an existing table read-only, null if price_monitor hasn't made one
+  static std::unique_ptr<shared_price_table_t> open(exchange_e exchange);
+  static std::string object_name(exchange_e exchange);
+
+  ~shared_price_table_t();
+  shared_price_table_t(shared_price_table_t const &) = delete;
+  shared_price_table_t &operator=(shared_price_table_t const &) = delete;
+
+  // writer only. Symbols are added in id order, before their prices are
+  // written; false if the symbol can't be looked up in the table
+  bool add_symbol(symbol_mapping_t const &mapping);
+  void write(price_record_t const &record);
+
+  // readers: whether the writer has since gone away or replaced the table,
+  // a closed table keeps the prices it had but gets no new ones
+  bool is_closed() const;
+  std::optional<instrument_type_t> find(trade_type_e tradeType,
+                                        std::string_view name) const;
+  // those of `names` that have a price, in the same order, into `result`
+  // whose capacity is reused
+  void find_all(trade_type_e tradeType, std::vector<std::string> const &names,
+                std::vector<instrument_type_t> &result) const;
+  // every instrument that has had a price written
+  std::vector<instrument_type_t> to_list() const;
+  std::size_t capacity() const;
+  std::size_t size() const;
+};
+
+// a consumer's read-only view of every exchange's table. A table is opened
+// when first asked for and reopened once closed, so consumers may start
+// before price_monitor and carry on across its restarts. Finding the open
+// table is an atomic load; only opening one takes a lock.
+class shared_price_tables_t {
+  using table_ptr_t = shared_price_table_t const *;
+
+  std::array<std::atomic<table_ptr_t>,
+             static_cast<std::size_t>(exchange_e::total)>
+      m_tables{};
+  // opening a table. Every one opened stays mapped until the process ends,
+  // as a closed one may still be read; there's one per price_monitor run.
+  std::mutex m_mutex{};
+  std::vector<std::unique_ptr<shared_price_table_t const>> m_opened{};
+  bool m_isEnabled = false;
+
+public:
+  static shared_price_tables_t &instance();
+
+  // the process reads prices from the tables instead of subscribing to them
+  void enable() { m_isEnabled = true; }
+  bool is_enabled() const { return m_isEnabled; }
+  // null while price_monitor hasn't shared a table for `exchange`
+  table_ptr_t get(exchange_e exchange);
+};
+} // namespace keep_my_journal
@@ -0,0 +1,45 @@
+// Copyright (C) 2023-2024 Joshua and Jordan Ogunyinka
+#pragma once
+
+#include <array>
+#include <deque>
+#include <optional>
+#include <shared_mutex>
+#include <string_view>
+#include <unordered_map>
+#include <vector>
+
+#include "price_stream/commodity.hpp"
+
+namespace keep_my_journal {
+// hands out dense ids for the (trade type, symbol) pairs of one exchange, so
+// the (exchange, id) pair names an instrument. price_monitor interns the
+// symbols it sees, the other processes rebuild the same table from the
+// mappings price_monitor publishes.
+class symbol_registry_t {
+  static constexpr auto trade_type_count =
+      static_cast<std::size_t>(trade_type_e::total);
+
+  mutable std::shared_mutex m_mutex{};
+  // keys are views into m_storage, which never moves its elements
+  std::array<std::unordered_map<std::string_view, instrument_id_t>,
+             trade_type_count>
+      m_ids{};
+  std::deque<symbol_mapping_t> m_storage{};
+  // indexed by id, entries are null for ids not (yet) known to this process
+  std::vector<symbol_mapping_t const *> m_symbols{};
+
+public:
+  static symbol_registry_t &get(exchange_e exchange);
+
+  instrument_id_t intern(trade_type_e tradeType, std::string_view name);
+  std::optional<instrument_id_t> find_id(trade_type_e tradeType,
+                                         std::string_view name) const;
+  // the returned pointer stays valid for the lifetime of the process
+  symbol_mapping_t const *find_symbol(instrument_id_t id) const;
+  // records a mapping that was assigned by another process
+  void assign(symbol_mapping_t const &mapping);
+  std::vector<symbol_mapping_t> symbols_from(instrument_id_t firstId) const;
+  std::size_t size() const;
+};
+} // namespace keep_my_journal
@@ -15,7 +15,8 @@ struct scheduled_price_task_t {
   };
 
   struct percentage_based_property_t {
-    double percentage{};
+    // signed, negative for `price_direction_e::down`
+    decimal_t percentage;
     price_direction_e direction = price_direction_e::invalid;
 #ifdef CRYPTOLOG_USING_MSGPACK
     MSGPACK_DEFINE(percentage, direction);
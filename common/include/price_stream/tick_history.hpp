@@ -0,0 +1,63 @@
+// Copyright (C) 2023-2024 Joshua and Jordan Ogunyinka
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <mutex>
+#include <vector>
+
+#include "decimal.hpp"
+
+namespace keep_my_journal {
+// a price as of the end of one second
+struct price_tick_t {
+  std::int64_t time = 0; // seconds since the epoch
+  decimal_t price;
+};
+
+// one instrument's recent prices at one-second resolution: the last price
+// of each second it ticked in, the latest `capacity` of them. Kept as
+// columns, with the seconds stored as offsets from the first one, so a
+// point takes 13 bytes; the columns only grow as far as they're filled.
+// The writer adds to the end in O(1) and a range is found by binary search,
+// both under a mutex of the history's own. The writer never waits for it:
+// while a reader holds it to copy, points are kept aside and go in with the
+// next one written.
+class tick_history_t {
+  // points kept aside at most, past that the last one is replaced. A reader
+  // would have to hold the mutex for that many seconds.
+  static constexpr std::size_t max_pending = 64;
+
+  std::size_t const m_capacity;
+  mutable std::mutex m_mutex{};
+  // only the writer touches these, not under the mutex
+  std::vector<price_tick_t> m_pending{};
+  std::int64_t m_firstSecond = 0;
+  std::vector<std::uint32_t> m_seconds{};
+  std::vector<std::int64_t> m_mantissas{};
+  std::vector<std::int8_t> m_exponents{};
+  // where the oldest point is once the columns are full
+  std::size_t m_head = 0;
+
+  // the column index of the `i`th oldest point
+  std::size_t position(std::size_t i) const;
+  std::int64_t second_at(std::size_t i) const;
+  // with the mutex held
+  void add(std::int64_t second, decimal_t const &price);
+  void keep_aside(std::int64_t second, decimal_t const &price);
+
+public:
+  explicit tick_history_t(std::size_t capacity);
+
+  // a price seen at `micros` since the epoch. One in the same second as the
+  // last point, or an earlier one, replaces its price. Prices whose
+  // exponent doesn't fit a byte aren't kept. Only one thread may append at
+  // a time; the store's writers take turns.
+  void append(std::int64_t micros, decimal_t const &price);
+  // the points from `from` to `to` (seconds since the epoch, inclusive),
+  // oldest first, into `result` whose capacity is reused
+  void range(std::int64_t from, std::int64_t to,
+             std::vector<price_tick_t> &result) const;
+  std::size_t size() const;
+};
+} // namespace keep_my_journal
@@ -0,0 +1,62 @@
+// Copyright (C) 2023-2024 Joshua and Jordan Ogunyinka
+#pragma once
+
+#include <boost/asio/io_context.hpp>
+#include <boost/asio/steady_timer.hpp>
+#include <chrono>
+#include <deque>
+#include <functional>
+#include <string>
+
+namespace keep_my_journal {
+namespace net = boost::asio;
+
+struct reconnect_config_t {
+  std::chrono::milliseconds initialDelay{500};
+  std::chrono::milliseconds maxDelay{std::chrono::seconds(30)};
+  double multiplier = 2.0;
+  // each delay is randomly spread by up to this fraction either way, so
+  // streams that dropped together don't all come back at the same instant
+  double jitter = 0.2;
+  // no more than `maxAttempts` reconnects are started in any `attemptWindow`
+  std::size_t maxAttempts = 10;
+  std::chrono::seconds attemptWindow{60};
+};
+
+// schedules a stream's reconnects on its own io_context with exponential
+// backoff, instead of blocking the io thread (and every other stream on it)
+// or retrying in a tight loop. Not thread-safe: it's meant to be driven from
+// the stream's handlers, which never run concurrently.
+class reconnect_policy_t {
+public:
+  using resync_handler_t = std::function<void()>;
+
+  reconnect_policy_t(net::io_context &ioContext, std::string name,
+                     reconnect_config_t config = {});
+
+  // runs `reconnect` once the next backoff delay has passed, replacing any
+  // reconnect that is still pending
+  void schedule(std::function<void()> reconnect);
+  // to be called once a connection is up again: resets the backoff and, if
+  // this ends a run of failures, runs the resync handler
+  void on_connected();
+  // run after a reconnect, for whatever the exchange only sends once per
+  // connection and that has to be asked for again
+  void set_resync_handler(resync_handler_t handler) {
+    m_resyncHandler = std::move(handler);
+  }
+  void cancel();
+  std::size_t failed_attempts() const { return m_failedAttempts; }
+
+private:
+  std::chrono::milliseconds next_delay();
+
+  net::steady_timer m_timer;
+  std::string const m_name;
+  reconnect_config_t const m_config;
+  resync_handler_t m_resyncHandler = nullptr;
+  std::deque<std::chrono::steady_clock::time_point> m_recentAttempts{};
+  std::chrono::milliseconds m_lastDelay{};
+  std::size_t m_failedAttempts = 0;
+};
+} // namespace keep_my_journal
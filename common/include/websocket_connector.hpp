@@ -0,0 +1,86 @@
+// Copyright (C) 2023-2024 Joshua and Jordan Ogunyinka
+#pragma once
+
+#include "dns_cache.hpp"
+#include <boost/asio/ip/tcp.hpp>
+#include <boost/asio/ssl/context.hpp>
+#include <boost/beast/core/tcp_stream.hpp>
+#include <boost/beast/ssl/ssl_stream.hpp>
+#include <boost/beast/websocket/stream.hpp>
+#include <atomic>
+#include <chrono>
+#include <functional>
+#include <map>
+#include <memory>
+#include <mutex>
+#include <string>
+
+namespace keep_my_journal {
+namespace net = boost::asio;
+namespace beast = boost::beast;
+
+using ssl_websocket_stream_t =
+    beast::websocket::stream<beast::ssl_stream<beast::tcp_stream>>;
+
+// keeps the last TLS session each host handed out so that the next
+// connection to it can resume it instead of doing a full handshake. That
+// matters most after an outage, when every stream reconnects at once.
+class tls_session_cache_t {
+  std::mutex m_mutex{};
+  // sessions are kept serialised: OpenSSL marks a live session as not
+  // resumable when its connection drops without a TLS shutdown, which is
+  // how most connections that need a reconnect end
+  std::map<std::string, std::string, std::less<>> m_sessions{};
+  std::atomic<std::size_t> m_resumed = 0;
+  std::atomic<std::size_t> m_fullHandshakes = 0;
+
+  static int on_new_session(SSL *ssl, SSL_SESSION *session);
+
+public:
+  static tls_session_cache_t &instance();
+
+  // has OpenSSL hand every new client session on `context` to the cache,
+  // must be called before `context` is used by any connection
+  static void install(net::ssl::context &context);
+  // offers the cached session for `host` (if any) on the next handshake
+  void prepare(SSL *ssl, std::string const &host);
+  void record_handshake(bool resumed);
+  std::size_t resumed_count() const { return m_resumed; }
+  std::size_t full_handshake_count() const { return m_fullHandshakes; }
+};
+
+struct websocket_endpoint_t {
+  std::string host;
+  std::string service; // port number or service name
+  std::string path;    // the websocket upgrade target
+};
+
+// the resolve -> connect -> SNI -> TLS handshake -> websocket upgrade chain
+// all the exchanges' streams go through. The caller owns the stream, sets
+// its websocket options beforehand and keeps it alive until `handler` runs.
+class websocket_connector_t
+    : public std::enable_shared_from_this<websocket_connector_t> {
+public:
+  using handler_t = std::function<void(beast::error_code const &)>;
+
+  static void connect(ssl_websocket_stream_t &stream,
+                      websocket_endpoint_t endpoint, handler_t handler);
+
+  websocket_connector_t(ssl_websocket_stream_t &stream,
+                        websocket_endpoint_t endpoint, handler_t handler);
+
+private:
+  using results_type = dns_cache_t::results_type;
+
+  void resolve();
+  void connect_to_resolved_names(results_type const &);
+  void perform_ssl_handshake();
+  void perform_websocket_handshake();
+  void complete(beast::error_code const &ec);
+
+  ssl_websocket_stream_t &m_stream;
+  websocket_endpoint_t const m_endpoint;
+  handler_t m_handler;
+  std::chrono::steady_clock::time_point const m_startTime;
+};
+} // namespace keep_my_journal
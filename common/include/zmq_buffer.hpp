@@ -0,0 +1,33 @@
+// Copyright (C) 2023-2024 Joshua and Jordan Ogunyinka
+#pragma once
+
+#include <algorithm>
+#include <cppzmq/zmq.hpp>
+#include <cstdlib>
+#include <msgpack.hpp>
+#include <string_view>
+
+namespace keep_my_journal {
+// zmq stores messages up to this size inside the message itself
+inline constexpr std::size_t zmq_inline_message_size = 32;
+
+// what's been packed into `buffer` as a zmq message, without copying it: the
+// message takes the buffer's memory and frees it once sent, and `buffer`
+// starts over with room for another message as large. Small messages are
+// still copied, as zmq keeps those inline and that costs no allocation.
+inline zmq::message_t release_to_message(msgpack::sbuffer &buffer) {
+  auto const size = buffer.size();
+  if (size <= zmq_inline_message_size) {
+    zmq::message_t message(std::string_view(buffer.data(), size));
+    buffer.clear();
+    return message;
+  }
+
+  // sbuffer allocates with malloc and realloc
+  auto *data = buffer.release();
+  buffer = msgpack::sbuffer(std::max<std::size_t>(size, 256));
+  return zmq::message_t(
+      data, size, [](void *const memory, void *) { std::free(memory); },
+      nullptr);
+}
+} // namespace keep_my_journal
@@ -0,0 +1,98 @@
+// Copyright (C) 2023-2024 Joshua and Jordan Ogunyinka
+
+#include "allocation_counter.hpp"
+
+#include <spdlog/spdlog.h>
+
+#ifdef CRYPTOLOG_COUNT_ALLOCATIONS
+#include <cstdlib>
+#include <new>
+
+namespace {
+thread_local std::uint64_t threadAllocations = 0;
+
+void *counted_allocation(std::size_t const size) noexcept {
+  ++threadAllocations;
+  return std::malloc(size == 0 ? 1 : size);
+}
+} // namespace
+
+// only the plain forms are replaced, over-aligned allocations go to the
+// library's own and aren't counted
+void *operator new(std::size_t const size) {
+  if (auto *memory = counted_allocation(size))
+    return memory;
+  throw std::bad_alloc();
+}
+
+void *operator new[](std::size_t const size) {
+  if (auto *memory = counted_allocation(size))
+    return memory;
+  throw std::bad_alloc();
+}
+
+void *operator new(std::size_t const size, std::nothrow_t const &) noexcept {
+  return counted_allocation(size);
+}
+
+void *operator new[](std::size_t const size, std::nothrow_t const &) noexcept {
+  return counted_allocation(size);
+}
+
+void operator delete(void *memory) noexcept { std::free(memory); }
+void operator delete[](void *memory) noexcept { std::free(memory); }
+void operator delete(void *memory, std::size_t) noexcept { std::free(memory); }
+void operator delete[](void *memory, std::size_t) noexcept {
+  std::free(memory);
+}
+void operator delete(void *memory, std::nothrow_t const &) noexcept {
+  std::free(memory);
+}
+void operator delete[](void *memory, std::nothrow_t const &) noexcept {
+  std::free(memory);
+}
+#endif
+
+namespace keep_my_journal {
+bool allocations_counted() {
+#ifdef CRYPTOLOG_COUNT_ALLOCATIONS
+  return true;
+#else
+  return false;
+#endif
+}
+
+std::uint64_t thread_allocations() {
+#ifdef CRYPTOLOG_COUNT_ALLOCATIONS
+  return threadAllocations;
+#else
+  return 0;
+#endif
+}
+
+allocation_stats_t::allocation_stats_t(std::string name,
+                                       std::chrono::seconds const interval)
+    : m_name(std::move(name)), m_interval(interval),
+      m_lastReport(std::chrono::steady_clock::now()),
+      m_lastAllocations(thread_allocations()) {}
+
+void allocation_stats_t::messages_done(std::uint64_t const count) {
+  if (!allocations_counted())
+    return;
+
+  m_messages += count;
+  auto const now = std::chrono::steady_clock::now();
+  if (now - m_lastReport < m_interval || m_messages == 0)
+    return;
+
+  auto const allocations = thread_allocations() - m_lastAllocations;
+  spdlog::info("{}: {:.2f} allocations per message over {} messages", m_name,
+               static_cast<double>(allocations) /
+                   static_cast<double>(m_messages),
+               m_messages);
+  // what logging allocated isn't put down to the next messages
+  m_lastAllocations = thread_allocations();
+  m_lastReport = now;
+  m_messages = 0;
+}
+} // namespace keep_my_journal
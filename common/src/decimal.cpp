@@ -0,0 +1,219 @@
+// Copyright (C) 2023-2024 Joshua and Jordan Ogunyinka
+
+#include "decimal.hpp"
+
+#include <charconv>
+#include <cmath>
+#include <limits>
+
+namespace keep_my_journal {
+namespace {
+using int128_t = __int128;
+
+constexpr int max_significant_digits = 18;
+constexpr std::int64_t max_mantissa = std::numeric_limits<std::int64_t>::max();
+
+constexpr int128_t power_of_ten(int const power) {
+  int128_t result = 1;
+  for (int i = 0; i < power; ++i)
+    result *= 10;
+  return result;
+}
+
+// divides by 10^power, rounding half away from zero
+int128_t divide_rounded(int128_t const value, int const power) {
+  if (power > 38)
+    return 0;
+  auto const divisor = power_of_ten(power);
+  auto quotient = value / divisor;
+  auto const remainder = value % divisor;
+  if (remainder * 2 >= divisor)
+    ++quotient;
+  else if (remainder * 2 <= -divisor)
+    --quotient;
+  return quotient;
+}
+
+// fits a wide mantissa back into 64 bits, dropping the least significant
+// digits (rounded) if it has to
+decimal_t normalise(int128_t const mantissa, std::int32_t const exponent) {
+  auto const magnitude = mantissa < 0 ? -mantissa : mantissa;
+  if (magnitude <= max_mantissa)
+    return decimal_t(static_cast<std::int64_t>(mantissa), exponent);
+
+  int dropped = 1;
+  while (magnitude / power_of_ten(dropped) > max_mantissa)
+    ++dropped;
+  auto rounded = divide_rounded(mantissa, dropped);
+  // rounding up can carry into one more digit
+  if (rounded > max_mantissa || rounded < -max_mantissa) {
+    rounded = divide_rounded(mantissa, ++dropped);
+  }
+  return decimal_t(static_cast<std::int64_t>(rounded), exponent + dropped);
+}
+
+int sign_of(std::int64_t const value) { return (value > 0) - (value < 0); }
+} // namespace
+
+decimal_t operator+(decimal_t const &a, decimal_t const &b) {
+  if (a.mantissa == 0)
+    return b;
+  if (b.mantissa == 0)
+    return a;
+
+  // `high` has the larger exponent and is brought down to `low`'s scale
+  auto const &high = a.exponent >= b.exponent ? a : b;
+  auto const &low = a.exponent >= b.exponent ? b : a;
+  auto const difference = high.exponent - low.exponent;
+
+  if (difference <= max_significant_digits) {
+    auto const sum =
+        int128_t(high.mantissa) * power_of_ten(difference) + low.mantissa;
+    return normalise(sum, low.exponent);
+  }
+
+  // `low` is too small to matter beyond the 18 digits kept for `high`
+  auto const shift = difference - max_significant_digits;
+  auto const sum = int128_t(high.mantissa) *
+                       power_of_ten(max_significant_digits) +
+                   divide_rounded(low.mantissa, shift);
+  return normalise(sum, high.exponent - max_significant_digits);
+}
+
+decimal_t operator-(decimal_t const &a, decimal_t const &b) { return a + -b; }
+
+decimal_t operator*(decimal_t const &a, decimal_t const &b) {
+  return normalise(int128_t(a.mantissa) * b.mantissa, a.exponent + b.exponent);
+}
+
+int compare(decimal_t const &a, decimal_t const &b) {
+  auto const signA = sign_of(a.mantissa);
+  auto const signB = sign_of(b.mantissa);
+  if (signA != signB)
+    return signA < signB ? -1 : 1;
+  if (signA == 0)
+    return 0;
+
+  bool const aIsHigh = a.exponent >= b.exponent;
+  auto const &high = aIsHigh ? a : b;
+  auto const &low = aIsHigh ? b : a;
+  auto const difference = high.exponent - low.exponent;
+
+  int result = 0;
+  if (difference <= max_significant_digits + 1) {
+    auto const scaled = int128_t(high.mantissa) * power_of_ten(difference);
+    result = (scaled > low.mantissa) - (scaled < low.mantissa);
+  } else {
+    // |high| >= 10^high.exponent > |low|, so the sign decides
+    result = signA;
+  }
+  return aIsHigh ? result : -result;
+}
+
+decimal_t decimal_t::from_double(double const value) {
+  if (!std::isfinite(value))
+    return {};
+
+  char buffer[32]{};
+  auto const [end, ec] = std::to_chars(buffer, buffer + sizeof(buffer), value,
+                                       std::chars_format::general, 15);
+  decimal_t result;
+  if (ec != std::errc{} || !parse_decimal({buffer, std::size_t(end - buffer)},
+                                          result))
+    return {};
+  return result;
+}
+
+double decimal_t::to_double() const {
+  constexpr std::int64_t max_exact_integer = std::int64_t(1) << 53;
+  // both operands are exact doubles, so this is correctly rounded
+  if (exponent <= 0 && exponent >= -22 && mantissa < max_exact_integer &&
+      mantissa > -max_exact_integer) {
+    constexpr double powers[] = {1e0,  1e1,  1e2,  1e3,  1e4,  1e5,
+                                 1e6,  1e7,  1e8,  1e9,  1e10, 1e11,
+                                 1e12, 1e13, 1e14, 1e15, 1e16, 1e17,
+                                 1e18, 1e19, 1e20, 1e21, 1e22};
+    return static_cast<double>(mantissa) / powers[-exponent];
+  }
+  return static_cast<double>(mantissa) * std::pow(10.0, exponent);
+}
+
+std::string decimal_t::to_string() const {
+  std::string digits = std::to_string(mantissa < 0 ? -mantissa : mantissa);
+  if (exponent >= 0) {
+    if (mantissa != 0)
+      digits.append(static_cast<std::size_t>(exponent), '0');
+  } else {
+    auto const fractionLength = static_cast<std::size_t>(-exponent);
+    if (digits.size() <= fractionLength)
+      digits.insert(0, fractionLength - digits.size() + 1, '0');
+    digits.insert(digits.size() - fractionLength, 1, '.');
+  }
+  return mantissa < 0 ? "-" + digits : digits;
+}
+
+bool parse_decimal(std::string_view const str, decimal_t &result) {
+  char const *current = str.data();
+  char const *const end = str.data() + str.size();
+  if (current == end)
+    return false;
+
+  bool const isNegative = *current == '-';
+  if (*current == '-' || *current == '+')
+    ++current;
+
+  auto isDigit = [](char const c) { return c >= '0' && c <= '9'; };
+  std::int64_t mantissa = 0;
+  std::int32_t exponent = 0;
+  int significantDigits = 0;
+  bool hasDigits = false;
+
+  for (; current != end && isDigit(*current); ++current) {
+    hasDigits = true;
+    if (significantDigits < max_significant_digits) {
+      mantissa = mantissa * 10 + (*current - '0');
+      significantDigits += (mantissa != 0);
+    } else {
+      ++exponent;
+    }
+  }
+
+  if (current != end && *current == '.') {
+    for (++current; current != end && isDigit(*current); ++current) {
+      hasDigits = true;
+      if (significantDigits < max_significant_digits) {
+        mantissa = mantissa * 10 + (*current - '0');
+        significantDigits += (mantissa != 0);
+        --exponent;
+      }
+    }
+  }
+
+  if (!hasDigits)
+    return false;
+
+  if (current != end && (*current == 'e' || *current == 'E')) {
+    ++current;
+    bool const isNegativeExponent = current != end && *current == '-';
+    if (current != end && (*current == '-' || *current == '+'))
+      ++current;
+    if (current == end || !isDigit(*current))
+      return false;
+
+    std::int32_t value = 0;
+    for (; current != end && isDigit(*current); ++current) {
+      if (value > 100'000)
+        return false;
+      value = value * 10 + (*current - '0');
+    }
+    exponent += isNegativeExponent ? -value : value;
+  }
+
+  if (current != end)
+    return false;
+
+  result.mantissa = isNegative ? -mantissa : mantissa;
+  result.exponent = exponent;
+  return true;
+}
+} // namespace keep_my_journal
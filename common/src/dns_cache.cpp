@@ -0,0 +1,151 @@
+// Copyright (C) 2023-2024 Joshua and Jordan Ogunyinka
+
+#include "dns_cache.hpp"
+
+#include <boost/asio/post.hpp>
+#include <memory>
+#include <spdlog/spdlog.h>
+
+namespace keep_my_journal {
+namespace {
+void complete(net::any_io_executor const &executor,
+              dns_cache_t::handler_t handler,
+              boost::system::error_code const &ec,
+              dns_cache_t::results_type const &results) {
+  net::post(executor, [handler = std::move(handler), ec, results] {
+    handler(ec, results);
+  });
+}
+} // namespace
+
+dns_cache_t &dns_cache_t::instance() {
+  static dns_cache_t cache{};
+  return cache;
+}
+
+void dns_cache_t::set_config(dns_cache_config_t const &config) {
+  std::lock_guard<std::mutex> lock_g{m_mutex};
+  m_config = config;
+}
+
+void dns_cache_t::add_override(std::string host, std::string address,
+                               std::string service) {
+  spdlog::info("Connections to {} go to {}:{}", host, address, service);
+  std::lock_guard<std::mutex> lock_g{m_mutex};
+  m_overrides.insert_or_assign(std::move(host),
+                               override_t{std::move(address),
+                                          std::move(service)});
+  // whatever was resolved before no longer applies, lookups still in flight
+  // have callers waiting on their entries though
+  for (auto iter = m_entries.begin(); iter != m_entries.end();) {
+    if (iter->second.resolving)
+      ++iter;
+    else
+      iter = m_entries.erase(iter);
+  }
+}
+
+bool dns_cache_t::add_override(std::string_view const spec) {
+  auto const equalSign = spec.find('=');
+  auto const colon = spec.rfind(':');
+  if (equalSign == std::string_view::npos || colon == std::string_view::npos ||
+      colon < equalSign || equalSign == 0 || colon == equalSign + 1 ||
+      colon + 1 == spec.size())
+    return false;
+
+  add_override(std::string(spec.substr(0, equalSign)),
+               std::string(spec.substr(equalSign + 1, colon - equalSign - 1)),
+               std::string(spec.substr(colon + 1)));
+  return true;
+}
+
+std::pair<std::string, std::string>
+dns_cache_t::apply_override(std::string const &host,
+                            std::string const &service) {
+  std::lock_guard<std::mutex> lock_g{m_mutex};
+  if (m_overrides.empty())
+    return {host, service};
+
+  auto iter = m_overrides.find(host);
+  if (iter == m_overrides.end())
+    iter = m_overrides.find("*");
+  if (iter == m_overrides.end())
+    return {host, service};
+  return {iter->second.address, iter->second.service};
+}
+
+void dns_cache_t::async_resolve(net::any_io_executor const &executor,
+                                std::string const &requestedHost,
+                                std::string const &requestedService,
+                                handler_t handler) {
+  auto const [host, service] = apply_override(requestedHost, requestedService);
+  auto const now = std::chrono::steady_clock::now();
+  bool mustResolve = false;
+  {
+    std::lock_guard<std::mutex> lock_g{m_mutex};
+    auto &entry = m_entries[host + ':' + service];
+    if (entry.expiry > now) {
+      complete(executor, std::move(handler), entry.error, entry.results);
+      if (!entry.error && !entry.resolving &&
+          entry.expiry - now < m_config.refreshAhead)
+        mustResolve = entry.resolving = true;
+    } else {
+      entry.waiters.push_back({executor, std::move(handler)});
+      if (!entry.resolving)
+        mustResolve = entry.resolving = true;
+    }
+  }
+
+  if (mustResolve)
+    start_resolve(executor, host, service);
+}
+
+void dns_cache_t::start_resolve(net::any_io_executor const &executor,
+                                std::string const &host,
+                                std::string const &service) {
+  auto resolver = std::make_shared<net::ip::tcp::resolver>(executor);
+  resolver->async_resolve(
+      host, service,
+      [this, resolver, key = host + ':' + service](
+          boost::system::error_code const ec, results_type results) {
+        on_resolved(key, ec, std::move(results));
+      });
+}
+
+void dns_cache_t::on_resolved(std::string const &key,
+                              boost::system::error_code const ec,
+                              results_type results) {
+  auto const now = std::chrono::steady_clock::now();
+  std::lock_guard<std::mutex> lock_g{m_mutex};
+  auto &entry = m_entries[key];
+  entry.resolving = false;
+
+  if (!ec) {
+    entry.results = std::move(results);
+    entry.error = {};
+    entry.expiry = now + m_config.ttl;
+  } else {
+    spdlog::warn("Unable to resolve {}: {}", key, ec.message());
+    // a failed background refresh keeps the addresses we already have
+    if (entry.expiry <= now || entry.error) {
+      entry.results = {};
+      entry.error = ec;
+      entry.expiry = now + m_config.negativeTtl;
+    }
+  }
+
+  for (auto &waiter : entry.waiters)
+    complete(waiter.executor, std::move(waiter.handler), entry.error,
+             entry.results);
+  entry.waiters.clear();
+}
+
+void dns_cache_t::invalidate(std::string const &requestedHost,
+                             std::string const &requestedService) {
+  auto const [host, service] = apply_override(requestedHost, requestedService);
+  std::lock_guard<std::mutex> lock_g{m_mutex};
+  if (auto iter = m_entries.find(host + ':' + service);
+      iter != m_entries.end())
+    iter->second.expiry = {};
+}
+} // namespace keep_my_journal
@@ -1,6 +1,7 @@
 #include "http_rest_client.hpp"
 
 #include "crypto_utils.hpp"
+#include "dns_cache.hpp"
 #include <boost/beast/http/read.hpp>
 #include <boost/beast/http/write.hpp>
 #include <utility>
@@ -15,11 +16,9 @@ http_rest_client_t::http_rest_client_t(net::io_context &ioContext,
       m_target(std::move(target)) {}
 
 void http_rest_client_t::rest_api_initiate_connection() {
-  m_resolver.emplace(m_ioContext);
-  m_resolver->async_resolve(
-      m_hostApi, m_service,
-      [this](auto const error_code,
-             net::ip::tcp::resolver::results_type const &results) {
+  dns_cache_t::instance().async_resolve(
+      m_ioContext.get_executor(), m_hostApi, m_service,
+      [this](auto const &error_code, results_type const &results) {
         if (error_code)
           return report_error_and_retry(error_code);
         rest_api_connect_to_resolved_names(results);
@@ -51,14 +50,15 @@ void http_rest_client_t::report_error_and_retry(
 
 void http_rest_client_t::rest_api_connect_to_resolved_names(
     results_type const &resolved_names) {
-  m_resolver.reset();
-
   m_tcpStream.emplace(m_ioContext);
   m_tcpStream->expires_after(std::chrono::seconds(30));
   m_tcpStream->async_connect(resolved_names,
                              [this](auto const error_code, auto const &) {
-                               if (error_code)
+                               if (error_code) {
+                                 dns_cache_t::instance().invalidate(m_hostApi,
+                                                                    m_service);
                                  return report_error_and_retry(error_code);
+                               }
                                rest_api_perform_action();
                              });
 }
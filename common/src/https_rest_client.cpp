@@ -1,6 +1,7 @@
 #include "https_rest_client.hpp"
 
 #include "crypto_utils.hpp"
+#include "dns_cache.hpp"
 #include <boost/beast/http/read.hpp>
 #include <boost/beast/http/write.hpp>
 
@@ -21,18 +22,15 @@ std::string method_string(http_method_e const method) {
 
 https_rest_api_t::https_rest_api_t(
     net::io_context &ioContext, net::ssl::context &sslContext,
-    beast::ssl_stream<beast::tcp_stream> &sslStream, resolver &resolver,
-    char const *const hostApi, char const *const service,
-    std::string const &target)
+    beast::ssl_stream<beast::tcp_stream> &sslStream, char const *const hostApi,
+    char const *const service, std::string const &target)
     : m_ioContext(ioContext), m_sslContext(sslContext), m_sslStream(sslStream),
-      m_resolver(resolver), m_hostApi(hostApi), m_service(service),
-      m_target(target) {}
+      m_hostApi(hostApi), m_service(service), m_target(target) {}
 
 void https_rest_api_t::rest_api_initiate_connection() {
-  m_resolver.async_resolve(
-      m_hostApi, m_service,
-      [this](auto const error_code,
-             net::ip::tcp::resolver::results_type const &results) {
+  dns_cache_t::instance().async_resolve(
+      m_ioContext.get_executor(), m_hostApi, m_service,
+      [this](auto const &error_code, results_type const &results) {
         if (error_code)
           return m_errorCallback(error_code);
         rest_api_connect_to_resolved_names(results);
@@ -45,8 +43,11 @@ void https_rest_api_t::rest_api_connect_to_resolved_names(
   beast::get_lowest_layer(m_sslStream)
       .async_connect(resolved_names,
                      [this](auto const error_code, auto const &connected_name) {
-                       if (error_code)
+                       if (error_code) {
+                         dns_cache_t::instance().invalidate(m_hostApi,
+                                                            m_service);
                          return m_errorCallback(error_code);
+                       }
                        rest_api_perform_ssl_handshake(connected_name);
                      });
 }
@@ -6,6 +6,10 @@ std::string exchangesToString(exchange_e);
 std::string tradeTypeToString(trade_type_e);
 } // namespace utils
 
+// JSON numbers are doubles to most readers anyway; shortest round-trip
+// formatting keeps up to 15 significant digits as they were sent
+void to_json(json &j, decimal_t const &data) { j = data.to_double(); }
+
 void to_json(json &j, scheduled_price_task_t const &data) {
   json::object_t obj;
   obj["task_id"] = data.task_id;
@@ -19,8 +23,9 @@ void to_json(json &j, scheduled_price_task_t const &data) {
                            .count();
     obj["duration"] = "seconds";
   } else if (data.percentProp) {
-    obj["direction"] = data.percentProp->percentage < 0 ? "down" : "up";
-    obj["percentage"] = std::abs(data.percentProp->percentage);
+    auto const &percentage = data.percentProp->percentage;
+    obj["direction"] = percentage.is_negative() ? "down" : "up";
+    obj["percentage"] = percentage.abs();
   }
 
   j = obj;
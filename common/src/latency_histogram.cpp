@@ -0,0 +1,151 @@
+// Copyright (C) 2023-2024 Joshua and Jordan Ogunyinka
+
+#include "latency_histogram.hpp"
+
+#include <algorithm>
+#include <spdlog/spdlog.h>
+
+namespace keep_my_journal {
+namespace {
+constexpr auto stage_count = static_cast<std::size_t>(latency_stage_e::total);
+
+std::size_t bucket_for(std::uint64_t const micros) {
+  std::size_t bucket = 0;
+  for (auto value = micros; value != 0; value >>= 1)
+    ++bucket;
+  return std::min(bucket, latency_histogram_t::bucket_count - 1);
+}
+
+std::int64_t bucket_upper_bound(std::size_t const bucket) {
+  return std::int64_t(1) << bucket;
+}
+} // namespace
+
+std::int64_t micros_since_epoch() {
+  return std::chrono::duration_cast<std::chrono::microseconds>(
+             std::chrono::system_clock::now().time_since_epoch())
+      .count();
+}
+
+char const *latency_stage_to_string(latency_stage_e const stage) {
+  switch (stage) {
+  case latency_stage_e::exchange_to_receive:
+    return "exchange_to_receive";
+  case latency_stage_e::receive_to_publish:
+    return "receive_to_publish";
+  case latency_stage_e::publish_to_consume:
+    return "publish_to_consume";
+  case latency_stage_e::end_to_end:
+    return "end_to_end";
+  default:
+    return "unknown";
+  }
+}
+
+void latency_histogram_t::record(std::int64_t micros) {
+  // the clocks of the exchange and ours are never quite in step
+  if (micros < 0)
+    micros = 0;
+
+  auto const value = static_cast<std::uint64_t>(micros);
+  m_buckets[bucket_for(value)].fetch_add(1, std::memory_order_relaxed);
+  m_count.fetch_add(1, std::memory_order_relaxed);
+  m_sum.fetch_add(value, std::memory_order_relaxed);
+
+  auto currentMax = m_max.load(std::memory_order_relaxed);
+  while (micros > currentMax &&
+         !m_max.compare_exchange_weak(currentMax, micros,
+                                      std::memory_order_relaxed))
+    ;
+}
+
+std::array<std::uint64_t, latency_histogram_t::bucket_count>
+latency_histogram_t::buckets() const {
+  std::array<std::uint64_t, bucket_count> result{};
+  for (std::size_t i = 0; i < bucket_count; ++i)
+    result[i] = m_buckets[i].load(std::memory_order_relaxed);
+  return result;
+}
+
+latency_summary_t latency_histogram_t::summary() const {
+  latency_summary_t summary;
+  auto const counts = buckets();
+  for (auto const count : counts)
+    summary.count += count;
+  if (summary.count == 0)
+    return summary;
+
+  // the buckets are read one by one while others record, so count and sum
+  // may be a few samples apart; that's fine for a summary
+  summary.mean = static_cast<std::int64_t>(
+      m_sum.load(std::memory_order_relaxed) /
+      std::max<std::uint64_t>(m_count.load(std::memory_order_relaxed), 1));
+  summary.max = m_max.load(std::memory_order_relaxed);
+
+  auto percentile = [&](std::uint64_t const numerator) {
+    auto const rank = (summary.count * numerator + 99) / 100;
+    std::uint64_t seen = 0;
+    for (std::size_t i = 0; i < bucket_count; ++i) {
+      seen += counts[i];
+      if (seen >= rank)
+        return std::min(bucket_upper_bound(i), summary.max);
+    }
+    return summary.max;
+  };
+  summary.p50 = percentile(50);
+  summary.p90 = percentile(90);
+  summary.p99 = percentile(99);
+  return summary;
+}
+
+latency_histogram_t &latency_stats_t::stage(latency_stage_e const stage) {
+  static std::array<latency_histogram_t, stage_count> histograms{};
+  return histograms[static_cast<std::size_t>(stage)];
+}
+
+void latency_stats_t::record(latency_stage_e const stage,
+                             std::int64_t const from, std::int64_t const to) {
+  if (from != 0 && to != 0)
+    latency_stats_t::stage(stage).record(to - from);
+}
+
+void latency_stats_t::record_consumed(price_timestamps_t const &timestamps) {
+  auto const now = micros_since_epoch();
+  record(latency_stage_e::publish_to_consume, timestamps.published, now);
+  record(latency_stage_e::end_to_end, timestamps.exchange, now);
+}
+
+void latency_stats_t::report_every(std::chrono::seconds const interval) {
+  using std::chrono::steady_clock;
+  static std::atomic<steady_clock::rep> lastReport =
+      steady_clock::now().time_since_epoch().count();
+
+  auto const now = steady_clock::now().time_since_epoch().count();
+  auto last = lastReport.load(std::memory_order_relaxed);
+  auto const intervalTicks =
+      std::chrono::duration_cast<steady_clock::duration>(interval).count();
+  if (now - last < intervalTicks ||
+      !lastReport.compare_exchange_strong(last, now))
+    return;
+
+  if (auto const text = report(); !text.empty())
+    spdlog::info("latency (us):\n{}", text);
+}
+
+std::string latency_stats_t::report() {
+  std::string result;
+  for (std::size_t i = 0; i < stage_count; ++i) {
+    auto const stageType = static_cast<latency_stage_e>(i);
+    auto const summary = stage(stageType).summary();
+    if (summary.count == 0)
+      continue;
+    result += fmt::format(
+        "{}: count {}, mean {}, p50 {}, p90 {}, p99 {}, max {}\n",
+        latency_stage_to_string(stageType), summary.count, summary.mean,
+        summary.p50, summary.p90, summary.p99, summary.max);
+  }
+  if (!result.empty())
+    result.pop_back();
+  return result;
+}
+} // namespace keep_my_journal
@@ -3,8 +3,10 @@
 namespace keep_my_journal::dbus::adaptor {
 dbus_progress_struct_t
 scheduled_task_to_dbus_progress(scheduled_price_task_t const &taskInfo) {
+  // D-Bus has no decimal type, the percentage crosses it as a double
   dbus_progress_struct_t arg = std::tuple(
-      taskInfo.process_assigned_id, taskInfo.percentProp->percentage,
+      taskInfo.process_assigned_id,
+      taskInfo.percentProp->percentage.to_double(),
       (int32_t)taskInfo.percentProp->direction, (uint32_t)taskInfo.tradeType,
       (uint32_t)taskInfo.exchange, (uint32_t)taskInfo.status, taskInfo.task_id,
       taskInfo.user_id, taskInfo.tokens);
@@ -43,7 +45,7 @@ dbus_progress_to_scheduled_task(dbus_progress_struct_t const &taskStruct) {
   task.process_assigned_id = taskStruct.get<0>();
   task.percentProp.emplace<scheduled_price_task_t::percentage_based_property_t>(
       {});
-  task.percentProp->percentage = taskStruct.get<1>();
+  task.percentProp->percentage = decimal_t::from_double(taskStruct.get<1>());
   task.percentProp->direction =
       static_cast<price_direction_e>(taskStruct.get<2>());
   task.tradeType = static_cast<trade_type_e>(taskStruct.get<3>());
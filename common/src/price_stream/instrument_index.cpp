@@ -0,0 +1,87 @@
+// Copyright (C) 2023-2024 Joshua and Jordan Ogunyinka
+
+#include "price_stream/instrument_index.hpp"
+
+#include <functional>
+#include <stdexcept>
+
+namespace keep_my_journal {
+std::uint64_t instrument_index_t::hash_of(trade_type_e const tradeType,
+                                          std::string_view const name) {
+  std::uint64_t hash = std::hash<std::string_view>{}(name);
+  hash ^= static_cast<std::uint64_t>(tradeType) + 1;
+  // spreads the trade type and, where size_t is 32 bits, the hash itself
+  // over the top half that the tags come from
+  return hash * 0x9E3779B97F4A7C15ULL;
+}
+
+std::size_t instrument_index_t::probe(std::uint64_t const hash,
+                                      trade_type_e const tradeType,
+                                      std::string_view const name) const {
+  auto const mask = m_buckets.size() - 1;
+  auto const tag = static_cast<std::uint32_t>(hash >> 32);
+  for (auto i = static_cast<std::size_t>(hash) & mask;; i = (i + 1) & mask) {
+    auto const &bucket = m_buckets[i];
+    if (bucket.row == empty_row ||
+        (bucket.tag == tag && trade_type(bucket.row) == tradeType &&
+         this->name(bucket.row) == name))
+      return i;
+  }
+}
+
+void instrument_index_t::grow() {
+  std::vector<bucket_t> buckets(m_buckets.empty() ? 16 : m_buckets.size() * 2);
+  auto const mask = buckets.size() - 1;
+  for (std::size_t row = 0; row < size(); ++row) {
+    auto const hash = hash_of(trade_type(row), name(row));
+    auto i = static_cast<std::size_t>(hash) & mask;
+    while (buckets[i].row != empty_row)
+      i = (i + 1) & mask;
+    buckets[i] = {static_cast<std::uint32_t>(row),
+                  static_cast<std::uint32_t>(hash >> 32)};
+  }
+  m_buckets = std::move(buckets);
+}
+
+std::size_t instrument_index_t::find(trade_type_e const tradeType,
+                                     std::string_view const name) const {
+  if (m_buckets.empty())
+    return npos;
+  auto const &bucket = m_buckets[probe(hash_of(tradeType, name), tradeType,
+                                       name)];
+  return bucket.row == empty_row ? npos : bucket.row;
+}
+
+std::size_t instrument_index_t::insert(trade_type_e const tradeType,
+                                       std::string_view const name) {
+  if ((size() + 1) * 2 > m_buckets.size())
+    grow();
+
+  auto const hash = hash_of(tradeType, name);
+  auto &bucket = m_buckets[probe(hash, tradeType, name)];
+  if (bucket.row != empty_row)
+    return bucket.row;
+
+  if (m_names.size() + name.size() >= empty_row)
+    throw std::length_error("instrument names exceed 4GB");
+  auto const row = size();
+  m_names.append(name);
+  m_nameEnds.push_back(static_cast<std::uint32_t>(m_names.size()));
+  m_tradeTypes.push_back(static_cast<std::uint8_t>(tradeType));
+  bucket = {static_cast<std::uint32_t>(row),
+            static_cast<std::uint32_t>(hash >> 32)};
+  return row;
+}
+
+std::string_view instrument_index_t::name(std::size_t const row) const {
+  auto const begin = row == 0 ? 0 : m_nameEnds[row - 1];
+  return std::string_view(m_names).substr(begin, m_nameEnds[row] - begin);
+}
+
+void instrument_index_t::clear() {
+  m_buckets.clear();
+  m_names.clear();
+  m_nameEnds.clear();
+  m_tradeTypes.clear();
+}
+} // namespace keep_my_journal
@@ -0,0 +1,341 @@
+// Copyright (C) 2023-2024 Joshua and Jordan Ogunyinka
+
+#include "price_stream/instrument_store.hpp"
+
+#include <functional>
+#include <stdexcept>
+#include <thread>
+#include <utility>
+
+#if _MSC_VER && !__INTEL_COMPILER
+#include <intrin.h>
+#endif
+
+#include "latency_histogram.hpp"
+
+namespace keep_my_journal {
+namespace {
+std::uint64_t hash_of(trade_type_e const tradeType,
+                      std::string_view const name) {
+  std::uint64_t hash = std::hash<std::string_view>{}(name);
+  hash ^= static_cast<std::uint64_t>(tradeType) + 1;
+  // spreads the trade type and, where size_t is 32 bits, the hash itself
+  // over the top half that the tags come from
+  return hash * 0x9E3779B97F4A7C15ULL;
+}
+
+std::uint64_t bucket_entry(std::uint32_t const tag, std::uint32_t const row) {
+  return (std::uint64_t{tag} << 32) | (std::uint64_t{row} + 1);
+}
+
+std::size_t highest_bit(std::uint64_t const value) {
+#if _MSC_VER && !__INTEL_COMPILER
+  unsigned long index = 0;
+  _BitScanReverse64(&index, value);
+  return index;
+#else
+  return 63 - __builtin_clzll(value);
+#endif
+}
+
+// the segment a row is in and its position there. Segment k starts at row
+// `size` * (2^k - 1), so it's the highest bit of row / `size` + 1
+std::pair<std::size_t, std::size_t> segment_of(std::size_t const row,
+                                               std::size_t const size) {
+  auto const segment = highest_bit(row / size + 1);
+  return {segment, row - size * ((std::size_t{1} << segment) - 1)};
+}
+} // namespace
+
+instrument_store_t::bucket_table_t::bucket_table_t(std::size_t const count)
+    : mask(count - 1), entries(new std::atomic<std::uint64_t>[count]) {
+  for (std::size_t i = 0; i < count; ++i)
+    entries[i].store(0, std::memory_order_relaxed);
+}
+
+instrument_store_t::instrument_store_t() : m_epoch(micros_since_epoch()) {}
+
+instrument_store_t::slot_t &
+instrument_store_t::slot_at(std::size_t const row) const {
+  auto const [segment, position] = segment_of(row, first_segment_size);
+  return m_segments[segment].load(std::memory_order_acquire)[position];
+}
+
+instrument_store_t::slot_t *
+instrument_store_t::find_slot(trade_type_e const tradeType,
+                              std::string_view const name) const {
+  auto const *table = m_buckets.load(std::memory_order_acquire);
+  if (!table)
+    return nullptr;
+
+  auto const hash = hash_of(tradeType, name);
+  auto const tag = static_cast<std::uint32_t>(hash >> 32);
+  // never more than half full, so there's always an empty bucket to stop at
+  for (auto i = static_cast<std::size_t>(hash) & table->mask;;
+       i = (i + 1) & table->mask) {
+    auto const entry = table->entries[i].load(std::memory_order_acquire);
+    if (entry == 0)
+      return nullptr;
+    if (static_cast<std::uint32_t>(entry >> 32) != tag)
+      continue;
+    auto &slot = slot_at(static_cast<std::uint32_t>(entry) - 1);
+    if (slot.tradeType == tradeType && slot.name == name)
+      return &slot;
+  }
+}
+
+void instrument_store_t::add_to_buckets(std::uint32_t const row,
+                                        std::uint64_t const hash) {
+  auto const *table = m_buckets.load(std::memory_order_relaxed);
+  if (!table || (std::size_t{row} + 1) * 2 > table->mask + 1) {
+    auto const count = table ? (table->mask + 1) * 2 : first_segment_size * 2;
+    auto &grown = m_ownedBuckets.emplace_back(
+        std::make_unique<bucket_table_t>(count));
+    // entries move over as they are, the low half of their key's hash says
+    // where
+    for (std::size_t b = 0; table && b <= table->mask; ++b) {
+      auto const entry = table->entries[b].load(std::memory_order_relaxed);
+      if (entry == 0)
+        continue;
+      auto const &slot = slot_at(static_cast<std::uint32_t>(entry) - 1);
+      auto i = static_cast<std::size_t>(hash_of(slot.tradeType, slot.name)) &
+               grown->mask;
+      while (grown->entries[i].load(std::memory_order_relaxed) != 0)
+        i = (i + 1) & grown->mask;
+      grown->entries[i].store(entry, std::memory_order_relaxed);
+    }
+    // readers still probing the old table may miss the new row, as if
+    // they'd looked just before it was added
+    m_buckets.store(grown.get(), std::memory_order_release);
+    table = grown.get();
+  }
+
+  auto i = static_cast<std::size_t>(hash) & table->mask;
+  while (table->entries[i].load(std::memory_order_relaxed) != 0)
+    i = (i + 1) & table->mask;
+  // publishes the slot's name and trade type written before it
+  table->entries[i].store(bucket_entry(static_cast<std::uint32_t>(hash >> 32),
+                                       row),
+                          std::memory_order_release);
+}
+
+instrument_store_t::slot_t *
+instrument_store_t::slot_for(instrument_type_t const &instrument) {
+  if (instrument.tradeType >= trade_type_e::total)
+    return nullptr;
+  // only writers add slots, and they hold `m_writeMutex`
+  if (auto *slot = find_slot(instrument.tradeType, instrument.name); slot)
+    return slot;
+
+  auto const row = m_size.load(std::memory_order_relaxed);
+  auto const [segment, position] = segment_of(row, first_segment_size);
+  if (segment >= segment_count)
+    throw std::length_error("too many instruments in the store");
+  if (position == 0 && !m_segments[segment].load(std::memory_order_relaxed)) {
+    auto &owned = m_ownedSegments.emplace_back(
+        std::make_unique<slot_t[]>(first_segment_size << segment));
+    m_segments[segment].store(owned.get(), std::memory_order_release);
+  }
+
+  // not seen by readers until it's in the buckets, and a throw here leaves
+  // the row to be made again by the next new instrument
+  auto &slot = slot_at(row);
+  slot.name = instrument.name;
+  slot.tradeType = instrument.tradeType;
+  if (m_historySeconds != 0)
+    slot.history = std::make_unique<tick_history_t>(m_historySeconds);
+  add_to_buckets(row, hash_of(instrument.tradeType, instrument.name));
+  m_size.store(row + 1, std::memory_order_release);
+  return &slot;
+}
+
+void instrument_store_t::write(slot_t &slot,
+                               instrument_type_t const &instrument,
+                               std::uint64_t const sequence) {
+  auto const version = slot.sequence.load(std::memory_order_relaxed);
+  slot.sequence.store(version + 1, std::memory_order_relaxed);
+  std::atomic_thread_fence(std::memory_order_release);
+
+  slot.priceMantissa.store(instrument.currentPrice.mantissa,
+                           std::memory_order_relaxed);
+  slot.priceExponent.store(instrument.currentPrice.exponent,
+                           std::memory_order_relaxed);
+  slot.open24hMantissa.store(instrument.open24h.mantissa,
+                             std::memory_order_relaxed);
+  slot.open24hExponent.store(instrument.open24h.exponent,
+                             std::memory_order_relaxed);
+  slot.exchangeTime.store(instrument.timestamps.exchange,
+                          std::memory_order_relaxed);
+  slot.receivedTime.store(instrument.timestamps.received,
+                          std::memory_order_relaxed);
+  slot.publishedTime.store(instrument.timestamps.published,
+                           std::memory_order_relaxed);
+  slot.updated.store(sequence, std::memory_order_relaxed);
+
+  slot.sequence.store(version + 2, std::memory_order_release);
+
+  if (slot.history) {
+    // this host's clock when it's known, so that every exchange's history
+    // is on the same one
+    auto const &stamps = instrument.timestamps;
+    auto const micros = stamps.received != 0   ? stamps.received
+                        : stamps.exchange != 0 ? stamps.exchange
+                                               : micros_since_epoch();
+    slot.history->append(micros, instrument.currentPrice);
+  }
+}
+
+void instrument_store_t::keep_history(std::size_t const seconds) {
+  std::lock_guard<std::mutex> lockGuard(m_writeMutex);
+  m_historySeconds = seconds;
+}
+
+bool instrument_store_t::read(slot_t const &slot, instrument_type_t &result) {
+  for (std::size_t attempt = 0;; ++attempt) {
+    auto const before = slot.sequence.load(std::memory_order_acquire);
+    if (before == 0)
+      return false;
+
+    if (before % 2 == 0) {
+      result.currentPrice.mantissa =
+          slot.priceMantissa.load(std::memory_order_relaxed);
+      result.currentPrice.exponent =
+          slot.priceExponent.load(std::memory_order_relaxed);
+      result.open24h.mantissa =
+          slot.open24hMantissa.load(std::memory_order_relaxed);
+      result.open24h.exponent =
+          slot.open24hExponent.load(std::memory_order_relaxed);
+      result.timestamps.exchange =
+          slot.exchangeTime.load(std::memory_order_relaxed);
+      result.timestamps.received =
+          slot.receivedTime.load(std::memory_order_relaxed);
+      result.timestamps.published =
+          slot.publishedTime.load(std::memory_order_relaxed);
+
+      std::atomic_thread_fence(std::memory_order_acquire);
+      if (slot.sequence.load(std::memory_order_relaxed) == before)
+        break;
+    }
+
+    // the writer holds a slot for a few stores, let it finish
+    if (attempt > 16)
+      std::this_thread::yield();
+  }
+
+  result.tradeType = slot.tradeType;
+  return true;
+}
+
+void instrument_store_t::insert(instrument_type_t const &instrument) {
+  insert_list(&instrument, &instrument + 1);
+}
+
+std::optional<instrument_type_t>
+instrument_store_t::find_item(instrument_type_t const &instrument) const {
+  if (instrument.tradeType >= trade_type_e::total)
+    return std::nullopt;
+
+  auto const *slot = find_slot(instrument.tradeType, instrument.name);
+  instrument_type_t result{};
+  if (!slot || !read(*slot, result))
+    return std::nullopt;
+  // the index only finds the very same name
+  result.name = instrument.name;
+  return result;
+}
+
+void instrument_store_t::find_all(
+    trade_type_e const tradeType, std::vector<std::string> const &names,
+    std::vector<instrument_type_t> &result) const {
+  result.clear();
+  if (tradeType >= trade_type_e::total)
+    return;
+
+  for (auto const &name : names) {
+    auto const *slot = find_slot(tradeType, name);
+    if (!slot)
+      continue;
+    if (read(*slot, result.emplace_back()))
+      result.back().name = name;
+    else
+      result.pop_back();
+  }
+}
+
+std::uint64_t instrument_store_t::find_all(
+    trade_type_e const tradeType, std::vector<std::string> const &names,
+    std::uint64_t const since, std::vector<instrument_type_t> &result) const {
+  result.clear();
+  // every slot written up to `current` is visible from here on
+  auto const current = sequence();
+  if (current <= since || tradeType >= trade_type_e::total)
+    return current;
+
+  for (auto const &name : names) {
+    auto const *slot = find_slot(tradeType, name);
+    if (!slot || slot->updated.load(std::memory_order_relaxed) <= since)
+      continue;
+    if (read(*slot, result.emplace_back()))
+      result.back().name = name;
+    else
+      result.pop_back();
+  }
+  return current;
+}
+
+std::vector<instrument_type_t> instrument_store_t::to_list() const {
+  std::vector<instrument_type_t> result;
+  auto const size = m_size.load(std::memory_order_acquire);
+  result.reserve(size);
+  for (std::size_t row = 0; row < size; ++row) {
+    auto const &slot = slot_at(row);
+    // read in place, a slot not written yet is the rare case
+    if (read(slot, result.emplace_back()))
+      result.back().name = slot.name;
+    else
+      result.pop_back();
+  }
+  return result;
+}
+
+std::uint64_t instrument_store_t::changed_since(
+    std::uint64_t const since, std::vector<instrument_type_t> &result) const {
+  result.clear();
+  // every slot written up to `current` is visible from here on
+  auto const current = sequence();
+  if (current <= since)
+    return current;
+
+  auto const size = m_size.load(std::memory_order_acquire);
+  for (std::size_t row = 0; row < size; ++row) {
+    auto const &slot = slot_at(row);
+    if (slot.updated.load(std::memory_order_relaxed) <= since)
+      continue;
+    if (read(slot, result.emplace_back()))
+      result.back().name = slot.name;
+    else
+      result.pop_back();
+  }
+  return current;
+}
+
+bool instrument_store_t::find_history(
+    trade_type_e const tradeType, std::string const &name,
+    std::int64_t const from, std::int64_t const to,
+    std::vector<price_tick_t> &result) const {
+  result.clear();
+  if (tradeType >= trade_type_e::total)
+    return false;
+
+  auto const *slot = find_slot(tradeType, name);
+  if (!slot || !slot->history)
+    return false;
+
+  slot->history->range(from, to, result);
+  return true;
+}
+
+bool instrument_store_t::empty() const {
+  return m_size.load(std::memory_order_acquire) == 0;
+}
+} // namespace keep_my_journal
@@ -0,0 +1,279 @@
+// Copyright (C) 2023-2024 Joshua and Jordan Ogunyinka
+
+#include "price_stream/price_binary.hpp"
+
+#include <array>
+#include <limits>
+#include <stdexcept>
+#include <string>
+#include <type_traits>
+
+namespace keep_my_journal {
+namespace {
+constexpr char magic[2] = {'C', 'P'};
+constexpr std::uint8_t kind_full = 1;
+constexpr std::uint8_t kind_delta = 2;
+// the frame's records aren't part of the stream, see `encode_record`
+constexpr std::uint8_t flag_standalone = 1;
+constexpr std::int32_t unknown_offset =
+    std::numeric_limits<std::int32_t>::min();
+
+// byte by byte so the layout doesn't depend on the host, compilers turn
+// these into plain loads and stores on little-endian machines
+template <typename T> void put(char *&out, T const value) {
+  auto bits = static_cast<std::make_unsigned_t<T>>(value);
+  for (std::size_t i = 0; i < sizeof(T); ++i) {
+    *out++ = static_cast<char>(bits & 0xFF);
+    bits = static_cast<decltype(bits)>(bits >> 8);
+  }
+}
+
+template <typename T> T get(char const *&in) {
+  using unsigned_t = std::make_unsigned_t<T>;
+  unsigned_t bits = 0;
+  for (std::size_t i = 0; i < sizeof(T); ++i)
+    bits |= static_cast<unsigned_t>(
+        static_cast<unsigned_t>(static_cast<unsigned char>(in[i])) << (8 * i));
+  in += sizeof(T);
+  return static_cast<T>(bits);
+}
+
+// how long before `published` a stamp was taken, clamped to fit
+std::int32_t offset_of(std::int64_t const published,
+                       std::int64_t const stamp) {
+  if (stamp == 0)
+    return unknown_offset;
+  auto const offset = published - stamp;
+  if (offset >= std::numeric_limits<std::int32_t>::max())
+    return std::numeric_limits<std::int32_t>::max();
+  if (offset <= unknown_offset)
+    return unknown_offset + 1;
+  return static_cast<std::int32_t>(offset);
+}
+
+std::int64_t stamp_of(std::int64_t const published, std::int32_t const offset) {
+  return offset == unknown_offset ? 0 : published - offset;
+}
+
+bool fits_delta(std::int64_t const from, std::int64_t const to) {
+  // keeps `to - from` itself from overflowing, prices are nowhere near
+  constexpr auto limit = std::int64_t(1) << 62;
+  if (from <= -limit || from >= limit || to <= -limit || to >= limit)
+    return false;
+  auto const difference = to - from;
+  return difference >= std::numeric_limits<std::int32_t>::min() &&
+         difference <= std::numeric_limits<std::int32_t>::max();
+}
+
+void write_header(msgpack::sbuffer &buffer, std::uint8_t const flags,
+                  std::size_t const count, std::int64_t const published,
+                  std::uint64_t const sequence) {
+  std::array<char, price_binary_header_size> header{};
+  char *out = header.data();
+  put<std::uint8_t>(out, magic[0]);
+  put<std::uint8_t>(out, magic[1]);
+  put<std::uint8_t>(out, price_binary_version);
+  put<std::uint8_t>(out, flags);
+  put<std::uint16_t>(out, static_cast<std::uint16_t>(count));
+  put<std::uint16_t>(out, 0);
+  put<std::int64_t>(out, published);
+  put<std::uint64_t>(out, sequence);
+  buffer.write(header.data(), header.size());
+}
+
+void write_full(msgpack::sbuffer &buffer, price_record_t const &record,
+                std::uint16_t const sequence, std::int64_t const published) {
+  std::array<char, price_binary_full_record_size> bytes{};
+  char *out = bytes.data();
+  put<std::uint8_t>(out, kind_full);
+  put<std::int8_t>(out, static_cast<std::int8_t>(record.currentPrice.exponent));
+  put<std::int8_t>(out, static_cast<std::int8_t>(record.open24h.exponent));
+  put<std::uint8_t>(out, 0);
+  put<std::uint32_t>(out, record.id);
+  put<std::uint16_t>(out, sequence);
+  put<std::uint16_t>(out, 0);
+  put<std::int64_t>(out, record.currentPrice.mantissa);
+  put<std::int64_t>(out, record.open24h.mantissa);
+  put<std::int32_t>(out, offset_of(published, record.timestamps.received));
+  put<std::int32_t>(out, offset_of(published, record.timestamps.exchange));
+  buffer.write(bytes.data(), bytes.size());
+}
+
+bool exponent_fits(std::int32_t const exponent) {
+  return exponent >= std::numeric_limits<std::int8_t>::min() &&
+         exponent <= std::numeric_limits<std::int8_t>::max();
+}
+} // namespace
+
+bool is_binary_price_frame(std::string_view const message) {
+  return message.size() >= price_binary_header_size &&
+         message[0] == magic[0] && message[1] == magic[1];
+}
+
+price_binary_encoder_t::price_binary_encoder_t(std::uint16_t const fullEvery)
+    : m_fullEvery(fullEvery == 0 ? 1 : fullEvery) {}
+
+void price_binary_encoder_t::reset() {
+  for (auto &symbol : m_symbols)
+    symbol.isKnown = false;
+}
+
+void price_binary_encoder_t::encode_batch(msgpack::sbuffer &buffer,
+                                          price_record_t const *const first,
+                                          std::size_t const count) {
+  if (count > price_binary_max_records)
+    throw std::length_error("too many records for one binary price frame");
+  // decimals parsed off the wire never get here, but leaving one out would
+  // break the run of sequences, so the frame isn't sent at all
+  for (std::size_t i = 0; i < count; ++i) {
+    if (!exponent_fits(first[i].currentPrice.exponent) ||
+        !exponent_fits(first[i].open24h.exponent))
+      throw std::range_error("price exponent out of the binary range");
+  }
+
+  auto const published = count == 0 ? 0 : first->timestamps.published;
+  write_header(buffer, 0, count, published, count == 0 ? 0 : first->sequence);
+
+  for (std::size_t i = 0; i < count; ++i) {
+    auto const &record = first[i];
+    if (record.id >= m_symbols.size())
+      m_symbols.resize(record.id + 1);
+
+    auto &symbol = m_symbols[record.id];
+    auto const sequence = static_cast<std::uint16_t>(symbol.sequence + 1);
+    bool const asDelta =
+        symbol.isKnown && symbol.sinceFull < m_fullEvery &&
+        symbol.currentPrice.exponent == record.currentPrice.exponent &&
+        symbol.open24h.exponent == record.open24h.exponent &&
+        fits_delta(symbol.currentPrice.mantissa,
+                   record.currentPrice.mantissa) &&
+        fits_delta(symbol.open24h.mantissa, record.open24h.mantissa);
+
+    if (asDelta) {
+      std::array<char, price_binary_delta_record_size> bytes{};
+      char *out = bytes.data();
+      put<std::uint8_t>(out, kind_delta);
+      put<std::uint8_t>(out, 0);
+      put<std::uint16_t>(out, sequence);
+      put<std::uint32_t>(out, record.id);
+      put<std::int32_t>(out, static_cast<std::int32_t>(
+                                 record.currentPrice.mantissa -
+                                 symbol.currentPrice.mantissa));
+      put<std::int32_t>(out, static_cast<std::int32_t>(
+                                 record.open24h.mantissa -
+                                 symbol.open24h.mantissa));
+      put<std::int32_t>(out, offset_of(published, record.timestamps.received));
+      put<std::int32_t>(out, offset_of(published, record.timestamps.exchange));
+      buffer.write(bytes.data(), bytes.size());
+      ++symbol.sinceFull;
+    } else {
+      write_full(buffer, record, sequence, published);
+      symbol.sinceFull = 1;
+    }
+
+    symbol.currentPrice = record.currentPrice;
+    symbol.open24h = record.open24h;
+    symbol.sequence = sequence;
+    symbol.isKnown = true;
+  }
+}
+
+bool price_binary_encoder_t::encode_record(msgpack::sbuffer &buffer,
+                                           price_record_t const &record) {
+  if (!exponent_fits(record.currentPrice.exponent) ||
+      !exponent_fits(record.open24h.exponent))
+    return false;
+
+  auto const published = record.timestamps.published;
+  write_header(buffer, flag_standalone, 1, published, record.sequence);
+  write_full(buffer, record, 0, published);
+  return true;
+}
+
+void price_binary_decoder_t::decode(std::string_view const message,
+                                    std::vector<price_record_t> &result) {
+  if (!is_binary_price_frame(message))
+    throw std::runtime_error("not a binary price frame");
+
+  char const *in = message.data() + sizeof(magic);
+  auto const version = get<std::uint8_t>(in);
+  if (version != price_binary_version)
+    throw std::runtime_error("unsupported binary price frame version " +
+                             std::to_string(version));
+
+  auto const flags = get<std::uint8_t>(in);
+  auto const count = get<std::uint16_t>(in);
+  in += sizeof(std::uint16_t);
+  auto const published = get<std::int64_t>(in);
+  auto const firstSequence = get<std::uint64_t>(in);
+  bool const isStandalone = (flags & flag_standalone) != 0;
+  char const *const end = message.data() + message.size();
+
+  result.reserve(result.size() + count);
+  for (std::uint16_t i = 0; i < count; ++i) {
+    if (in == end)
+      throw std::runtime_error("truncated binary price frame");
+
+    auto const kind = static_cast<std::uint8_t>(*in);
+    auto const size = kind == kind_full    ? price_binary_full_record_size
+                      : kind == kind_delta ? price_binary_delta_record_size
+                                           : 0;
+    if (size == 0)
+      throw std::runtime_error("unknown binary price record kind");
+    if (static_cast<std::size_t>(end - in) < size)
+      throw std::runtime_error("truncated binary price frame");
+
+    price_record_t record{};
+    std::uint16_t sequence = 0;
+    ++in;
+    if (kind == kind_full) {
+      record.currentPrice.exponent = get<std::int8_t>(in);
+      record.open24h.exponent = get<std::int8_t>(in);
+      in += sizeof(std::uint8_t);
+      record.id = get<std::uint32_t>(in);
+      if (record.id >= max_instrument_ids)
+        throw std::runtime_error("binary price record id out of range");
+      sequence = get<std::uint16_t>(in);
+      in += sizeof(std::uint16_t);
+      record.currentPrice.mantissa = get<std::int64_t>(in);
+      record.open24h.mantissa = get<std::int64_t>(in);
+    } else {
+      in += sizeof(std::uint8_t);
+      sequence = get<std::uint16_t>(in);
+      record.id = get<std::uint32_t>(in);
+      if (record.id >= max_instrument_ids)
+        throw std::runtime_error("binary price record id out of range");
+      auto const priceChange = get<std::int32_t>(in);
+      auto const openChange = get<std::int32_t>(in);
+
+      auto const *base =
+          record.id < m_symbols.size() ? &m_symbols[record.id] : nullptr;
+      if (isStandalone || !base || !base->isKnown ||
+          static_cast<std::uint16_t>(base->sequence + 1) != sequence) {
+        in += 2 * sizeof(std::int32_t);
+        ++m_droppedDeltas;
+        continue;
+      }
+      record.currentPrice = base->currentPrice;
+      record.currentPrice.mantissa += priceChange;
+      record.open24h = base->open24h;
+      record.open24h.mantissa += openChange;
+    }
+    record.timestamps.published = published;
+    record.timestamps.received = stamp_of(published, get<std::int32_t>(in));
+    record.timestamps.exchange = stamp_of(published, get<std::int32_t>(in));
+    record.sequence = firstSequence == 0 ? 0 : firstSequence + i;
+
+    if (!isStandalone) {
+      if (record.id >= m_symbols.size())
+        m_symbols.resize(record.id + 1);
+      auto &symbol = m_symbols[record.id];
+      symbol.currentPrice = record.currentPrice;
+      symbol.open24h = record.open24h;
+      symbol.sequence = sequence;
+      symbol.isKnown = true;
+    }
+    result.push_back(record);
+  }
+}
+} // namespace keep_my_journal
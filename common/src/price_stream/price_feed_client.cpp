@@ -0,0 +1,273 @@
+// Copyright (C) 2023-2024 Joshua and Jordan Ogunyinka
+
+#include "price_stream/price_feed_client.hpp"
+
+#include <spdlog/spdlog.h>
+
+#include "allocation_counter.hpp"
+#include "file_utils.hpp"
+#include "latency_histogram.hpp"
+#include "macro_defines.hpp"
+#include "price_stream/price_subscriptions.hpp"
+#include "price_stream/price_wire.hpp"
+#include "price_stream/symbol_registry.hpp"
+#include "string_utils.hpp"
+
+namespace keep_my_journal {
+namespace {
+// how long a poll waits, which is also how late a subscription change made
+// on a quiet feed can be
+constexpr auto poll_interval = std::chrono::milliseconds(100);
+// messages taken off one socket before the next gets its turn
+constexpr std::size_t max_messages_per_turn = 64;
+// how long a snapshot is waited for before it's asked for again, on a new
+// socket as a REQ socket can't send twice without a reply
+constexpr auto snapshot_timeout = std::chrono::seconds(5);
+} // namespace
+
+struct price_feed_client_t::feed_t {
+  exchange_e const exchange;
+  std::string const name;
+  zmq::socket_t socket;
+  symbol_registry_t &symbols;
+  price_message_decoder_t decoder{};
+  allocation_stats_t allocationStats;
+  std::vector<price_subscription_change_t> subscriptionChanges{};
+  zmq::message_t topic{};
+  zmq::message_t message{};
+
+  // only the whole feed is loaded from a snapshot, a symbol subscribed to
+  // on its own is sent its latest price on its topic, see price_wire.hpp
+  zmq::socket_t snapshotSocket;
+  msgpack::sbuffer snapshotRequest{};
+  bool wantsSnapshot = false;
+  bool isAwaitingSnapshot = false;
+  // the subscription has taken, so a snapshot leaves no gap before the
+  // stream: the mappings are resent to every new subscriber
+  bool isLive = false;
+  std::chrono::steady_clock::time_point snapshotRequestedAt{};
+
+  feed_t(zmq::context_t &context, exchange_e const ex,
+         std::string const &clientName)
+      : exchange(ex), name(utils::exchangesToString(ex)),
+        socket(context, zmq::socket_type::sub),
+        symbols(symbol_registry_t::get(ex)),
+        allocationStats(fmt::format("{} {} prices", clientName, name)),
+        snapshotSocket(context, zmq::socket_type::req) {}
+
+  std::string snapshot_address() const {
+    return fmt::format("ipc://{}/{}{}", PRICE_MONITOR_STREAM_DEPOSIT_PATH,
+                       name, price_snapshot_suffix);
+  }
+};
+
+price_feed_client_t::price_feed_client_t(zmq::context_t &context,
+                                         instrument_exchange_set_t &store,
+                                         price_feed_options_t options)
+    : m_context(context), m_store(store), m_options(std::move(options)) {}
+
+price_feed_client_t::~price_feed_client_t() = default;
+
+void price_feed_client_t::on_update(update_callback_t callback) {
+  m_onUpdate = std::move(callback);
+}
+
+bool price_feed_client_t::connect() {
+  if (!utils::validate_address_paradigm(PRICE_MONITOR_STREAM_DEPOSIT_PATH))
+    return false;
+
+  for (auto const exchange :
+       {exchange_e::binance, exchange_e::kucoin, exchange_e::okex}) {
+    auto feed = std::make_unique<feed_t>(m_context, exchange, m_options.name);
+    auto const address = fmt::format(
+        "ipc://{}/{}", PRICE_MONITOR_STREAM_DEPOSIT_PATH, feed->name);
+
+    feed->socket.set(zmq::sockopt::subscribe, price_topic_mappings);
+    // otherwise the symbols are subscribed to as tasks start watching them
+    if (m_options.wholeFeed) {
+      feed->socket.set(zmq::sockopt::subscribe,
+                       price_topic_in(m_options.format, price_topic_all));
+      feed->wantsSnapshot = true;
+    }
+
+    try {
+      feed->socket.connect(address);
+      feed->snapshotSocket.set(zmq::sockopt::linger, 0);
+      feed->snapshotSocket.connect(feed->snapshot_address());
+    } catch (zmq::error_t const &e) {
+      spdlog::error("Error connecting to {}: {}", address, e.what());
+      continue;
+    }
+    m_feeds.push_back(std::move(feed));
+  }
+  return !m_feeds.empty();
+}
+
+void price_feed_client_t::run(bool &isRunning) {
+  if (!connect())
+    return;
+
+  // each feed's stream socket, then its snapshot socket
+  std::vector<zmq::pollitem_t> items;
+  items.reserve(2 * m_feeds.size());
+
+  while (isRunning) {
+    items.clear();
+    for (auto &feed : m_feeds) {
+      if (!m_options.wholeFeed)
+        apply_subscription_changes(*feed);
+      request_snapshot(*feed);
+      // a timed out request replaced the socket
+      items.push_back({feed->socket.handle(), 0, ZMQ_POLLIN, 0});
+      items.push_back({feed->snapshotSocket.handle(), 0, ZMQ_POLLIN, 0});
+    }
+
+    try {
+      // polling out lets the changes above be picked up on a quiet feed
+      if (zmq::poll(items, poll_interval) <= 0)
+        continue;
+    } catch (zmq::error_t const &e) {
+      spdlog::error("Unable to poll the price feeds: {}", e.what());
+      continue;
+    }
+
+    for (std::size_t i = 0; i < m_feeds.size(); ++i) {
+      if (items[2 * i].revents & ZMQ_POLLIN)
+        drain(*m_feeds[i]);
+      if (items[2 * i + 1].revents & ZMQ_POLLIN)
+        receive_snapshot(*m_feeds[i]);
+    }
+  }
+
+  for (auto &feed : m_feeds) {
+    spdlog::info("Closing socket for {}", feed->name);
+    feed->snapshotSocket.close();
+    feed->socket.close();
+  }
+  m_feeds.clear();
+}
+
+void price_feed_client_t::apply_subscription_changes(feed_t &feed) {
+  // (un)subscribe to the symbols tasks have started or stopped watching
+  feed.subscriptionChanges.clear();
+  price_subscriptions_t::instance().take_changes(feed.exchange,
+                                                 feed.subscriptionChanges);
+  for (auto const &change : feed.subscriptionChanges) {
+    auto const topic = price_topic_in(m_options.format, change.topic);
+    // price_monitor answers the subscription with the symbol's latest
+    // price, which can't be missed as it's sent once the subscription is
+    // live; a snapshot asked for now could be taken before then
+    if (change.subscribe) {
+      feed.socket.set(zmq::sockopt::subscribe, topic);
+    } else {
+      feed.socket.set(zmq::sockopt::unsubscribe, topic);
+    }
+  }
+}
+
+void price_feed_client_t::request_snapshot(feed_t &feed) {
+  if (feed.isAwaitingSnapshot) {
+    if (std::chrono::steady_clock::now() - feed.snapshotRequestedAt <
+        snapshot_timeout)
+      return;
+
+    spdlog::warn("No snapshot of {} prices yet, asking again", feed.name);
+    feed.snapshotSocket.close();
+    feed.snapshotSocket = zmq::socket_t(m_context, zmq::socket_type::req);
+    try {
+      feed.snapshotSocket.set(zmq::sockopt::linger, 0);
+      feed.snapshotSocket.connect(feed.snapshot_address());
+    } catch (zmq::error_t const &e) {
+      spdlog::error("Error connecting to {}: {}", feed.snapshot_address(),
+                    e.what());
+    }
+    ask_again(feed);
+  }
+  if (!feed.wantsSnapshot || !feed.isLive)
+    return;
+
+  feed.snapshotRequest.clear();
+  // no topics is every symbol
+  msgpack::packer<msgpack::sbuffer>(feed.snapshotRequest).pack_array(0);
+  zmq::message_t request(feed.snapshotRequest.data(),
+                         feed.snapshotRequest.size());
+  if (!feed.snapshotSocket.send(request, zmq::send_flags::dontwait)) {
+    spdlog::error("Unable to ask for a snapshot of {} prices", feed.name);
+    return;
+  }
+  feed.wantsSnapshot = false;
+  feed.isAwaitingSnapshot = true;
+  feed.snapshotRequestedAt = std::chrono::steady_clock::now();
+}
+
+void price_feed_client_t::ask_again(feed_t &feed) {
+  feed.isAwaitingSnapshot = false;
+  feed.wantsSnapshot = true;
+}
+
+void price_feed_client_t::receive_snapshot(feed_t &feed) {
+  if (!feed.snapshotSocket.recv(feed.message, zmq::recv_flags::dontwait))
+    return;
+  feed.isAwaitingSnapshot = false;
+
+  try {
+    if (feed.decoder.decode(feed.message.to_string_view(), feed.symbols) !=
+        price_message_type_e::price_snapshot) {
+      spdlog::error("Expected a snapshot of {} prices", feed.name);
+      ask_again(feed);
+      return;
+    }
+  } catch (std::exception const &e) {
+    spdlog::error(e.what());
+    ask_again(feed);
+    return;
+  }
+
+  spdlog::info("{}: {} {} prices from a snapshot at {}", m_options.name,
+               feed.decoder.size(), feed.name,
+               feed.decoder.snapshot_sequence());
+  if (feed.decoder.size() != 0) {
+    m_store[feed.exchange].insert_list(feed.decoder.begin(),
+                                       feed.decoder.end());
+    if (m_onUpdate)
+      m_onUpdate(feed.exchange, feed.decoder.begin(), feed.decoder.end());
+  }
+}
+
+void price_feed_client_t::drain(feed_t &feed) {
+  auto &instruments = m_store[feed.exchange];
+
+  for (std::size_t i = 0; i < max_messages_per_turn; ++i) {
+    if (!feed.socket.recv(feed.topic, zmq::recv_flags::dontwait).has_value())
+      return;
+
+    // every publication is a topic frame followed by the message, which
+    // arrive together
+    if (!feed.topic.more() ||
+        !feed.socket.recv(feed.message, zmq::recv_flags::none).has_value()) {
+      spdlog::error("There was an error receiving this message...");
+      continue;
+    }
+    feed.isLive = true;
+
+    try {
+      feed.decoder.decode(feed.message.to_string_view(), feed.symbols);
+    } catch (std::exception const &e) {
+      spdlog::error(e.what());
+      continue;
+    }
+
+    if (feed.decoder.size() != 0) {
+      // a batch frame decodes into many instruments, store them all under
+      // one lock
+      for (auto const &instrument : feed.decoder)
+        latency_stats_t::record_consumed(instrument.timestamps);
+      instruments.insert_list(feed.decoder.begin(), feed.decoder.end());
+      if (m_onUpdate)
+        m_onUpdate(feed.exchange, feed.decoder.begin(), feed.decoder.end());
+    }
+    latency_stats_t::report_every(std::chrono::seconds(30));
+    feed.allocationStats.messages_done();
+  }
+}
+} // namespace keep_my_journal
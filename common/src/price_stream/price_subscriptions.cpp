@@ -0,0 +1,58 @@
+// Copyright (C) 2023-2024 Joshua and Jordan Ogunyinka
+
+#include "price_stream/price_subscriptions.hpp"
+#include "price_stream/price_wire.hpp"
+
+namespace keep_my_journal {
+price_subscriptions_t &price_subscriptions_t::instance() {
+  static price_subscriptions_t subscriptions{};
+  return subscriptions;
+}
+
+void price_subscriptions_t::watch(exchange_e const exchange,
+                                  trade_type_e const tradeType,
+                                  std::vector<std::string> const &symbols) {
+  if (exchange == exchange_e::total)
+    return;
+
+  auto const index = static_cast<std::size_t>(exchange);
+  std::lock_guard<std::mutex> lock_g{m_mutex};
+  for (auto const &symbol : symbols) {
+    auto topic = price_topic(exchange, tradeType, symbol);
+    if (++m_counts[index][topic] == 1)
+      m_changes[index].push_back({std::move(topic), true});
+  }
+}
+
+void price_subscriptions_t::unwatch(exchange_e const exchange,
+                                    trade_type_e const tradeType,
+                                    std::vector<std::string> const &symbols) {
+  if (exchange == exchange_e::total)
+    return;
+
+  auto const index = static_cast<std::size_t>(exchange);
+  std::lock_guard<std::mutex> lock_g{m_mutex};
+  auto &counts = m_counts[index];
+  for (auto const &symbol : symbols) {
+    auto iter = counts.find(price_topic(exchange, tradeType, symbol));
+    if (iter == counts.end() || --iter->second != 0)
+      continue;
+
+    m_changes[index].push_back({iter->first, false});
+    counts.erase(iter);
+  }
+}
+
+void price_subscriptions_t::take_changes(
+    exchange_e const exchange,
+    std::vector<price_subscription_change_t> &result) {
+  if (exchange == exchange_e::total)
+    return;
+
+  std::lock_guard<std::mutex> lock_g{m_mutex};
+  auto &changes = m_changes[static_cast<std::size_t>(exchange)];
+  result.insert(result.end(), std::make_move_iterator(changes.begin()),
+                std::make_move_iterator(changes.end()));
+  changes.clear();
+}
+} // namespace keep_my_journal
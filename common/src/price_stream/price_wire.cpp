@@ -0,0 +1,140 @@
+// Copyright (C) 2023-2024 Joshua and Jordan Ogunyinka
+
+#include "price_stream/price_wire.hpp"
+#include "price_stream/symbol_registry.hpp"
+#include "string_utils.hpp"
+
+namespace keep_my_journal {
+std::string price_topic(exchange_e const exchange,
+                        trade_type_e const tradeType,
+                        std::string_view const symbol) {
+  auto topic = std::string(price_topic_prefix);
+  topic += utils::exchangesToString(exchange);
+  topic += '/';
+  topic += utils::tradeTypeToString(tradeType);
+  topic += '/';
+  topic += symbol;
+  // so that "BTC" doesn't also match "BTCUSDT"
+  topic += '/';
+  return topic;
+}
+
+std::string price_topic_in(price_wire_format_e const format,
+                           std::string_view const topic) {
+  if (format == price_wire_format_e::binary)
+    return std::string(price_topic_binary_prefix).append(topic);
+  return std::string(topic);
+}
+
+void pack_symbol_mappings(msgpack::sbuffer &buffer,
+                          std::vector<symbol_mapping_t> const &mappings) {
+  msgpack::pack(buffer, price_message_type_e::symbol_mapping);
+  msgpack::pack(buffer, mappings);
+}
+
+void pack_price_record(msgpack::sbuffer &buffer, price_record_t const &record) {
+  msgpack::pack(buffer, price_message_type_e::price_record);
+  msgpack::pack(buffer, record);
+}
+
+void pack_price_batch(msgpack::sbuffer &buffer, price_record_t const *first,
+                      std::size_t const count) {
+  msgpack::pack(buffer, price_message_type_e::price_batch);
+  msgpack::packer<msgpack::sbuffer> packer(buffer);
+  packer.pack_array(static_cast<std::uint32_t>(count));
+  for (std::size_t i = 0; i < count; ++i)
+    packer.pack(first[i]);
+}
+
+void pack_price_snapshot(msgpack::sbuffer &buffer,
+                         price_snapshot_t const &snapshot) {
+  msgpack::pack(buffer, price_message_type_e::price_snapshot);
+  msgpack::pack(buffer, snapshot);
+}
+
+// prices for ids we've not seen a mapping for yet are dropped, the mapping
+// is (re)sent whenever a subscriber joins. So are those a snapshot already
+// had something newer of, and the odd repeat.
+void price_message_decoder_t::resolve(price_record_t const &record,
+                                      symbol_registry_t const &registry) {
+  auto const *symbol = registry.find_symbol(record.id);
+  if (!symbol)
+    return;
+
+  if (record.sequence != 0) {
+    if (record.id >= m_appliedSequences.size())
+      m_appliedSequences.resize(record.id + 1);
+    auto &applied = m_appliedSequences[record.id];
+    if (record.sequence <= applied)
+      return;
+    applied = record.sequence;
+  }
+
+  if (m_size == m_instruments.size())
+    m_instruments.emplace_back();
+  // assigning the name reuses the capacity it had for an earlier message
+  auto &instrument = m_instruments[m_size++];
+  instrument.name = symbol->name;
+  instrument.tradeType = symbol->tradeType;
+  instrument.currentPrice = record.currentPrice;
+  instrument.open24h = record.open24h;
+  instrument.timestamps = record.timestamps;
+}
+
+price_message_type_e
+price_message_decoder_t::decode(std::string_view const message,
+                                symbol_registry_t &registry) {
+  m_size = 0;
+  if (is_binary_price_frame(message)) {
+    m_records.clear();
+    m_binary.decode(message, m_records);
+    for (auto const &record : m_records)
+      resolve(record, registry);
+    return m_records.size() == 1 ? price_message_type_e::price_record
+                                 : price_message_type_e::price_batch;
+  }
+
+  m_reader.clear();
+  std::size_t offset = 0;
+  auto const type =
+      m_reader.next(message, offset).as<price_message_type_e>();
+  auto const payload = m_reader.next(message, offset);
+
+  switch (type) {
+  case price_message_type_e::symbol_mapping: {
+    payload.convert(m_mappings);
+    for (auto const &mapping : m_mappings)
+      registry.assign(mapping);
+    break;
+  }
+  case price_message_type_e::price_record: {
+    payload.convert(m_record);
+    resolve(m_record, registry);
+    break;
+  }
+  case price_message_type_e::price_batch: {
+    // convert straight out of the unpacked array, one record at a time,
+    // rather than into an intermediate vector
+    if (payload.type != msgpack::type::ARRAY)
+      throw msgpack::type_error();
+
+    for (std::uint32_t i = 0; i < payload.via.array.size; ++i) {
+      payload.via.array.ptr[i].convert(m_record);
+      resolve(m_record, registry);
+    }
+    break;
+  }
+  case price_message_type_e::price_snapshot: {
+    payload.convert(m_snapshot);
+    for (auto const &mapping : m_snapshot.mappings)
+      registry.assign(mapping);
+    for (auto const &record : m_snapshot.records)
+      resolve(record, registry);
+    break;
+  }
+  default:
+    return price_message_type_e::unknown;
+  }
+  return type;
+}
+} // namespace keep_my_journal
@@ -0,0 +1,428 @@
+// Copyright (C) 2023-2024 Joshua and Jordan Ogunyinka
+
+#include "price_stream/shared_price_table.hpp"
+
+#include <atomic>
+#include <cstring>
+#include <fcntl.h>
+#include <spdlog/spdlog.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <thread>
+#include <unistd.h>
+
+#include "string_utils.hpp"
+
+namespace keep_my_journal {
+namespace details {
+// bump `table_version` whenever either layout changes
+constexpr std::uint32_t table_magic = 0x434C5054; // "CLPT"
+constexpr std::uint32_t table_version = 2;
+
+struct alignas(64) shared_table_header_t {
+  std::uint32_t magic;
+  std::uint32_t version;
+  std::uint32_t capacity;
+  std::uint32_t slotSize;
+  // a power of two over twice the capacity, so probes stay short
+  std::uint32_t bucketCount;
+  // slots [0, symbolCount) have their names written
+  std::atomic<std::uint32_t> symbolCount;
+  std::atomic<std::uint32_t> isClosed;
+};
+
+// two whole cache lines, so neighbouring slots never share one. The name
+// and trade type are written once, before `symbolCount` covers the slot;
+// everything else is only touched under `sequence`, which is odd while a
+// write is in progress and 0 until the first one.
+struct alignas(64) shared_price_slot_t {
+  std::atomic<std::uint32_t> sequence;
+  std::uint8_t tradeType;
+  std::uint8_t nameLength;
+  char name[shared_price_table_t::max_name_length + 1];
+  std::atomic<std::int32_t> priceExponent;
+  std::atomic<std::int32_t> open24hExponent;
+  std::atomic<std::int64_t> priceMantissa;
+  std::atomic<std::int64_t> open24hMantissa;
+  std::atomic<std::int64_t> exchangeTime;
+  std::atomic<std::int64_t> receivedTime;
+  std::atomic<std::int64_t> publishedTime;
+};
+
+static_assert(std::atomic<std::uint32_t>::is_always_lock_free &&
+                  std::atomic<std::int64_t>::is_always_lock_free,
+              "the table is shared between processes, its atomics mustn't "
+              "need a lock");
+} // namespace details
+
+using details::shared_price_slot_t;
+using details::shared_table_header_t;
+
+namespace {
+using bucket_t = std::atomic<std::uint32_t>;
+
+std::size_t bucket_count(std::size_t const capacity) {
+  std::size_t count = 2;
+  while (count < 2 * capacity)
+    count *= 2;
+  return count;
+}
+
+std::size_t table_size(std::size_t const capacity,
+                       std::size_t const bucketCount) {
+  return sizeof(shared_table_header_t) +
+         capacity * sizeof(shared_price_slot_t) +
+         bucketCount * sizeof(bucket_t);
+}
+
+// FNV-1a rather than std::hash, the writer and the readers are different
+// programs and must agree on it
+std::uint64_t hash_of(trade_type_e const tradeType,
+                      std::string_view const name) {
+  std::uint64_t hash = 0xCBF29CE484222325ULL;
+  for (auto const c : name) {
+    hash ^= static_cast<unsigned char>(c);
+    hash *= 0x100000001B3ULL;
+  }
+  hash ^= static_cast<std::uint64_t>(tradeType) + 1;
+  // the bucket is taken from the top half, which this spreads over
+  return (hash * 0x9E3779B97F4A7C15ULL) >> 32;
+}
+
+// a crashed or restarted writer may have left its table behind, anyone
+// still reading it is told it's closed before it goes
+void close_leftover_table(std::string const &name) {
+  int const fd = ::shm_open(name.c_str(), O_RDWR, 0);
+  if (fd == -1)
+    return;
+
+  struct stat status {};
+  if (::fstat(fd, &status) == 0 &&
+      static_cast<std::size_t>(status.st_size) >=
+          sizeof(shared_table_header_t)) {
+    void *address = ::mmap(nullptr, sizeof(shared_table_header_t),
+                           PROT_READ | PROT_WRITE, MAP_SHARED, fd, 0);
+    if (address != MAP_FAILED) {
+      static_cast<shared_table_header_t *>(address)->isClosed.store(
+          1, std::memory_order_release);
+      ::munmap(address, sizeof(shared_table_header_t));
+    }
+  }
+  ::close(fd);
+  ::shm_unlink(name.c_str());
+}
+} // namespace
+
+shared_price_table_t::shared_price_table_t(exchange_e const exchange,
+                                           bool const isWriter)
+    : m_exchange(exchange), m_isWriter(isWriter) {}
+
+shared_price_table_t::~shared_price_table_t() {
+  if (!m_address)
+    return;
+
+  if (m_isWriter) {
+    m_header->isClosed.store(1, std::memory_order_release);
+    ::shm_unlink(object_name(m_exchange).c_str());
+  }
+  ::munmap(m_address, m_mappedSize);
+}
+
+std::string shared_price_table_t::object_name(exchange_e const exchange) {
+  return "/cryptolog_prices_" + utils::exchangesToString(exchange);
+}
+
+bool shared_price_table_t::map(int const fd, std::size_t const size) {
+  int const protection = m_isWriter ? PROT_READ | PROT_WRITE : PROT_READ;
+  void *address = ::mmap(nullptr, size, protection, MAP_SHARED, fd, 0);
+  ::close(fd);
+  if (address == MAP_FAILED)
+    return false;
+
+  m_address = address;
+  m_mappedSize = size;
+  m_header = static_cast<shared_table_header_t *>(address);
+  m_slots = reinterpret_cast<shared_price_slot_t *>(
+      static_cast<char *>(address) + sizeof(shared_table_header_t));
+  return true;
+}
+
+std::unique_ptr<shared_price_table_t>
+shared_price_table_t::create(exchange_e const exchange,
+                             std::size_t const capacity) {
+  auto const name = object_name(exchange);
+  close_leftover_table(name);
+
+  int const fd = ::shm_open(name.c_str(), O_RDWR | O_CREAT | O_EXCL, 0644);
+  if (fd == -1) {
+    spdlog::error("Unable to create {}: {}", name, std::strerror(errno));
+    return nullptr;
+  }
+
+  auto const bucketCount = bucket_count(capacity);
+  auto const size = table_size(capacity, bucketCount);
+  if (::ftruncate(fd, static_cast<off_t>(size)) != 0) {
+    spdlog::error("Unable to size {}: {}", name, std::strerror(errno));
+    ::close(fd);
+    ::shm_unlink(name.c_str());
+    return nullptr;
+  }
+
+  std::unique_ptr<shared_price_table_t> table(
+      new shared_price_table_t(exchange, true));
+  if (!table->map(fd, size)) {
+    spdlog::error("Unable to map {}: {}", name, std::strerror(errno));
+    ::shm_unlink(name.c_str());
+    return nullptr;
+  }
+
+  // ftruncate zero-fills, every bucket starts empty and only the header
+  // needs setting, its magic last
+  auto *header = table->m_header;
+  header->version = details::table_version;
+  header->capacity = static_cast<std::uint32_t>(capacity);
+  header->slotSize = sizeof(shared_price_slot_t);
+  header->bucketCount = static_cast<std::uint32_t>(bucketCount);
+  std::atomic_thread_fence(std::memory_order_release);
+  header->magic = details::table_magic;
+  spdlog::info("Sharing the latest prices in /dev/shm{} ({} slots)", name,
+               capacity);
+  return table;
+}
+
+std::unique_ptr<shared_price_table_t>
+shared_price_table_t::open(exchange_e const exchange) {
+  auto const name = object_name(exchange);
+  int const fd = ::shm_open(name.c_str(), O_RDONLY, 0);
+  if (fd == -1)
+    return nullptr;
+
+  struct stat status {};
+  if (::fstat(fd, &status) != 0 || static_cast<std::size_t>(status.st_size) <
+                                       sizeof(shared_table_header_t)) {
+    ::close(fd);
+    return nullptr;
+  }
+
+  std::unique_ptr<shared_price_table_t> table(
+      new shared_price_table_t(exchange, false));
+  if (!table->map(fd, static_cast<std::size_t>(status.st_size)))
+    return nullptr;
+
+  // a writer sizes the object before it writes the header, so a table
+  // caught in between is treated like a missing one
+  auto const *header = table->m_header;
+  if (header->magic != details::table_magic)
+    return nullptr;
+  std::atomic_thread_fence(std::memory_order_acquire);
+  if (header->version != details::table_version ||
+      header->slotSize != sizeof(shared_price_slot_t) ||
+      header->bucketCount <= header->capacity ||
+      (header->bucketCount & (header->bucketCount - 1)) != 0 ||
+      table_size(header->capacity, header->bucketCount) >
+          table->m_mappedSize) {
+    return nullptr;
+  }
+  return table;
+}
+
+std::atomic<std::uint32_t> *shared_price_table_t::buckets() const {
+  return reinterpret_cast<bucket_t *>(m_slots + m_header->capacity);
+}
+
+bool shared_price_table_t::add_symbol(symbol_mapping_t const &mapping) {
+  // ids are dense and added in order, so `symbolCount` only ever covers
+  // named slots
+  auto const count = m_header->symbolCount.load(std::memory_order_relaxed);
+  if (!m_isWriter || mapping.id != count || mapping.id >= m_header->capacity)
+    return false;
+
+  auto &slot = m_slots[mapping.id];
+  slot.tradeType = static_cast<std::uint8_t>(mapping.tradeType);
+  // a name that doesn't fit is left out, readers can't look the slot up
+  slot.nameLength = mapping.name.size() <= max_name_length
+                        ? static_cast<std::uint8_t>(mapping.name.size())
+                        : 0;
+  std::memcpy(slot.name, mapping.name.data(), slot.nameLength);
+  if (slot.nameLength != 0) {
+    // there are always empty buckets, at most half of them are taken
+    auto *bucket = buckets();
+    auto const mask = m_header->bucketCount - 1;
+    auto i = hash_of(mapping.tradeType, mapping.name) & mask;
+    while (bucket[i].load(std::memory_order_relaxed) != 0)
+      i = (i + 1) & mask;
+    // publishes the name written above along with it
+    bucket[i].store(mapping.id + 1, std::memory_order_release);
+  }
+  m_header->symbolCount.store(count + 1, std::memory_order_release);
+  return slot.nameLength != 0;
+}
+
+void shared_price_table_t::write(price_record_t const &record) {
+  if (!m_isWriter || record.id >= m_header->capacity)
+    return;
+
+  auto &slot = m_slots[record.id];
+  auto const sequence = slot.sequence.load(std::memory_order_relaxed);
+  slot.sequence.store(sequence + 1, std::memory_order_relaxed);
+  std::atomic_thread_fence(std::memory_order_release);
+
+  slot.priceMantissa.store(record.currentPrice.mantissa,
+                           std::memory_order_relaxed);
+  slot.priceExponent.store(record.currentPrice.exponent,
+                           std::memory_order_relaxed);
+  slot.open24hMantissa.store(record.open24h.mantissa,
+                             std::memory_order_relaxed);
+  slot.open24hExponent.store(record.open24h.exponent,
+                             std::memory_order_relaxed);
+  slot.exchangeTime.store(record.timestamps.exchange,
+                          std::memory_order_relaxed);
+  slot.receivedTime.store(record.timestamps.received,
+                          std::memory_order_relaxed);
+  slot.publishedTime.store(record.timestamps.published,
+                           std::memory_order_relaxed);
+
+  slot.sequence.store(sequence + 2, std::memory_order_release);
+}
+
+bool shared_price_table_t::is_closed() const {
+  return m_header->isClosed.load(std::memory_order_acquire) != 0;
+}
+
+std::size_t shared_price_table_t::capacity() const {
+  return m_header->capacity;
+}
+
+std::size_t shared_price_table_t::size() const {
+  return std::min<std::size_t>(
+      m_header->symbolCount.load(std::memory_order_acquire),
+      m_header->capacity);
+}
+
+bool shared_price_table_t::read_slot(instrument_id_t const id,
+                                     instrument_type_t &result) const {
+  auto const &slot = m_slots[id];
+  for (std::size_t attempt = 0;; ++attempt) {
+    auto const before = slot.sequence.load(std::memory_order_acquire);
+    if (before == 0)
+      return false;
+
+    if (before % 2 == 0) {
+      result.currentPrice.mantissa =
+          slot.priceMantissa.load(std::memory_order_relaxed);
+      result.currentPrice.exponent =
+          slot.priceExponent.load(std::memory_order_relaxed);
+      result.open24h.mantissa =
+          slot.open24hMantissa.load(std::memory_order_relaxed);
+      result.open24h.exponent =
+          slot.open24hExponent.load(std::memory_order_relaxed);
+      result.timestamps.exchange =
+          slot.exchangeTime.load(std::memory_order_relaxed);
+      result.timestamps.received =
+          slot.receivedTime.load(std::memory_order_relaxed);
+      result.timestamps.published =
+          slot.publishedTime.load(std::memory_order_relaxed);
+
+      std::atomic_thread_fence(std::memory_order_acquire);
+      if (slot.sequence.load(std::memory_order_relaxed) == before)
+        break;
+    }
+
+    // the writer holds a slot for a few stores, let it finish
+    if (attempt > 16)
+      std::this_thread::yield();
+  }
+
+  result.name.assign(slot.name, slot.nameLength);
+  result.tradeType = static_cast<trade_type_e>(slot.tradeType);
+  return true;
+}
+
+std::size_t shared_price_table_t::find_slot(trade_type_e const tradeType,
+                                            std::string_view const name) const {
+  auto const capacity = m_header->capacity;
+  if (tradeType >= trade_type_e::total || name.empty() ||
+      name.size() > max_name_length)
+    return capacity;
+
+  auto const *bucket = buckets();
+  auto const mask = m_header->bucketCount - 1;
+  auto i = hash_of(tradeType, name) & mask;
+  // bounded in case the table isn't one a writer of ours made
+  for (std::size_t probes = 0; probes <= mask; ++probes, i = (i + 1) & mask) {
+    auto const entry = bucket[i].load(std::memory_order_acquire);
+    if (entry == 0 || entry > capacity)
+      break;
+
+    auto const &slot = m_slots[entry - 1];
+    if (slot.tradeType == static_cast<std::uint8_t>(tradeType) &&
+        std::string_view(slot.name, slot.nameLength) == name)
+      return entry - 1;
+  }
+  return capacity;
+}
+
+std::optional<instrument_type_t>
+shared_price_table_t::find(trade_type_e const tradeType,
+                           std::string_view const name) const {
+  auto const id = find_slot(tradeType, name);
+  instrument_type_t instrument;
+  if (id == capacity() ||
+      !read_slot(static_cast<instrument_id_t>(id), instrument))
+    return std::nullopt;
+  return instrument;
+}
+
+void shared_price_table_t::find_all(
+    trade_type_e const tradeType, std::vector<std::string> const &names,
+    std::vector<instrument_type_t> &result) const {
+  result.clear();
+  for (auto const &name : names) {
+    auto const id = find_slot(tradeType, name);
+    if (id != capacity() &&
+        !read_slot(static_cast<instrument_id_t>(id), result.emplace_back()))
+      result.pop_back();
+  }
+}
+
+std::vector<instrument_type_t> shared_price_table_t::to_list() const {
+  std::vector<instrument_type_t> result;
+  auto const count = size();
+  result.reserve(count);
+
+  instrument_type_t instrument;
+  for (std::size_t id = 0; id < count; ++id) {
+    if (m_slots[id].nameLength != 0 &&
+        read_slot(static_cast<instrument_id_t>(id), instrument))
+      result.push_back(instrument);
+  }
+  return result;
+}
+
+shared_price_tables_t &shared_price_tables_t::instance() {
+  static shared_price_tables_t tables{};
+  return tables;
+}
+
+shared_price_tables_t::table_ptr_t
+shared_price_tables_t::get(exchange_e const exchange) {
+  if (exchange >= exchange_e::total)
+    return nullptr;
+
+  auto &current = m_tables[static_cast<std::size_t>(exchange)];
+  if (auto const table = current.load(std::memory_order_acquire);
+      table && !table->is_closed())
+    return table;
+
+  std::lock_guard<std::mutex> lock_g{m_mutex};
+  auto table = current.load(std::memory_order_relaxed);
+  if (!table || table->is_closed()) {
+    if (auto opened = shared_price_table_t::open(exchange); opened) {
+      table = opened.get();
+      m_opened.push_back(std::move(opened));
+      current.store(table, std::memory_order_release);
+    }
+  }
+  return table;
+}
+} // namespace keep_my_journal
@@ -0,0 +1,107 @@
+// Copyright (C) 2023-2024 Joshua and Jordan Ogunyinka
+
+#include "price_stream/symbol_registry.hpp"
+
+#include <mutex>
+#include <stdexcept>
+
+namespace keep_my_journal {
+symbol_registry_t &symbol_registry_t::get(exchange_e const exchange) {
+  static std::array<symbol_registry_t,
+                    static_cast<std::size_t>(exchange_e::total)>
+      registries{};
+  return registries[static_cast<std::size_t>(exchange)];
+}
+
+instrument_id_t symbol_registry_t::intern(trade_type_e const tradeType,
+                                          std::string_view const name) {
+  auto const typeIndex = static_cast<std::size_t>(tradeType);
+  if (typeIndex >= trade_type_count)
+    throw std::out_of_range("invalid trade type");
+
+  {
+    std::shared_lock<std::shared_mutex> readLock{m_mutex};
+    auto const &ids = m_ids[typeIndex];
+    if (auto iter = ids.find(name); iter != ids.end())
+      return iter->second;
+  }
+
+  std::unique_lock<std::shared_mutex> writeLock{m_mutex};
+  auto &ids = m_ids[typeIndex];
+  if (auto iter = ids.find(name); iter != ids.end())
+    return iter->second;
+
+  auto const id = static_cast<instrument_id_t>(m_symbols.size());
+  auto &symbol = m_storage.emplace_back(
+      symbol_mapping_t{id, tradeType, std::string(name)});
+  m_symbols.push_back(&symbol);
+  ids.emplace(symbol.name, id);
+  return id;
+}
+
+std::optional<instrument_id_t>
+symbol_registry_t::find_id(trade_type_e const tradeType,
+                           std::string_view const name) const {
+  auto const typeIndex = static_cast<std::size_t>(tradeType);
+  if (typeIndex >= trade_type_count)
+    return std::nullopt;
+
+  std::shared_lock<std::shared_mutex> readLock{m_mutex};
+  auto const &ids = m_ids[typeIndex];
+  if (auto iter = ids.find(name); iter != ids.end())
+    return iter->second;
+  return std::nullopt;
+}
+
+symbol_mapping_t const *
+symbol_registry_t::find_symbol(instrument_id_t const id) const {
+  std::shared_lock<std::shared_mutex> readLock{m_mutex};
+  return id < m_symbols.size() ? m_symbols[id] : nullptr;
+}
+
+void symbol_registry_t::assign(symbol_mapping_t const &mapping) {
+  auto const typeIndex = static_cast<std::size_t>(mapping.tradeType);
+  // the id sizes the table, so a malformed one mustn't
+  if (typeIndex >= trade_type_count || mapping.id >= max_instrument_ids)
+    return;
+
+  std::unique_lock<std::shared_mutex> writeLock{m_mutex};
+  if (mapping.id >= m_symbols.size())
+    m_symbols.resize(mapping.id + 1, nullptr);
+
+  if (auto const *existing = m_symbols[mapping.id]; existing) {
+    if (existing->tradeType == mapping.tradeType &&
+        existing->name == mapping.name)
+      return;
+    // price_monitor restarted and handed this id to another symbol
+    auto &ids = m_ids[static_cast<std::size_t>(existing->tradeType)];
+    if (auto iter = ids.find(existing->name);
+        iter != ids.end() && iter->second == mapping.id)
+      ids.erase(iter);
+  }
+
+  auto &symbol = m_storage.emplace_back(mapping);
+  m_symbols[mapping.id] = &symbol;
+  m_ids[typeIndex].insert_or_assign(symbol.name, mapping.id);
+}
+
+std::vector<symbol_mapping_t>
+symbol_registry_t::symbols_from(instrument_id_t const firstId) const {
+  std::vector<symbol_mapping_t> result;
+  std::shared_lock<std::shared_mutex> readLock{m_mutex};
+  if (firstId >= m_symbols.size())
+    return result;
+
+  result.reserve(m_symbols.size() - firstId);
+  for (std::size_t id = firstId; id < m_symbols.size(); ++id) {
+    if (m_symbols[id])
+      result.push_back(*m_symbols[id]);
+  }
+  return result;
+}
+
+std::size_t symbol_registry_t::size() const {
+  std::shared_lock<std::shared_mutex> readLock{m_mutex};
+  return m_symbols.size();
+}
+} // namespace keep_my_journal
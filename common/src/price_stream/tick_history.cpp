@@ -0,0 +1,113 @@
+// Copyright (C) 2023-2024 Joshua and Jordan Ogunyinka
+
+#include "price_stream/tick_history.hpp"
+
+#include <limits>
+
+namespace keep_my_journal {
+tick_history_t::tick_history_t(std::size_t const capacity)
+    : m_capacity(capacity == 0 ? 1 : capacity) {}
+
+std::size_t tick_history_t::position(std::size_t const i) const {
+  auto const index = m_head + i;
+  return index < m_seconds.size() ? index : index - m_seconds.size();
+}
+
+std::int64_t tick_history_t::second_at(std::size_t const i) const {
+  return m_firstSecond + m_seconds[position(i)];
+}
+
+void tick_history_t::append(std::int64_t const micros,
+                            decimal_t const &price) {
+  if (price.exponent < std::numeric_limits<std::int8_t>::min() ||
+      price.exponent > std::numeric_limits<std::int8_t>::max())
+    return;
+
+  auto const second = micros / 1'000'000;
+  std::unique_lock<std::mutex> lock(m_mutex, std::try_to_lock);
+  if (!lock.owns_lock())
+    return keep_aside(second, price);
+
+  for (auto const &tick : m_pending)
+    add(tick.time, tick.price);
+  m_pending.clear();
+  add(second, price);
+}
+
+void tick_history_t::keep_aside(std::int64_t const second,
+                                decimal_t const &price) {
+  // the same rule as `add`, a tick no later than the last one updates it
+  if (!m_pending.empty() && second <= m_pending.back().time) {
+    m_pending.back().price = price;
+    return;
+  }
+  if (m_pending.size() == max_pending)
+    m_pending.back() = {second, price};
+  else
+    m_pending.push_back({second, price});
+}
+
+void tick_history_t::add(std::int64_t const second, decimal_t const &price) {
+  if (m_seconds.empty())
+    m_firstSecond = second;
+
+  auto const count = m_seconds.size();
+  if (count != 0) {
+    auto const last = position(count - 1);
+    // a tick stamped before the last point, out of order or from a clock
+    // that stepped back, still updates the latest price
+    if (second <= m_firstSecond + m_seconds[last]) {
+      m_mantissas[last] = price.mantissa;
+      m_exponents[last] = static_cast<std::int8_t>(price.exponent);
+      return;
+    }
+  }
+
+  // offsets are good for 136 years, a history never lives that long
+  auto const offset = static_cast<std::uint32_t>(second - m_firstSecond);
+  if (count < m_capacity) {
+    m_seconds.push_back(offset);
+    m_mantissas.push_back(price.mantissa);
+    m_exponents.push_back(static_cast<std::int8_t>(price.exponent));
+    return;
+  }
+
+  // full: the newest point takes the oldest's place
+  m_seconds[m_head] = offset;
+  m_mantissas[m_head] = price.mantissa;
+  m_exponents[m_head] = static_cast<std::int8_t>(price.exponent);
+  m_head = m_head + 1 == count ? 0 : m_head + 1;
+}
+
+void tick_history_t::range(std::int64_t const from, std::int64_t const to,
+                           std::vector<price_tick_t> &result) const {
+  result.clear();
+  std::lock_guard<std::mutex> lockGuard(m_mutex);
+  auto const count = m_seconds.size();
+
+  // the first point at or after `from`, the points are in time order
+  std::size_t low = 0;
+  std::size_t high = count;
+  while (low < high) {
+    auto const middle = low + (high - low) / 2;
+    if (second_at(middle) < from)
+      low = middle + 1;
+    else
+      high = middle;
+  }
+
+  for (auto i = low; i < count; ++i) {
+    auto const index = position(i);
+    auto const second = m_firstSecond + m_seconds[index];
+    if (second > to)
+      break;
+    result.push_back(
+        {second, decimal_t(m_mantissas[index], m_exponents[index])});
+  }
+}
+
+std::size_t tick_history_t::size() const {
+  std::lock_guard<std::mutex> lockGuard(m_mutex);
+  return m_seconds.size();
+}
+} // namespace keep_my_journal
@@ -0,0 +1,85 @@
+// Copyright (C) 2023-2024 Joshua and Jordan Ogunyinka
+
+#include "reconnect_policy.hpp"
+
+#include <algorithm>
+#include <random>
+#include <spdlog/spdlog.h>
+
+namespace keep_my_journal {
+namespace {
+double random_jitter_factor(double const jitter) {
+  static thread_local std::mt19937 gen{std::random_device{}()};
+  std::uniform_real_distribution<double> distribution(-jitter, jitter);
+  return 1.0 + distribution(gen);
+}
+} // namespace
+
+reconnect_policy_t::reconnect_policy_t(net::io_context &ioContext,
+                                       std::string name,
+                                       reconnect_config_t config)
+    : m_timer(ioContext), m_name(std::move(name)), m_config(config) {}
+
+std::chrono::milliseconds reconnect_policy_t::next_delay() {
+  using std::chrono::milliseconds;
+
+  if (m_failedAttempts == 0) {
+    m_lastDelay = m_config.initialDelay;
+  } else {
+    auto const grown = milliseconds(static_cast<milliseconds::rep>(
+        static_cast<double>(m_lastDelay.count()) * m_config.multiplier));
+    m_lastDelay = std::min(grown, m_config.maxDelay);
+  }
+
+  auto delay = milliseconds(static_cast<milliseconds::rep>(
+      static_cast<double>(m_lastDelay.count()) *
+      random_jitter_factor(m_config.jitter)));
+
+  // past the attempt budget, wait for the oldest attempt to leave the window
+  auto const now = std::chrono::steady_clock::now();
+  while (!m_recentAttempts.empty() &&
+         now - m_recentAttempts.front() >= m_config.attemptWindow)
+    m_recentAttempts.pop_front();
+
+  if (m_config.maxAttempts != 0 &&
+      m_recentAttempts.size() >= m_config.maxAttempts) {
+    auto const windowEnd = m_recentAttempts.front() + m_config.attemptWindow;
+    delay = std::max(delay, std::chrono::duration_cast<milliseconds>(
+                                windowEnd - now));
+  }
+  return delay;
+}
+
+void reconnect_policy_t::schedule(std::function<void()> reconnect) {
+  auto const delay = next_delay();
+  ++m_failedAttempts;
+  m_recentAttempts.push_back(std::chrono::steady_clock::now() + delay);
+
+  spdlog::warn("{}: reconnecting in {}ms (attempt {})", m_name, delay.count(),
+               m_failedAttempts);
+
+  // cancels whatever reconnect was still pending
+  m_timer.expires_after(delay);
+  m_timer.async_wait([reconnect = std::move(reconnect)](
+                         boost::system::error_code const ec) {
+    if (!ec)
+      reconnect();
+  });
+}
+
+void reconnect_policy_t::on_connected() {
+  if (m_failedAttempts == 0)
+    return;
+
+  spdlog::info("{}: reconnected after {} attempt(s)", m_name,
+               m_failedAttempts);
+  m_failedAttempts = 0;
+  if (m_resyncHandler)
+    m_resyncHandler();
+}
+
+void reconnect_policy_t::cancel() {
+  m_timer.cancel();
+  m_failedAttempts = 0;
+}
+} // namespace keep_my_journal
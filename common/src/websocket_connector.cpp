@@ -0,0 +1,153 @@
+// Copyright (C) 2023-2024 Joshua and Jordan Ogunyinka
+
+#include "websocket_connector.hpp"
+
+#include <spdlog/spdlog.h>
+
+namespace keep_my_journal {
+tls_session_cache_t &tls_session_cache_t::instance() {
+  static tls_session_cache_t cache{};
+  return cache;
+}
+
+void tls_session_cache_t::install(net::ssl::context &context) {
+  auto *const handle = context.native_handle();
+  // internal caching is for servers, the client side keeps its own by host
+  SSL_CTX_set_session_cache_mode(handle, SSL_SESS_CACHE_CLIENT |
+                                             SSL_SESS_CACHE_NO_INTERNAL_STORE);
+  SSL_CTX_sess_set_new_cb(handle, &tls_session_cache_t::on_new_session);
+}
+
+// OpenSSL calls this whenever a server issues a session (under TLS 1.3 that
+// can be well after the handshake); returning 0 leaves its reference alone
+int tls_session_cache_t::on_new_session(SSL *ssl, SSL_SESSION *session) {
+  char const *const host = SSL_get_servername(ssl, TLSEXT_NAMETYPE_host_name);
+  if (!host || !SSL_SESSION_is_resumable(session))
+    return 0;
+
+  auto const length = i2d_SSL_SESSION(session, nullptr);
+  if (length <= 0)
+    return 0;
+  std::string serialised(static_cast<std::size_t>(length), '\0');
+  auto *out = reinterpret_cast<unsigned char *>(serialised.data());
+  i2d_SSL_SESSION(session, &out);
+
+  auto &cache = instance();
+  std::lock_guard<std::mutex> lock_g{cache.m_mutex};
+  cache.m_sessions.insert_or_assign(host, std::move(serialised));
+  return 0;
+}
+
+void tls_session_cache_t::prepare(SSL *ssl, std::string const &host) {
+  SSL_SESSION *session = nullptr;
+  {
+    std::lock_guard<std::mutex> lock_g{m_mutex};
+    auto iter = m_sessions.find(host);
+    if (iter == m_sessions.end())
+      return;
+    auto const *in =
+        reinterpret_cast<unsigned char const *>(iter->second.data());
+    session = d2i_SSL_SESSION(nullptr, &in, (long)iter->second.size());
+  }
+
+  if (session) {
+    SSL_set_session(ssl, session); // takes its own reference
+    SSL_SESSION_free(session);
+  }
+}
+
+void tls_session_cache_t::record_handshake(bool const resumed) {
+  ++(resumed ? m_resumed : m_fullHandshakes);
+}
+
+// ==================================================================
+
+void websocket_connector_t::connect(ssl_websocket_stream_t &stream,
+                                    websocket_endpoint_t endpoint,
+                                    handler_t handler) {
+  std::make_shared<websocket_connector_t>(stream, std::move(endpoint),
+                                          std::move(handler))
+      ->resolve();
+}
+
+websocket_connector_t::websocket_connector_t(ssl_websocket_stream_t &stream,
+                                             websocket_endpoint_t endpoint,
+                                             handler_t handler)
+    : m_stream(stream), m_endpoint(std::move(endpoint)),
+      m_handler(std::move(handler)),
+      m_startTime(std::chrono::steady_clock::now()) {}
+
+void websocket_connector_t::resolve() {
+  dns_cache_t::instance().async_resolve(
+      m_stream.get_executor(), m_endpoint.host, m_endpoint.service,
+      [self = shared_from_this()](beast::error_code const &ec,
+                                  results_type const &results) {
+        if (ec)
+          return self->complete(ec);
+        self->connect_to_resolved_names(results);
+      });
+}
+
+void websocket_connector_t::connect_to_resolved_names(
+    results_type const &resolvedNames) {
+  beast::get_lowest_layer(m_stream).expires_after(std::chrono::seconds(30));
+  beast::get_lowest_layer(m_stream).async_connect(
+      resolvedNames,
+      [self = shared_from_this()](beast::error_code const ec,
+                                  results_type::endpoint_type const &) {
+        if (ec) {
+          // the cached addresses may well be why
+          dns_cache_t::instance().invalidate(self->m_endpoint.host,
+                                             self->m_endpoint.service);
+          return self->complete(ec);
+        }
+        self->perform_ssl_handshake();
+      });
+}
+
+void websocket_connector_t::perform_ssl_handshake() {
+  auto *const ssl = m_stream.next_layer().native_handle();
+  // Set SNI Hostname (many hosts need this to handshake successfully), it's
+  // also what the session cache files the new session under
+  if (!SSL_set_tlsext_host_name(ssl, m_endpoint.host.c_str())) {
+    return complete(beast::error_code(static_cast<int>(::ERR_get_error()),
+                                      net::error::get_ssl_category()));
+  }
+  tls_session_cache_t::instance().prepare(ssl, m_endpoint.host);
+
+  beast::get_lowest_layer(m_stream).expires_after(std::chrono::seconds(30));
+  m_stream.next_layer().async_handshake(
+      net::ssl::stream_base::client,
+      [self = shared_from_this()](beast::error_code const ec) {
+        if (ec)
+          return self->complete(ec);
+
+        auto *const ssl = self->m_stream.next_layer().native_handle();
+        tls_session_cache_t::instance().record_handshake(
+            SSL_session_reused(ssl) == 1);
+        beast::get_lowest_layer(self->m_stream).expires_never();
+        self->perform_websocket_handshake();
+      });
+}
+
+void websocket_connector_t::perform_websocket_handshake() {
+  m_stream.async_handshake(
+      m_endpoint.host, m_endpoint.path,
+      [self = shared_from_this()](beast::error_code const ec) {
+        self->complete(ec);
+      });
+}
+
+void websocket_connector_t::complete(beast::error_code const &ec) {
+  if (!ec) {
+    auto const elapsed = std::chrono::duration_cast<std::chrono::milliseconds>(
+        std::chrono::steady_clock::now() - m_startTime);
+    auto const reused =
+        SSL_session_reused(m_stream.next_layer().native_handle()) == 1;
+    spdlog::info("{}: websocket connected in {}ms ({})", m_endpoint.host,
+                 elapsed.count(),
+                 reused ? "TLS session resumed" : "full TLS handshake");
+  }
+  m_handler(ec);
+}
+} // namespace keep_my_journal
@@ -10,5 +10,11 @@ struct command_line_interface_t {
   std::string ip_address{"127.0.0.1"};
   std::string launch_type{"development"};
   std::string database_config_filename{"scripts/database.json"};
+  // read prices from price_monitor's /dev/shm tables, not its zmq stream
+  bool shared_prices{false};
+  // subscribe to price_monitor's binary price format, not msgpack
+  bool binary_prices{false};
+  // seconds of one-second prices kept per symbol, 0 for none
+  std::size_t tick_history_seconds{0};
 };
 } // namespace keep_my_journal
@@ -79,6 +79,7 @@ private:
   void get_trading_pairs_handler(url_query_t const &optional_query);
   void add_new_pricing_tasks(url_query_t const &);
   void latest_price_handler(url_query_t const &);
+  void price_history_handler(url_query_t const &);
   void new_telegram_registration_code_callback(url_query_t const &);
   void send_telegram_text(const keep_my_journal::url_query_t &query);
   void new_telegram_registration_password_callback(url_query_t const &);
@@ -86,6 +87,7 @@ private:
   void get_prices_task_status(url_query_t const &);
   void stop_prices_task(url_query_t const &);
   void get_all_running_price_tasks(url_query_t const &);
+  void get_latency_histograms(url_query_t const &);
   bool is_json_request() const;
 
 public:
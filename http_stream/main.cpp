@@ -6,12 +6,14 @@
 
 #include "file_utils.hpp"
 #include "price_stream/commodity.hpp"
+#include "price_stream/instrument_store.hpp"
+#include "price_stream/price_feed_client.hpp"
+#include "price_stream/shared_price_table.hpp"
 #include "server.hpp"
 
 namespace net = boost::asio;
 
 namespace keep_my_journal {
-void monitor_tokens_latest_prices(bool &isRunning);
 void account_stream_scheduled_task_writer(bool &isRunning);
 } // namespace keep_my_journal
 
@@ -26,7 +28,19 @@ int main(int argc, char *argv[]) {
 
   cli_parser.add_option("-p", args.port, "port to bind server to");
   cli_parser.add_option("-a", args.ip_address, "IP address to use");
+  cli_parser.add_flag("--shared-prices", args.shared_prices,
+                      "read the latest prices from price_monitor's shared "
+                      "tables instead of subscribing to them");
+  cli_parser.add_flag("--binary-prices", args.binary_prices,
+                      "subscribe to price_monitor's binary price format "
+                      "rather than msgpack");
+  cli_parser.add_option("--tick-history", args.tick_history_seconds,
+                        "seconds of one-second prices kept per symbol for "
+                        "/price_history, 0 for none");
   CLI11_PARSE(cli_parser, argc, argv)
+  if (args.shared_prices)
+    keep_my_journal::shared_price_tables_t::instance().enable();
+  uniqueInstruments.keep_history(args.tick_history_seconds);
 
   auto &ioContext = keep_my_journal::get_io_context();
   boost::asio::ssl::context sslContext(
@@ -38,11 +52,21 @@ int main(int argc, char *argv[]) {
 
   {
     // connect to the price watching process and get the latest prices from the
-    // price_stream
-    std::thread{[&isRunning] {
-      // defined in latest_prices_watcher.cpp
-      keep_my_journal::monitor_tokens_latest_prices(isRunning);
-    }}.detach();
+    // price_stream, unless they're read straight from its shared tables
+    if (!args.shared_prices) {
+      keep_my_journal::price_feed_options_t options{};
+      options.name = "http_stream";
+      options.format = args.binary_prices
+                           ? keep_my_journal::price_wire_format_e::binary
+                           : keep_my_journal::price_wire_format_e::msgpack;
+      std::thread{[&isRunning, options] {
+        // every exchange's feed, on this one thread
+        zmq::context_t context{1};
+        keep_my_journal::price_feed_client_t client(context, uniqueInstruments,
+                                                    options);
+        client.run(isRunning);
+      }}.detach();
+    }
 
     // launch sockets that writes monitoring data to wire
     std::thread{[&isRunning] {
@@ -39,9 +39,9 @@ bool passed_valid_task_check(scheduled_price_task_t &task) {
     return false;
 
   if (task.percentProp) {
-    double const percentage =
-        std::clamp(task.percentProp->percentage, -100.0, 100.0);
-    if (percentage == 0.0)
+    auto const percentage = std::clamp(
+        task.percentProp->percentage, decimal_t(-100), decimal_t(100));
+    if (percentage.is_zero())
       return false;
     task.percentProp->percentage = percentage;
   }
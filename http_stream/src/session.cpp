@@ -7,12 +7,19 @@
 #include <boost/beast/http/write.hpp>
 #include <spdlog/spdlog.h>
 
+#include <charconv>
+#include <limits>
+#include <string_view>
+
 #include <account_stream/user_scheduled_task.hpp>
 #include <price_stream/commodity.hpp>
+#include <price_stream/instrument_store.hpp>
+#include <price_stream/shared_price_table.hpp>
 
 #include "crypto_utils.hpp"
 #include "enumerations.hpp"
 #include "json_utils.hpp"
+#include "latency_histogram.hpp"
 #include "scheduled_price_tasks.hpp"
 #include "string_utils.hpp"
 
@@ -66,6 +73,16 @@ string_response_t json_success(json const &body, string_request_t const &req) {
   return response;
 }
 
+// what a client already has, the body isn't sent again
+string_response_t not_modified(std::string const &etag,
+                               string_request_t const &req) {
+  string_response_t response{http::status::not_modified, req.version()};
+  response.set(http::field::etag, etag);
+  response.keep_alive(req.keep_alive());
+  response.prepare_payload();
+  return response;
+}
+
 string_response_t success(char const *message, string_request_t const &req) {
   json::object_t result_obj;
   result_obj["status"] = error_type_e::NoError;
@@ -104,6 +121,28 @@ string_response_t allowed_options(std::vector<http::verb> const &verbs,
   return response;
 }
 
+// the whole of `text` as a decimal integer
+template <typename T>
+bool parse_integer(std::string_view const text, T &value) {
+  auto const end = text.data() + text.size();
+  auto const [last, ec] = std::from_chars(text.data(), end, value);
+  return ec == std::errc{} && last == end;
+}
+
+// a price list's ETag and `since` token, "<store epoch>-<sequence>", so a
+// token handed out before a restart isn't taken for one of this run's
+std::string list_token(std::int64_t const epoch, std::uint64_t const sequence) {
+  return fmt::format("{}-{}", epoch, sequence);
+}
+
+bool parse_list_token(std::string_view const text, std::int64_t &epoch,
+                      std::uint64_t &sequence) {
+  auto const dash = text.find('-');
+  return dash != std::string_view::npos &&
+         parse_integer(text.substr(0, dash), epoch) &&
+         parse_integer(text.substr(dash + 1), sequence);
+}
+
 url_query_t split_optional_queries(boost::string_view const &optional_query) {
   url_query_t result{};
   if (!optional_query.empty()) {
@@ -192,9 +231,14 @@ std::shared_ptr<session_t> session_t::add_endpoint_interfaces() {
   m_endpoints.add_special_endpoint("/latest_price/{exchange}/{trade}/{symbol}",
                                    ROUTE_CALLBACK(latest_price_handler),
                                    verb::get);
+  m_endpoints.add_special_endpoint(
+      "/price_history/{exchange}/{trade}/{symbol}",
+      ROUTE_CALLBACK(price_history_handler), verb::get);
   m_endpoints.add_special_endpoint("/trading_pairs/{exchange}",
                                    ROUTE_CALLBACK(get_trading_pairs_handler),
                                    verb::get);
+  m_endpoints.add_endpoint("/latency", ROUTE_CALLBACK(get_latency_histograms),
+                           verb::get);
 
   return shared_from_this();
 }
@@ -335,8 +379,47 @@ void session_t::get_trading_pairs_handler(url_query_t const &optional_query) {
   if (exchange_e::total == exchange)
     return error_handler(bad_request("invalid exchange specified", request));
 
-  auto const names = uniqueInstruments[exchange].to_list();
-  return send_response(json_success(names, request));
+  if (auto &tables = shared_price_tables_t::instance(); tables.is_enabled()) {
+    auto const table = tables.get(exchange);
+    auto const names =
+        table ? table->to_list() : std::vector<instrument_type_t>{};
+    return send_response(json_success(names, request));
+  }
+
+  // the store's sequence is the list's ETag: a client that has the latest
+  // gets a 304, with or without `since`, and one that passes an older one
+  // as `since` gets only what changed. A token from another run of the
+  // process gets the whole list instead.
+  auto &store = uniqueInstruments[exchange];
+  auto const epoch = store.epoch();
+  std::uint64_t sequence = store.sequence();
+  if (auto const etag = fmt::format("\"{}\"", list_token(epoch, sequence));
+      request[http::field::if_none_match] == etag) {
+    return send_response(not_modified(etag, request));
+  }
+
+  std::vector<instrument_type_t> names;
+  bool isWholeList = true;
+  if (auto const since_iter = optional_query.find("since");
+      since_iter != optional_query.end()) {
+    std::int64_t sinceEpoch = 0;
+    std::uint64_t since = 0;
+    if (!parse_list_token(since_iter->second, sinceEpoch, since))
+      return error_handler(bad_request("invalid `since`", request));
+    if (sinceEpoch == epoch) {
+      sequence = store.changed_since(since, names);
+      isWholeList = false;
+    }
+  }
+  if (isWholeList) {
+    sequence = store.sequence();
+    names = store.to_list();
+  }
+
+  auto response = json_success(names, request);
+  response.set(http::field::etag,
+               fmt::format("\"{}\"", list_token(epoch, sequence)));
+  return send_response(std::move(response));
 }
 
 void session_t::get_prices_task_status(url_query_t const &optional_query) {
@@ -371,17 +454,96 @@ void session_t::latest_price_handler(url_query_t const &optional_query) {
     return error_handler(bad_request("malformed query", m_thisRequest));
   }
 
-  auto &tokens = uniqueInstruments[exchange];
-  auto result = tokens.find_item(instr);
+  std::optional<instrument_type_t> result;
+  if (auto &tables = shared_price_tables_t::instance(); tables.is_enabled()) {
+    if (auto const table = tables.get(exchange); table)
+      result = table->find(instr.tradeType, instr.name);
+  } else {
+    result = uniqueInstruments[exchange].find_item(instr);
+  }
   if (result.has_value())
     return send_response(json_success(*result, m_thisRequest));
   return send_response(json_success("not found", m_thisRequest));
 }
 
+// the symbol's one-second prices kept in memory, between the optional
+// `from` and `to` queries (seconds since the epoch), as two columns
+void session_t::price_history_handler(url_query_t const &optional_query) {
+  auto const symbol_iter = optional_query.find("symbol");
+  auto const exchange_iter = optional_query.find("exchange");
+  auto const trade_iter = optional_query.find("trade");
+  if (utils::anyElementIsInvalid(optional_query, symbol_iter, exchange_iter,
+                                 trade_iter)) {
+    return error_handler(
+        bad_request("query symbol/exchange/trade missing", m_thisRequest));
+  }
+
+  auto const exchange =
+      utils::stringToExchange(utils::toLowerCopy(exchange_iter->second));
+  auto const name = utils::trimCopy(utils::toUpperCopy(symbol_iter->second));
+  auto const tradeType =
+      utils::stringToTradeType(utils::toLowerCopy(trade_iter->second));
+  if (name.empty() || exchange == exchange_e::total ||
+      tradeType == trade_type_e::total) {
+    return error_handler(bad_request("malformed query", m_thisRequest));
+  }
+
+  auto from = std::numeric_limits<std::int64_t>::min();
+  auto to = std::numeric_limits<std::int64_t>::max();
+  if (auto const iter = optional_query.find("from");
+      iter != optional_query.end() && !parse_integer(iter->second, from))
+    return error_handler(bad_request("invalid `from`", m_thisRequest));
+  if (auto const iter = optional_query.find("to");
+      iter != optional_query.end() && !parse_integer(iter->second, to))
+    return error_handler(bad_request("invalid `to`", m_thisRequest));
+
+  std::vector<price_tick_t> ticks;
+  if (!uniqueInstruments[exchange].find_history(tradeType, name, from, to,
+                                                ticks))
+    return send_response(json_success("not found", m_thisRequest));
+
+  json::array_t times;
+  json::array_t prices;
+  times.reserve(ticks.size());
+  prices.reserve(ticks.size());
+  for (auto const &tick : ticks) {
+    times.push_back(tick.time);
+    prices.push_back(tick.price);
+  }
+  json::object_t result;
+  result["time"] = std::move(times);
+  result["price"] = std::move(prices);
+  send_response(json_success(result, m_thisRequest));
+}
+
 void session_t::get_all_running_price_tasks(url_query_t const &) {
   send_response(json_success(get_price_tasks_for_all(), m_thisRequest));
 }
 
+// what this process has seen of the prices it consumes; price_monitor's own
+// stages are in its logs
+void session_t::get_latency_histograms(url_query_t const &) {
+  json::object_t result;
+  for (std::size_t i = 0; i < static_cast<std::size_t>(latency_stage_e::total);
+       ++i) {
+    auto const stage = static_cast<latency_stage_e>(i);
+    auto const &histogram = latency_stats_t::stage(stage);
+    auto const summary = histogram.summary();
+
+    json::object_t stageObject;
+    stageObject["count"] = summary.count;
+    stageObject["mean_us"] = summary.mean;
+    stageObject["p50_us"] = summary.p50;
+    stageObject["p90_us"] = summary.p90;
+    stageObject["p99_us"] = summary.p99;
+    stageObject["max_us"] = summary.max;
+    // bucket i counts samples under 2^i us (and at least 2^(i-1) us)
+    stageObject["buckets"] = histogram.buckets();
+    result[latency_stage_to_string(stage)] = std::move(stageObject);
+  }
+  send_response(json_success(result, m_thisRequest));
+}
+
 void session_t::stop_prices_task(url_query_t const &) {
   try {
     auto const jsonRoot =
@@ -604,8 +766,17 @@ void session_t::add_new_pricing_tasks(url_query_t const &) {
           return error_handler(
               bad_request("direction not specified", m_thisRequest));
         }
-        auto percentage =
-            std::abs(percentageIter->second.get<json::number_float_t>());
+        // the number is re-read from its shortest textual form, so 2.3 stays
+        // 2.3 rather than the nearest double
+        decimal_t percentage;
+        if (!parse_decimal(percentageIter->second.is_string()
+                               ? percentageIter->second.get<json::string_t>()
+                               : percentageIter->second.dump(),
+                           percentage)) {
+          return error_handler(
+              bad_request("invalid percentage specified", m_thisRequest));
+        }
+        percentage = percentage.abs();
         auto const direction =
             boost::to_lower_copy(directionIter->second.get<json::string_t>());
         new_task.percentProp->direction =
@@ -618,9 +789,9 @@ void session_t::add_new_pricing_tasks(url_query_t const &) {
         }
 
         if (new_task.percentProp->direction == price_direction_e::down)
-          percentage *= -1.0;
+          percentage = -percentage;
 
-        if (percentage == 0.0) {
+        if (percentage.is_zero()) {
           return error_handler(
               bad_request("invalid percentage specified", m_thisRequest));
         }
@@ -0,0 +1,30 @@
+// Copyright (C) 2023-2024 Joshua and Jordan Ogunyinka
+
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <string>
+
+namespace keep_my_journal {
+struct command_line_interface_t {
+  std::uint16_t port{8443};
+  std::string ip_address{"127.0.0.1"};
+  // the certificate the monitors are to trust through their --ca-file
+  std::string certificate_file{};
+  std::string private_key_file{};
+  std::size_t threads{2};
+  // instruments listed for each exchange and trade type
+  std::size_t symbol_count{200};
+  // tickers pushed per second on each price feed
+  double ticker_rate{1'000.0};
+  // tickers in each Binance `!ticker@arr` frame
+  std::size_t binance_batch{50};
+  // order updates pushed per second on each account feed
+  double order_rate{1.0};
+  // every feed is closed at once this often, 0 never
+  std::size_t disconnect_every{0};
+  // frames a slow reader may have waiting before new ones are dropped
+  std::size_t max_queued_frames{10'000};
+};
+} // namespace keep_my_journal
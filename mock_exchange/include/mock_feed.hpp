@@ -0,0 +1,127 @@
+// Copyright (C) 2023-2024 Joshua and Jordan Ogunyinka
+
+#pragma once
+
+#include <boost/asio/steady_timer.hpp>
+#include <boost/beast/core/flat_buffer.hpp>
+#include <boost/beast/core/tcp_stream.hpp>
+#include <boost/beast/http/message.hpp>
+#include <boost/beast/http/string_body.hpp>
+#include <boost/beast/ssl/ssl_stream.hpp>
+#include <boost/beast/websocket/stream.hpp>
+#include <atomic>
+#include <chrono>
+#include <deque>
+#include <memory>
+#include <mutex>
+#include <optional>
+#include <string>
+#include <string_view>
+#include <vector>
+
+#include "cli.hpp"
+#include "enumerations.hpp"
+#include "mock_market.hpp"
+
+namespace keep_my_journal {
+namespace net = boost::asio;
+namespace beast = boost::beast;
+namespace websocket = beast::websocket;
+
+using ssl_stream_t = beast::ssl_stream<beast::tcp_stream>;
+using upgrade_request_t = http::request<http::string_body>;
+
+class mock_feed_t;
+
+// every live feed, and the totals the server reports on
+class feed_registry_t {
+  std::mutex m_mutex{};
+  std::vector<std::weak_ptr<mock_feed_t>> m_feeds{};
+
+public:
+  std::atomic<std::size_t> connections = 0;
+  std::atomic<std::size_t> frames = 0;
+  std::atomic<std::size_t> bytes = 0;
+  std::atomic<std::size_t> dropped = 0;
+
+  void add(std::weak_ptr<mock_feed_t> feed);
+  // closes every feed at once, for the clients' reconnects to pile up
+  std::size_t disconnect_all();
+};
+
+// what every session and feed of the server shares
+struct mock_context_t {
+  mock_market_t const &market;
+  command_line_interface_t const &args;
+  feed_registry_t &registry;
+};
+
+enum class feed_kind_e {
+  binance_tickers,
+  binance_account,
+  okex_public,
+  okex_private,
+  kucoin_public,
+  kucoin_private,
+};
+
+struct feed_route_t {
+  feed_kind_e kind;
+  trade_type_e tradeType = trade_type_e::spot;
+  std::string connectId{};
+};
+
+// which feed a websocket upgrade to `target` on `host` asks for
+std::optional<feed_route_t> route_feed(std::string_view host,
+                                       std::string_view target);
+std::shared_ptr<mock_feed_t> make_feed(feed_route_t route,
+                                       ssl_stream_t &&stream,
+                                       mock_context_t const &context);
+
+// one websocket connection. It answers whatever the client sends through
+// `on_message` and, once `start_pushing` has been called, pushes the frames
+// `next_frame` makes at a steady rate. A reader that falls behind has new
+// frames dropped rather than queued without bound.
+class mock_feed_t : public std::enable_shared_from_this<mock_feed_t> {
+public:
+  mock_feed_t(ssl_stream_t &&stream, mock_context_t const &context);
+  virtual ~mock_feed_t();
+
+  void run(upgrade_request_t request);
+  // sends a close frame, as the exchanges do before going down
+  void disconnect();
+
+protected:
+  virtual void on_connected() {}
+  virtual void on_message(std::string_view message) = 0;
+  virtual void next_frame(std::string &frame) = 0;
+
+  // answers go out ahead of the pushed frames and are never dropped
+  void reply(std::string message);
+  // can be called again to change the rate
+  void start_pushing(double framesPerSecond);
+
+  mock_context_t const &m_context;
+
+private:
+  void read_next();
+  void write_next();
+  void schedule_tick();
+  void on_tick();
+  void stop();
+
+  websocket::stream<ssl_stream_t> m_webStream;
+  std::optional<upgrade_request_t> m_upgradeRequest{};
+  beast::flat_buffer m_readBuffer{};
+  net::steady_timer m_pushTimer;
+  std::deque<std::string> m_replies{};
+  std::deque<std::string> m_frames{};
+  std::string m_writing{};
+  std::chrono::steady_clock::time_point m_pushStart{};
+  std::chrono::steady_clock::duration m_tickInterval{};
+  double m_framesPerSecond = 0.0;
+  std::size_t m_pushed = 0;
+  bool m_isWriting = false;
+  bool m_isStopped = false;
+};
+} // namespace keep_my_journal
@@ -0,0 +1,87 @@
+// Copyright (C) 2023-2024 Joshua and Jordan Ogunyinka
+
+#pragma once
+
+#include <boost/beast/http/verb.hpp>
+#include <array>
+#include <optional>
+#include <random>
+#include <string>
+#include <string_view>
+#include <unordered_map>
+#include <utility>
+#include <vector>
+
+#include "enumerations.hpp"
+
+namespace keep_my_journal {
+namespace http = boost::beast::http;
+
+// the instruments the mock lists, named the way each exchange names them,
+// and the REST answers that are built from them. Read-only once constructed,
+// so every session shares the one instance.
+class mock_market_t {
+public:
+  using symbol_location_t = std::pair<trade_type_e, std::size_t>;
+
+  explicit mock_market_t(std::size_t symbolCount);
+
+  std::vector<std::string> const &symbols(exchange_e exchange,
+                                          trade_type_e tradeType) const;
+  // trade type of one of `exchange`'s symbols and its index in `symbols()`
+  std::optional<symbol_location_t> find(exchange_e exchange,
+                                        std::string const &name) const;
+  // the answer to `method target` on `host`, nullopt for unknown routes
+  std::optional<std::string> rest_response(std::string_view host,
+                                           http::verb method,
+                                           std::string_view target) const;
+
+  static double initial_price(std::size_t index);
+
+private:
+  std::vector<std::string> &symbols(exchange_e exchange,
+                                    trade_type_e tradeType);
+  void add_symbol(exchange_e exchange, trade_type_e tradeType,
+                  std::string name);
+
+  std::string binance_ticker_prices(trade_type_e tradeType) const;
+  std::string okex_instruments(std::string_view instType) const;
+  std::string kucoin_spot_tickers() const;
+  std::string kucoin_futures_contracts() const;
+  static std::string kucoin_bullet(std::string_view host, bool isPrivate);
+
+  static constexpr auto exchange_count =
+      static_cast<std::size_t>(exchange_e::total);
+  static constexpr auto trade_type_count =
+      static_cast<std::size_t>(trade_type_e::total);
+
+  std::array<std::vector<std::string>, exchange_count * trade_type_count>
+      m_symbols{};
+  std::array<std::unordered_map<std::string, symbol_location_t>,
+             exchange_count>
+      m_locations{};
+};
+
+// a random walk over some instruments' prices. Each feed keeps its own, so
+// feeds never have to synchronise with each other.
+class price_walk_t {
+  std::vector<double> m_prices;
+  std::mt19937 m_generator;
+  std::normal_distribution<double> m_distribution{0.0, 0.001};
+  std::size_t m_next = 0;
+
+public:
+  explicit price_walk_t(std::vector<double> initialPrices = {});
+  void add(double const initialPrice) { m_prices.push_back(initialPrice); }
+  // moves the next instrument's price, round-robin, and returns its index
+  std::size_t step();
+  bool empty() const { return m_prices.empty(); }
+  double price(std::size_t const index) const { return m_prices[index]; }
+  std::size_t size() const { return m_prices.size(); }
+};
+
+// "api.binance.com:443" => "api.binance.com"
+std::string_view strip_port(std::string_view host);
+// the value of `key` in the query part of `target`, empty if it has none
+std::string_view query_value(std::string_view target, std::string_view key);
+} // namespace keep_my_journal
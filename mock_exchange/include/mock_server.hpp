@@ -0,0 +1,40 @@
+// Copyright (C) 2023-2024 Joshua and Jordan Ogunyinka
+
+#pragma once
+
+#include <boost/asio/io_context.hpp>
+#include <boost/asio/ip/tcp.hpp>
+#include <boost/asio/ssl/context.hpp>
+#include <boost/asio/steady_timer.hpp>
+#include <memory>
+
+#include "mock_feed.hpp"
+
+namespace keep_my_journal {
+// accepts the monitors' connections on one TLS port, whatever exchange they
+// think they're talking to; sessions tell them apart by their Host header
+class mock_server_t : public std::enable_shared_from_this<mock_server_t> {
+  using tcp = net::ip::tcp;
+
+  net::io_context &m_ioContext;
+  net::ssl::context &m_sslContext;
+  mock_context_t const m_context;
+  tcp::acceptor m_acceptor;
+  net::steady_timer m_reportTimer;
+  net::steady_timer m_disconnectTimer;
+  std::size_t m_lastFrames = 0;
+  std::size_t m_lastBytes = 0;
+  std::size_t m_lastDropped = 0;
+  bool m_isOpen = false;
+
+  void accept_connections();
+  void on_connection_accepted(beast::error_code ec, tcp::socket socket);
+  void report_every(std::chrono::seconds interval);
+  void disconnect_every(std::chrono::seconds interval);
+
+public:
+  mock_server_t(net::io_context &ioContext, net::ssl::context &sslContext,
+                mock_context_t const &context);
+  bool run();
+};
+} // namespace keep_my_journal
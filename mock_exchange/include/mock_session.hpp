@@ -0,0 +1,37 @@
+// Copyright (C) 2023-2024 Joshua and Jordan Ogunyinka
+
+#pragma once
+
+#include <boost/asio/ip/tcp.hpp>
+#include <boost/asio/ssl/context.hpp>
+#include <boost/beast/http/message.hpp>
+#include <boost/beast/http/parser.hpp>
+#include <memory>
+#include <optional>
+
+#include "mock_feed.hpp"
+
+namespace keep_my_journal {
+// one TLS connection: answers REST requests until the client hangs up or
+// asks for a websocket upgrade, which it hands over to a feed
+class mock_session_t : public std::enable_shared_from_this<mock_session_t> {
+  using string_response_t = http::response<http::string_body>;
+
+  ssl_stream_t m_stream;
+  mock_context_t const &m_context;
+  beast::flat_buffer m_buffer{};
+  std::optional<http::request_parser<http::string_body>> m_parser{};
+  std::optional<string_response_t> m_response{};
+
+  void read_request();
+  void on_request_read(beast::error_code ec);
+  void upgrade(feed_route_t route, upgrade_request_t request);
+  void send_response(string_response_t &&response);
+  void shutdown();
+
+public:
+  mock_session_t(net::ip::tcp::socket &&socket, net::ssl::context &sslContext,
+                 mock_context_t const &context);
+  void run();
+};
+} // namespace keep_my_journal
@@ -0,0 +1,91 @@
+// Copyright (C) 2023-2024 Joshua and Jordan Ogunyinka
+
+// a local stand-in for Binance, OKX and KuCoin: enough of their REST and
+// websocket APIs for the price and account monitors to run against it, at
+// whatever rate and with however many instruments a load test needs. Point
+// the monitors at it with `--host-override '*=127.0.0.1:8443'` and trust its
+// certificate with `--ca-file`.
+#include <CLI/CLI11.hpp>
+#include <boost/asio/io_context.hpp>
+#include <boost/asio/signal_set.hpp>
+#include <boost/asio/ssl/context.hpp>
+#include <spdlog/spdlog.h>
+
+#include <algorithm>
+#include <cstdlib>
+#include <thread>
+#include <vector>
+
+#include "cli.hpp"
+#include "mock_market.hpp"
+#include "mock_server.hpp"
+
+namespace net = boost::asio;
+namespace ssl = net::ssl;
+
+int main(int argc, char *argv[]) {
+  CLI::App cli_parser{"a mock Binance, OKX and KuCoin for load tests"};
+  keep_my_journal::command_line_interface_t args{};
+
+  cli_parser.add_option("-p,--port", args.port, "port to bind server to");
+  cli_parser.add_option("-a,--address", args.ip_address, "IP address to use");
+  cli_parser.add_option("--cert", args.certificate_file,
+                        "PEM certificate chain the server presents")
+      ->required();
+  cli_parser.add_option("--key", args.private_key_file,
+                        "PEM private key of the certificate")
+      ->required();
+  cli_parser.add_option("--threads", args.threads, "io_context threads");
+  cli_parser.add_option("--symbols", args.symbol_count,
+                        "instruments listed per exchange and trade type");
+  cli_parser.add_option("--ticker-rate", args.ticker_rate,
+                        "tickers pushed per second on each price feed");
+  cli_parser.add_option("--binance-batch", args.binance_batch,
+                        "tickers in each Binance !ticker@arr frame");
+  cli_parser.add_option("--order-rate", args.order_rate,
+                        "order updates pushed per second on each account feed");
+  cli_parser.add_option("--disconnect-every", args.disconnect_every,
+                        "close every feed at once this many seconds apart, "
+                        "0 never");
+  cli_parser.add_option("--max-queued-frames", args.max_queued_frames,
+                        "frames a slow reader may have waiting before new "
+                        "ones are dropped");
+  CLI11_PARSE(cli_parser, argc, argv)
+
+  ssl::context sslContext(ssl::context::tlsv12_server);
+  try {
+    sslContext.use_certificate_chain_file(args.certificate_file);
+    sslContext.use_private_key_file(args.private_key_file, ssl::context::pem);
+  } catch (std::exception const &e) {
+    spdlog::error("Unable to load the certificate: {}", e.what());
+    return EXIT_FAILURE;
+  }
+
+  auto const threadCount = std::max<std::size_t>(args.threads, 1);
+  net::io_context ioContext(static_cast<int>(threadCount));
+  keep_my_journal::mock_market_t const market(args.symbol_count);
+  keep_my_journal::feed_registry_t registry{};
+  keep_my_journal::mock_context_t const context{market, args, registry};
+
+  auto server =
+      std::make_shared<keep_my_journal::mock_server_t>(ioContext, sslContext,
+                                                       context);
+  if (!server->run())
+    return EXIT_FAILURE;
+
+  net::signal_set signalSet(ioContext, SIGTERM);
+  signalSet.add(SIGINT);
+  signalSet.add(SIGABRT);
+  signalSet.async_wait([&ioContext](boost::system::error_code const &,
+                                    int const) { ioContext.stop(); });
+
+  std::vector<std::thread> threads{};
+  threads.reserve(threadCount - 1);
+  for (std::size_t i = 1; i < threadCount; ++i)
+    threads.emplace_back([&ioContext] { ioContext.run(); });
+
+  ioContext.run();
+  for (auto &thread : threads)
+    thread.join();
+  return EXIT_SUCCESS;
+}
@@ -0,0 +1,627 @@
+// Copyright (C) 2023-2024 Joshua and Jordan Ogunyinka
+
+#include "mock_feed.hpp"
+#include "json_utils.hpp"
+#include "latency_histogram.hpp"
+#include "random_utils.hpp"
+
+#include <algorithm>
+#include <boost/asio/post.hpp>
+#include <spdlog/spdlog.h>
+
+namespace keep_my_journal {
+namespace {
+char const *okex_inst_type(trade_type_e const tradeType) {
+  switch (tradeType) {
+  case trade_type_e::futures:
+    return "FUTURES";
+  case trade_type_e::swap:
+    return "SWAP";
+  default:
+    return "SPOT";
+  }
+}
+
+std::int64_t millis_now() { return micros_since_epoch() / 1'000; }
+
+char const *const illegal_request =
+    R"({"event":"error","code":"60012","msg":"Illegal request"})";
+char const *const not_logged_in =
+    R"({"event":"error","code":"60011","msg":"Please log in"})";
+
+// Binance `!ticker@arr`, many tickers per frame
+class binance_tickers_feed_t : public mock_feed_t {
+  std::vector<std::string> const &m_names;
+  price_walk_t m_walk{};
+  std::size_t const m_batchSize;
+
+public:
+  binance_tickers_feed_t(ssl_stream_t &&stream, mock_context_t const &context,
+                         trade_type_e const tradeType)
+      : mock_feed_t(std::move(stream), context),
+        m_names(context.market.symbols(exchange_e::binance, tradeType)),
+        m_batchSize(std::max<std::size_t>(context.args.binance_batch, 1)) {
+    for (std::size_t i = 0; i < m_names.size(); ++i)
+      m_walk.add(mock_market_t::initial_price(i));
+  }
+
+protected:
+  void on_connected() override {
+    if (!m_walk.empty())
+      start_pushing(m_context.args.ticker_rate /
+                    static_cast<double>(m_batchSize));
+  }
+
+  void on_message(std::string_view) override {}
+
+  void next_frame(std::string &frame) override {
+    auto const eventTime = millis_now();
+    auto out = std::back_inserter(frame);
+    frame.push_back('[');
+    for (std::size_t i = 0; i < m_batchSize; ++i) {
+      auto const index = m_walk.step();
+      auto const price = m_walk.price(index);
+      auto const open = mock_market_t::initial_price(index);
+      fmt::format_to(out,
+                     R"({}{{"e":"24hrTicker","E":{},"s":"{}","c":"{:.4f}",)"
+                     R"("o":"{:.4f}","h":"{:.4f}","l":"{:.4f}",)"
+                     R"("v":"1000.00","q":"{:.4f}"}})",
+                     i == 0 ? "" : ",", eventTime, m_names[index], price,
+                     open, std::max(price, open), std::min(price, open),
+                     price * 1'000.0);
+    }
+    frame.push_back(']');
+  }
+};
+
+// Binance user data stream, order updates only
+class binance_account_feed_t : public mock_feed_t {
+  std::vector<std::string> const &m_names;
+  std::size_t m_orderId = 1;
+
+public:
+  binance_account_feed_t(ssl_stream_t &&stream, mock_context_t const &context)
+      : mock_feed_t(std::move(stream), context),
+        m_names(context.market.symbols(exchange_e::binance,
+                                       trade_type_e::spot)) {}
+
+protected:
+  void on_connected() override {
+    if (!m_names.empty())
+      start_pushing(m_context.args.order_rate);
+  }
+
+  void on_message(std::string_view) override {}
+
+  void next_frame(std::string &frame) override {
+    auto const id = m_orderId++;
+    auto const index = id % m_names.size();
+    auto const now = millis_now();
+    fmt::format_to(
+        std::back_inserter(frame),
+        R"({{"e":"executionReport","E":{0},"s":"{1}","c":"mock{2}",)"
+        R"("S":"{3}","o":"LIMIT","f":"GTC","q":"1.00000000","p":"{4:.4f}",)"
+        R"("P":"0.00000000","F":"0.00000000","g":-1,"C":"","x":"TRADE",)"
+        R"("X":"FILLED","r":"NONE","i":{2},"l":"1.00000000",)"
+        R"("z":"1.00000000","L":"{4:.4f}","n":"0.00100000","N":"USDT",)"
+        R"("T":{0},"t":{2},"I":{2},"w":false,"m":false,"M":true,"O":{0},)"
+        R"("Z":"{4:.4f}","Y":"{4:.4f}","Q":"0.00000000"}})",
+        now, m_names[index], id, id % 2 ? "BUY" : "SELL",
+        mock_market_t::initial_price(index));
+  }
+};
+
+// OKX `/ws/v5/public`, one ticker per frame for every instrument subscribed
+class okex_public_feed_t : public mock_feed_t {
+  std::string const m_connectionId = utils::getRandomString(8);
+  std::vector<std::string> m_names{};
+  std::vector<trade_type_e> m_tradeTypes{};
+  std::vector<double> m_openPrices{};
+  price_walk_t m_walk{};
+
+public:
+  using mock_feed_t::mock_feed_t;
+
+protected:
+  void on_message(std::string_view const message) override {
+    if (message == "ping")
+      return reply("pong");
+
+    try {
+      auto const root = json::parse(message);
+      auto const op = root.at("op").get<json::string_t>();
+      if (op != "subscribe" && op != "unsubscribe")
+        return reply(illegal_request);
+
+      bool const wasPushing = !m_walk.empty();
+      for (auto const &arg : root.at("args").get<json::array_t>()) {
+        reply(fmt::format(R"({{"event":"{}","arg":{},"connId":"{}"}})", op,
+                          arg.dump(), m_connectionId));
+        if (op != "subscribe" || arg.value("channel", "") != "tickers")
+          continue;
+
+        auto const name = arg.value("instId", "");
+        if (auto const location = m_context.market.find(exchange_e::okex, name);
+            location) {
+          auto const open = mock_market_t::initial_price(location->second);
+          m_names.push_back(name);
+          m_tradeTypes.push_back(location->first);
+          m_openPrices.push_back(open);
+          m_walk.add(open);
+        }
+      }
+      if (!wasPushing && !m_walk.empty())
+        start_pushing(m_context.args.ticker_rate);
+    } catch (std::exception const &e) {
+      reply(fmt::format(R"({{"event":"error","code":"60012","msg":"{}"}})",
+                        e.what()));
+    }
+  }
+
+  void next_frame(std::string &frame) override {
+    auto const index = m_walk.step();
+    auto const price = m_walk.price(index);
+    auto const open = m_openPrices[index];
+    fmt::format_to(
+        std::back_inserter(frame),
+        R"({{"arg":{{"channel":"tickers","instId":"{0}"}},"data":[{{)"
+        R"("instType":"{1}","instId":"{0}","last":"{2:.4f}","lastSz":"0.1",)"
+        R"("askPx":"{3:.4f}","askSz":"10","bidPx":"{4:.4f}","bidSz":"10",)"
+        R"("open24h":"{5:.4f}","high24h":"{6:.4f}","low24h":"{7:.4f}",)"
+        R"("sodUtc0":"{5:.4f}","sodUtc8":"{5:.4f}","volCcy24h":"1000",)"
+        R"("vol24h":"1000","ts":"{8}"}}]}})",
+        m_names[index], okex_inst_type(m_tradeTypes[index]), price,
+        price * 1.0005, price * 0.9995, open, std::max(price, open),
+        std::min(price, open), millis_now());
+  }
+};
+
+// OKX `/ws/v5/private`: login, then order updates for the subscribed types
+class okex_private_feed_t : public mock_feed_t {
+  std::string const m_connectionId = utils::getRandomString(8);
+  std::vector<trade_type_e> m_orderTypes{};
+  std::size_t m_orderId = 1;
+  bool m_isLoggedIn = false;
+
+public:
+  using mock_feed_t::mock_feed_t;
+
+protected:
+  void on_message(std::string_view const message) override {
+    if (message == "ping")
+      return reply("pong");
+
+    try {
+      auto const root = json::parse(message);
+      auto const op = root.at("op").get<json::string_t>();
+      if (op == "login") {
+        // any key will do
+        m_isLoggedIn = true;
+        return reply(fmt::format(
+            R"({{"event":"login","code":"0","msg":"","connId":"{}"}})",
+            m_connectionId));
+      }
+      if (op != "subscribe")
+        return reply(illegal_request);
+      if (!m_isLoggedIn)
+        return reply(not_logged_in);
+
+      bool const wasPushing = !m_orderTypes.empty();
+      for (auto const &arg : root.at("args").get<json::array_t>()) {
+        reply(fmt::format(R"({{"event":"subscribe","arg":{},"connId":"{}"}})",
+                          arg.dump(), m_connectionId));
+        if (arg.value("channel", "") != "orders")
+          continue;
+
+        auto const instType = arg.value("instType", "ANY");
+        if (instType == "SPOT" || instType == "ANY")
+          m_orderTypes.push_back(trade_type_e::spot);
+        if (instType == "SWAP" || instType == "ANY")
+          m_orderTypes.push_back(trade_type_e::swap);
+        if (instType == "FUTURES" || instType == "ANY")
+          m_orderTypes.push_back(trade_type_e::futures);
+      }
+      if (!wasPushing && !m_orderTypes.empty() &&
+          m_context.args.symbol_count != 0)
+        start_pushing(m_context.args.order_rate);
+    } catch (std::exception const &e) {
+      reply(fmt::format(R"({{"event":"error","code":"60012","msg":"{}"}})",
+                        e.what()));
+    }
+  }
+
+  void next_frame(std::string &frame) override {
+    auto const id = m_orderId++;
+    auto const tradeType = m_orderTypes[id % m_orderTypes.size()];
+    auto const &names = m_context.market.symbols(exchange_e::okex, tradeType);
+    auto const index = id % names.size();
+    auto const now = millis_now();
+    fmt::format_to(
+        std::back_inserter(frame),
+        R"({{"arg":{{"channel":"orders","instType":"{0}"}},"data":[{{)"
+        R"("instType":"{0}","instId":"{1}","ccy":"","ordId":"{2}",)"
+        R"("clOrdId":"","px":"{3:.4f}","sz":"1","ordType":"limit",)"
+        R"("side":"{4}","posSide":"net","tdMode":"cash","fillSz":"1",)"
+        R"("fillPx":"{3:.4f}","fillFee":"-0.001","fillFeeCcy":"USDT",)"
+        R"("state":"filled","feeCcy":"USDT","fee":"-0.001",)"
+        R"("uTime":"{5}","cTime":"{5}","amendResult":"","msg":""}}]}})",
+        okex_inst_type(tradeType), names[index], id,
+        mock_market_t::initial_price(index), id % 2 ? "buy" : "sell", now);
+  }
+};
+
+// KuCoin, public and private: a welcome, acks and pongs, then tickers or
+// order changes depending on the topics subscribed to
+class kucoin_feed_t : public mock_feed_t {
+  std::string const m_connectId;
+  bool const m_isFutures;
+  bool const m_isPrivate;
+  std::vector<std::string> m_names{};
+  price_walk_t m_walk{};
+  std::string m_orderTopic{};
+  std::size_t m_sequence = 1;
+
+public:
+  kucoin_feed_t(ssl_stream_t &&stream, mock_context_t const &context,
+                feed_route_t const &route)
+      : mock_feed_t(std::move(stream), context),
+        m_connectId(route.connectId),
+        m_isFutures(route.tradeType == trade_type_e::futures),
+        m_isPrivate(route.kind == feed_kind_e::kucoin_private) {}
+
+protected:
+  void on_connected() override {
+    reply(fmt::format(R"({{"id":"{}","type":"welcome"}})", m_connectId));
+  }
+
+  void on_message(std::string_view const message) override {
+    try {
+      auto const root = json::parse(message);
+      auto const id = root.contains("id") ? root["id"].dump()
+                                          : root.value("ID", json("")).dump();
+      auto const type = root.value("type", "");
+      if (type == "ping") {
+        return reply(fmt::format(R"({{"id":{},"type":"pong"}})", id));
+      } else if (type == "subscribe") {
+        subscribe(root.value("topic", ""));
+      } else if (type != "unsubscribe") {
+        return reply(fmt::format(
+            R"({{"id":{},"type":"error","code":400,"data":"unknown type"}})",
+            id));
+      }
+      reply(fmt::format(R"({{"id":{},"type":"ack"}})", id));
+    } catch (std::exception const &e) {
+      reply(fmt::format(R"({{"type":"error","code":400,"data":"{}"}})",
+                        e.what()));
+    }
+  }
+
+  void next_frame(std::string &frame) override {
+    if (m_isPrivate)
+      return next_order_frame(frame);
+
+    auto const index = m_walk.step();
+    auto const price = m_walk.price(index);
+    auto const sequence = m_sequence++;
+    auto out = std::back_inserter(frame);
+    if (m_isFutures) {
+      fmt::format_to(
+          out,
+          R"({{"type":"message","topic":"/contractMarket/tickerV2:{0}",)"
+          R"("subject":"tickerV2","data":{{"symbol":"{0}","sequence":{1},)"
+          R"("bestBidSize":10,"bestBidPrice":"{2:.4f}",)"
+          R"("bestAskPrice":"{3:.4f}","bestAskSize":10,"ts":{4}}}}})",
+          m_names[index], sequence, price * 0.9995, price * 1.0005,
+          micros_since_epoch() * 1'000);
+    } else {
+      fmt::format_to(
+          out,
+          R"({{"type":"message","topic":"/market/ticker:all",)"
+          R"("subject":"{0}","data":{{"bestAsk":"{1:.4f}",)"
+          R"("bestAskSize":"0.1","bestBid":"{2:.4f}","bestBidSize":"0.1",)"
+          R"("price":"{3:.4f}","sequence":"{4}","size":"0.01",)"
+          R"("time":{5}}}}})",
+          m_names[index], price * 1.0005, price * 0.9995, price, sequence,
+          millis_now());
+    }
+  }
+
+private:
+  void subscribe(std::string const &topic) {
+    auto const colon = topic.find(':');
+    auto const channel = topic.substr(0, colon);
+    if (m_isPrivate) {
+      if (channel == "/spotMarket/tradeOrdersV2" ||
+          channel == "/contractMarket/tradeOrders") {
+        bool const wasPushing = !m_orderTopic.empty();
+        m_orderTopic = channel;
+        if (!wasPushing && m_context.args.symbol_count != 0)
+          start_pushing(m_context.args.order_rate);
+      }
+      return;
+    }
+
+    bool const wasPushing = !m_walk.empty();
+    auto const tradeType =
+        m_isFutures ? trade_type_e::futures : trade_type_e::spot;
+    if (channel == "/market/ticker:all" ||
+        (channel == "/market/ticker" && topic.substr(colon + 1) == "all")) {
+      auto const &names =
+          m_context.market.symbols(exchange_e::kucoin, trade_type_e::spot);
+      for (std::size_t i = 0; i < names.size(); ++i)
+        add_symbol(names[i], i);
+    } else if (channel == "/contractMarket/tickerV2" &&
+               colon != std::string::npos) {
+      std::string_view names(topic);
+      names.remove_prefix(colon + 1);
+      while (!names.empty()) {
+        auto const comma = names.find(',');
+        std::string const name(names.substr(0, comma));
+        if (auto const location =
+                m_context.market.find(exchange_e::kucoin, name);
+            location && location->first == tradeType)
+          add_symbol(name, location->second);
+        if (comma == std::string_view::npos)
+          break;
+        names.remove_prefix(comma + 1);
+      }
+    }
+    if (!wasPushing && !m_walk.empty())
+      start_pushing(m_context.args.ticker_rate);
+  }
+
+  void add_symbol(std::string const &name, std::size_t const index) {
+    m_names.push_back(name);
+    m_walk.add(mock_market_t::initial_price(index));
+  }
+
+  void next_order_frame(std::string &frame) {
+    auto const id = m_sequence++;
+    bool const isFutures = m_orderTopic == "/contractMarket/tradeOrders";
+    auto const &names = m_context.market.symbols(
+        exchange_e::kucoin, isFutures ? trade_type_e::futures
+                                      : trade_type_e::spot);
+    auto const index = id % names.size();
+    fmt::format_to(
+        std::back_inserter(frame),
+        R"({{"type":"message","topic":"{0}","subject":"orderChange",)"
+        R"("channelType":"private","data":{{"symbol":"{1}",)"
+        R"("orderType":"limit","side":"{2}","orderId":"mock{3}",)"
+        R"("type":"match","orderTime":{4},"size":"1","filledSize":"1",)"
+        R"("price":"{5:.4f}","matchPrice":"{5:.4f}","matchSize":"1",)"
+        R"("tradeId":"{3}","clientOid":"mock{3}","remainSize":"0",)"
+        R"("status":"match","ts":{4}}}}})",
+        m_orderTopic, names[index], id % 2 ? "buy" : "sell", id,
+        micros_since_epoch() * 1'000, mock_market_t::initial_price(index));
+  }
+};
+} // namespace
+
+void feed_registry_t::add(std::weak_ptr<mock_feed_t> feed) {
+  std::lock_guard<std::mutex> lock_g{m_mutex};
+  m_feeds.erase(std::remove_if(m_feeds.begin(), m_feeds.end(),
+                               [](auto const &f) { return f.expired(); }),
+                m_feeds.end());
+  m_feeds.push_back(std::move(feed));
+}
+
+std::size_t feed_registry_t::disconnect_all() {
+  std::vector<std::shared_ptr<mock_feed_t>> feeds;
+  {
+    std::lock_guard<std::mutex> lock_g{m_mutex};
+    for (auto const &weakFeed : m_feeds) {
+      if (auto feed = weakFeed.lock(); feed)
+        feeds.push_back(std::move(feed));
+    }
+    m_feeds.clear();
+  }
+
+  for (auto const &feed : feeds)
+    feed->disconnect();
+  return feeds.size();
+}
+
+// ==================================================================
+
+std::optional<feed_route_t> route_feed(std::string_view const hostWithPort,
+                                       std::string_view const target) {
+  auto const host = strip_port(hostWithPort);
+  auto const path = target.substr(0, target.find('?'));
+
+  if (host == "stream.binance.com" || host == "fstream.binance.com") {
+    bool const isSpot = host == "stream.binance.com";
+    if (path == "/ws/!ticker@arr")
+      return feed_route_t{feed_kind_e::binance_tickers,
+                          isSpot ? trade_type_e::spot : trade_type_e::futures};
+    // anything else is taken for a listen key
+    if (isSpot && path.size() > 4 && path.substr(0, 4) == "/ws/")
+      return feed_route_t{feed_kind_e::binance_account};
+  } else if (host == "ws.okx.com") {
+    if (path == "/ws/v5/public")
+      return feed_route_t{feed_kind_e::okex_public};
+    if (path == "/ws/v5/private")
+      return feed_route_t{feed_kind_e::okex_private};
+  } else if (host == "ws-api-spot.kucoin.com" ||
+             host == "ws-api-futures.kucoin.com") {
+    auto const token = query_value(target, "token");
+    if (token.empty())
+      return std::nullopt;
+
+    feed_route_t route{token.substr(0, 8) == "private-"
+                           ? feed_kind_e::kucoin_private
+                           : feed_kind_e::kucoin_public,
+                       host == "ws-api-spot.kucoin.com" ? trade_type_e::spot
+                                                        : trade_type_e::futures,
+                       std::string(query_value(target, "connectId"))};
+    if (route.connectId.empty())
+      route.connectId = utils::getRandomString(10);
+    return route;
+  }
+  return std::nullopt;
+}
+
+std::shared_ptr<mock_feed_t> make_feed(feed_route_t const route,
+                                       ssl_stream_t &&stream,
+                                       mock_context_t const &context) {
+  switch (route.kind) {
+  case feed_kind_e::binance_tickers:
+    return std::make_shared<binance_tickers_feed_t>(std::move(stream), context,
+                                                    route.tradeType);
+  case feed_kind_e::binance_account:
+    return std::make_shared<binance_account_feed_t>(std::move(stream),
+                                                    context);
+  case feed_kind_e::okex_public:
+    return std::make_shared<okex_public_feed_t>(std::move(stream), context);
+  case feed_kind_e::okex_private:
+    return std::make_shared<okex_private_feed_t>(std::move(stream), context);
+  case feed_kind_e::kucoin_public:
+  case feed_kind_e::kucoin_private:
+    return std::make_shared<kucoin_feed_t>(std::move(stream), context, route);
+  }
+  return nullptr;
+}
+
+// ==================================================================
+
+mock_feed_t::mock_feed_t(ssl_stream_t &&stream, mock_context_t const &context)
+    : m_context(context), m_webStream(std::move(stream)),
+      m_pushTimer(m_webStream.get_executor()) {
+  ++m_context.registry.connections;
+}
+
+mock_feed_t::~mock_feed_t() { --m_context.registry.connections; }
+
+void mock_feed_t::run(upgrade_request_t request) {
+  m_webStream.set_option(
+      websocket::stream_base::timeout::suggested(beast::role_type::server));
+  m_upgradeRequest.emplace(std::move(request));
+  m_webStream.async_accept(
+      *m_upgradeRequest,
+      [self = shared_from_this()](beast::error_code const ec) {
+        self->m_upgradeRequest.reset();
+        if (ec)
+          return spdlog::error("websocket upgrade failed: {}", ec.message());
+
+        self->m_context.registry.add(self->weak_from_this());
+        self->on_connected();
+        self->read_next();
+      });
+}
+
+void mock_feed_t::disconnect() {
+  net::post(m_webStream.get_executor(), [self = shared_from_this()] {
+    if (self->m_isStopped)
+      return;
+    // nothing new is written after the close frame
+    self->stop();
+    self->m_webStream.async_close(
+        websocket::close_code::going_away,
+        [self](beast::error_code const) {});
+  });
+}
+
+void mock_feed_t::read_next() {
+  m_readBuffer.clear();
+  m_webStream.async_read(
+      m_readBuffer, [self = shared_from_this()](beast::error_code const ec,
+                                                std::size_t const) {
+        if (ec)
+          return self->stop();
+
+        auto const data = self->m_readBuffer.cdata();
+        self->on_message(std::string_view(
+            static_cast<char const *>(data.data()), data.size()));
+        self->read_next();
+      });
+}
+
+void mock_feed_t::reply(std::string message) {
+  if (m_isStopped)
+    return;
+  m_replies.push_back(std::move(message));
+  if (!m_isWriting)
+    write_next();
+}
+
+void mock_feed_t::write_next() {
+  auto &queue = m_replies.empty() ? m_frames : m_replies;
+  if (m_isStopped || queue.empty()) {
+    m_isWriting = false;
+    return;
+  }
+
+  m_isWriting = true;
+  m_writing = std::move(queue.front());
+  queue.pop_front();
+  m_webStream.text(true);
+  m_webStream.async_write(
+      net::buffer(m_writing), [self = shared_from_this()](
+                                  beast::error_code const ec,
+                                  std::size_t const bytesWritten) {
+        if (ec) {
+          self->m_isWriting = false;
+          return self->stop();
+        }
+        ++self->m_context.registry.frames;
+        self->m_context.registry.bytes += bytesWritten;
+        self->write_next();
+      });
+}
+
+void mock_feed_t::start_pushing(double const framesPerSecond) {
+  if (framesPerSecond <= 0.0 || m_isStopped)
+    return;
+
+  using namespace std::chrono;
+  m_framesPerSecond = framesPerSecond;
+  m_pushStart = steady_clock::now();
+  m_pushed = 0;
+  // fast feeds are topped up every millisecond, slow ones at their own pace
+  // but at least ten times a second, so that a rate change shows quickly
+  auto const period = duration<double>(1.0 / framesPerSecond);
+  m_tickInterval = std::clamp(duration_cast<steady_clock::duration>(period),
+                              duration_cast<steady_clock::duration>(1ms),
+                              duration_cast<steady_clock::duration>(100ms));
+  m_pushTimer.expires_after(m_tickInterval);
+  schedule_tick();
+}
+
+void mock_feed_t::schedule_tick() {
+  m_pushTimer.async_wait(
+      [self = shared_from_this()](boost::system::error_code const ec) {
+        if (!ec)
+          self->on_tick();
+      });
+}
+
+void mock_feed_t::on_tick() {
+  if (m_isStopped)
+    return;
+
+  auto const elapsed = std::chrono::duration<double>(
+      std::chrono::steady_clock::now() - m_pushStart);
+  auto const due =
+      static_cast<std::size_t>(elapsed.count() * m_framesPerSecond) - m_pushed;
+  m_pushed += due;
+
+  auto const maxQueued = m_context.args.max_queued_frames;
+  auto const room =
+      m_frames.size() < maxQueued ? maxQueued - m_frames.size() : 0;
+  auto const count = std::min(due, room);
+  m_context.registry.dropped += due - count;
+  for (std::size_t i = 0; i < count; ++i)
+    next_frame(m_frames.emplace_back());
+
+  if (!m_isWriting)
+    write_next();
+  m_pushTimer.expires_at(m_pushTimer.expiry() + m_tickInterval);
+  schedule_tick();
+}
+
+void mock_feed_t::stop() {
+  m_isStopped = true;
+  m_pushTimer.cancel();
+  m_replies.clear();
+  m_frames.clear();
+}
+} // namespace keep_my_journal
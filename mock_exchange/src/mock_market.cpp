@@ -0,0 +1,222 @@
+// Copyright (C) 2023-2024 Joshua and Jordan Ogunyinka
+
+#include "mock_market.hpp"
+#include "json_utils.hpp"
+#include "latency_histogram.hpp"
+#include "random_utils.hpp"
+
+#include <spdlog/spdlog.h>
+
+namespace keep_my_journal {
+namespace {
+std::string price_string(double const price) {
+  return fmt::format("{:.4f}", price);
+}
+} // namespace
+
+std::string_view strip_port(std::string_view const host) {
+  return host.substr(0, host.find(':'));
+}
+
+std::string_view query_value(std::string_view const target,
+                             std::string_view const key) {
+  auto const query = target.find('?');
+  if (query == std::string_view::npos)
+    return {};
+
+  auto params = target.substr(query + 1);
+  while (!params.empty()) {
+    auto const ampersand = params.find('&');
+    auto const param = params.substr(0, ampersand);
+    if (param.size() > key.size() && param.substr(0, key.size()) == key &&
+        param[key.size()] == '=')
+      return param.substr(key.size() + 1);
+    if (ampersand == std::string_view::npos)
+      break;
+    params.remove_prefix(ampersand + 1);
+  }
+  return {};
+}
+
+mock_market_t::mock_market_t(std::size_t const symbolCount) {
+  for (std::size_t i = 0; i < symbolCount; ++i) {
+    auto const base = fmt::format("MK{:04}", i);
+    add_symbol(exchange_e::binance, trade_type_e::spot, base + "USDT");
+    add_symbol(exchange_e::binance, trade_type_e::futures, base + "USDT");
+    add_symbol(exchange_e::okex, trade_type_e::spot, base + "-USDT");
+    add_symbol(exchange_e::okex, trade_type_e::swap, base + "-USDT-SWAP");
+    add_symbol(exchange_e::okex, trade_type_e::futures, base + "-USD-251226");
+    add_symbol(exchange_e::kucoin, trade_type_e::spot, base + "-USDT");
+    add_symbol(exchange_e::kucoin, trade_type_e::futures, base + "USDTM");
+  }
+  spdlog::info("Listing {} instruments per exchange and trade type",
+               symbolCount);
+}
+
+std::vector<std::string> &mock_market_t::symbols(exchange_e const exchange,
+                                                 trade_type_e const tradeType) {
+  return m_symbols[static_cast<std::size_t>(exchange) * trade_type_count +
+                   static_cast<std::size_t>(tradeType)];
+}
+
+std::vector<std::string> const &
+mock_market_t::symbols(exchange_e const exchange,
+                       trade_type_e const tradeType) const {
+  return m_symbols[static_cast<std::size_t>(exchange) * trade_type_count +
+                   static_cast<std::size_t>(tradeType)];
+}
+
+void mock_market_t::add_symbol(exchange_e const exchange,
+                               trade_type_e const tradeType,
+                               std::string name) {
+  auto &list = symbols(exchange, tradeType);
+  // Binance's spot and futures symbols are named alike, the first one wins
+  m_locations[static_cast<std::size_t>(exchange)].emplace(
+      name, symbol_location_t{tradeType, list.size()});
+  list.push_back(std::move(name));
+}
+
+std::optional<mock_market_t::symbol_location_t>
+mock_market_t::find(exchange_e const exchange, std::string const &name) const {
+  auto const &locations = m_locations[static_cast<std::size_t>(exchange)];
+  if (auto const iter = locations.find(name); iter != locations.end())
+    return iter->second;
+  return std::nullopt;
+}
+
+double mock_market_t::initial_price(std::size_t const index) {
+  return 0.5 + static_cast<double>(index) * 1.37;
+}
+
+std::optional<std::string>
+mock_market_t::rest_response(std::string_view const hostWithPort,
+                             http::verb const method,
+                             std::string_view const target) const {
+  auto const host = strip_port(hostWithPort);
+  auto const path = target.substr(0, target.find('?'));
+
+  if (host == "api.binance.com") {
+    if (path == "/api/v3/ticker/price" && method == http::verb::get)
+      return binance_ticker_prices(trade_type_e::spot);
+    if (path == "/api/v3/userDataStream") {
+      if (method == http::verb::post)
+        return json(json::object_t{{"listenKey", utils::getRandomString(60)}})
+            .dump();
+      return std::string("{}"); // keepalive (PUT) and close (DELETE)
+    }
+  } else if (host == "fapi.binance.com") {
+    if (path == "/fapi/v1/ticker/price" && method == http::verb::get)
+      return binance_ticker_prices(trade_type_e::futures);
+  } else if (host == "www.okx.com") {
+    if (path == "/api/v5/public/instruments" && method == http::verb::get)
+      return okex_instruments(query_value(target, "instType"));
+  } else if (host == "api.kucoin.com" || host == "api-futures.kucoin.com") {
+    bool const isFutures = host == "api-futures.kucoin.com";
+    if (path == "/api/v1/bullet-public" || path == "/api/v1/bullet-private")
+      return kucoin_bullet(isFutures ? "ws-api-futures.kucoin.com"
+                                     : "ws-api-spot.kucoin.com",
+                           path == "/api/v1/bullet-private");
+    if (!isFutures && path == "/api/v1/market/allTickers")
+      return kucoin_spot_tickers();
+    if (isFutures && path == "/api/v1/contracts/active")
+      return kucoin_futures_contracts();
+  }
+  return std::nullopt;
+}
+
+std::string mock_market_t::binance_ticker_prices(
+    trade_type_e const tradeType) const {
+  auto const &list = symbols(exchange_e::binance, tradeType);
+  json::array_t tickers;
+  tickers.reserve(list.size());
+  for (std::size_t i = 0; i < list.size(); ++i) {
+    tickers.push_back(json::object_t{
+        {"symbol", list[i]}, {"price", price_string(initial_price(i))}});
+  }
+  return json(tickers).dump();
+}
+
+std::string
+mock_market_t::okex_instruments(std::string_view const instType) const {
+  trade_type_e tradeType;
+  if (instType == "SPOT")
+    tradeType = trade_type_e::spot;
+  else if (instType == "SWAP")
+    tradeType = trade_type_e::swap;
+  else if (instType == "FUTURES")
+    tradeType = trade_type_e::futures;
+  else
+    return json(json::object_t{{"code", "51000"},
+                               {"msg", "Parameter instType error"},
+                               {"data", json::array_t{}}})
+        .dump();
+
+  json::array_t instruments;
+  for (auto const &name : symbols(exchange_e::okex, tradeType)) {
+    instruments.push_back(json::object_t{
+        {"instType", instType}, {"instId", name}, {"state", "live"}});
+  }
+  return json(json::object_t{
+                  {"code", "0"}, {"msg", ""}, {"data", std::move(instruments)}})
+      .dump();
+}
+
+std::string mock_market_t::kucoin_spot_tickers() const {
+  auto const &list = symbols(exchange_e::kucoin, trade_type_e::spot);
+  json::array_t tickers;
+  tickers.reserve(list.size());
+  for (std::size_t i = 0; i < list.size(); ++i) {
+    tickers.push_back(json::object_t{{"symbol", list[i]},
+                                     {"last", price_string(initial_price(i))}});
+  }
+
+  json::object_t data{{"time", micros_since_epoch() / 1'000},
+                      {"ticker", std::move(tickers)}};
+  return json(json::object_t{{"code", "200000"}, {"data", std::move(data)}})
+      .dump();
+}
+
+std::string mock_market_t::kucoin_futures_contracts() const {
+  auto const &list = symbols(exchange_e::kucoin, trade_type_e::futures);
+  json::array_t contracts;
+  contracts.reserve(list.size());
+  for (std::size_t i = 0; i < list.size(); ++i) {
+    contracts.push_back(json::object_t{{"symbol", list[i]},
+                                       {"lastTradePrice", initial_price(i)}});
+  }
+  return json(json::object_t{{"code", "200000"},
+                             {"data", std::move(contracts)}})
+      .dump();
+}
+
+// the token says which kind of feed the websocket connection is for; the
+// endpoint keeps KuCoin's own host name so that a "*" host override on the
+// client's side sends it back here
+std::string mock_market_t::kucoin_bullet(std::string_view const host,
+                                         bool const isPrivate) {
+  json::object_t server{{"endpoint", fmt::format("wss://{}/", host)},
+                        {"encrypt", true},
+                        {"protocol", "websocket"},
+                        {"pingInterval", 18'000},
+                        {"pingTimeout", 10'000}};
+  json::object_t data{
+      {"token", (isPrivate ? "private-" : "public-") +
+                    utils::getRandomString(40)},
+      {"instanceServers", json::array_t{std::move(server)}}};
+  return json(json::object_t{{"code", "200000"}, {"data", std::move(data)}})
+      .dump();
+}
+
+// ==================================================================
+
+price_walk_t::price_walk_t(std::vector<double> initialPrices)
+    : m_prices(std::move(initialPrices)),
+      m_generator(std::random_device{}()) {}
+
+std::size_t price_walk_t::step() {
+  auto const index = m_next;
+  m_next = (m_next + 1) % m_prices.size();
+  m_prices[index] *= 1.0 + m_distribution(m_generator);
+  return index;
+}
+} // namespace keep_my_journal
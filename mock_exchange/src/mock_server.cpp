@@ -0,0 +1,127 @@
+// Copyright (C) 2023-2024 Joshua and Jordan Ogunyinka
+
+#include "mock_server.hpp"
+#include "mock_session.hpp"
+
+#include <boost/asio/strand.hpp>
+#include <spdlog/spdlog.h>
+
+namespace keep_my_journal {
+namespace {
+constexpr auto report_interval = std::chrono::seconds(5);
+} // namespace
+
+mock_server_t::mock_server_t(net::io_context &ioContext,
+                             net::ssl::context &sslContext,
+                             mock_context_t const &context)
+    : m_ioContext(ioContext), m_sslContext(sslContext), m_context(context),
+      m_acceptor(net::make_strand(ioContext)),
+      m_reportTimer(net::make_strand(ioContext)),
+      m_disconnectTimer(net::make_strand(ioContext)) {
+  auto const &args = m_context.args;
+  beast::error_code ec{};
+  tcp::endpoint endpoint(net::ip::make_address(args.ip_address, ec),
+                         args.port);
+  if (ec) {
+    spdlog::error("Invalid address {}: {}", args.ip_address, ec.message());
+    return;
+  }
+
+  m_acceptor.open(endpoint.protocol(), ec);
+  if (ec) {
+    spdlog::error("Could not open socket: {}", ec.message());
+    return;
+  }
+
+  m_acceptor.set_option(net::socket_base::reuse_address(true), ec);
+  if (ec) {
+    spdlog::error("set_option failed: {}", ec.message());
+    return;
+  }
+
+  m_acceptor.bind(endpoint, ec);
+  if (ec) {
+    spdlog::error("binding failed: {}", ec.message());
+    return;
+  }
+
+  m_acceptor.listen(net::socket_base::max_listen_connections, ec);
+  if (ec) {
+    spdlog::error("not able to listen: {}", ec.message());
+    return;
+  }
+
+  spdlog::info("Mock exchange running on {}:{}", args.ip_address, args.port);
+  m_isOpen = true;
+}
+
+bool mock_server_t::run() {
+  if (!m_isOpen)
+    return false;
+
+  accept_connections();
+  report_every(report_interval);
+  if (m_context.args.disconnect_every != 0)
+    disconnect_every(std::chrono::seconds(m_context.args.disconnect_every));
+  return true;
+}
+
+void mock_server_t::accept_connections() {
+  m_acceptor.async_accept(
+      net::make_strand(m_ioContext),
+      [self = shared_from_this()](beast::error_code const ec,
+                                  tcp::socket socket) {
+        self->on_connection_accepted(ec, std::move(socket));
+      });
+}
+
+void mock_server_t::on_connection_accepted(beast::error_code const ec,
+                                           tcp::socket socket) {
+  if (ec) {
+    spdlog::error("error on connection: {}", ec.message());
+  } else {
+    socket.set_option(tcp::no_delay(true));
+    std::make_shared<mock_session_t>(std::move(socket), m_sslContext,
+                                     m_context)
+        ->run();
+  }
+  accept_connections();
+}
+
+void mock_server_t::report_every(std::chrono::seconds const interval) {
+  m_reportTimer.expires_after(interval);
+  m_reportTimer.async_wait([self = shared_from_this(),
+                            interval](beast::error_code const ec) {
+    if (ec)
+      return;
+
+    auto &registry = self->m_context.registry;
+    std::size_t const frames = registry.frames;
+    std::size_t const bytes = registry.bytes;
+    std::size_t const dropped = registry.dropped;
+    auto const seconds = static_cast<double>(interval.count());
+    spdlog::info("{} feed(s): {:.0f} frames/s, {:.2f} MB/s, {} dropped",
+                 registry.connections.load(),
+                 static_cast<double>(frames - self->m_lastFrames) / seconds,
+                 static_cast<double>(bytes - self->m_lastBytes) / seconds /
+                     (1024.0 * 1024.0),
+                 dropped - self->m_lastDropped);
+    self->m_lastFrames = frames;
+    self->m_lastBytes = bytes;
+    self->m_lastDropped = dropped;
+    self->report_every(interval);
+  });
+}
+
+void mock_server_t::disconnect_every(std::chrono::seconds const interval) {
+  m_disconnectTimer.expires_after(interval);
+  m_disconnectTimer.async_wait(
+      [self = shared_from_this(), interval](beast::error_code const ec) {
+        if (ec)
+          return;
+        auto const count = self->m_context.registry.disconnect_all();
+        spdlog::warn("Disconnected {} feed(s)", count);
+        self->disconnect_every(interval);
+      });
+}
+} // namespace keep_my_journal
@@ -0,0 +1,100 @@
+// Copyright (C) 2023-2024 Joshua and Jordan Ogunyinka
+
+#include "mock_session.hpp"
+
+#include <boost/beast/http/read.hpp>
+#include <boost/beast/http/write.hpp>
+#include <boost/beast/websocket/rfc6455.hpp>
+#include <spdlog/spdlog.h>
+
+namespace keep_my_journal {
+mock_session_t::mock_session_t(net::ip::tcp::socket &&socket,
+                               net::ssl::context &sslContext,
+                               mock_context_t const &context)
+    : m_stream(std::move(socket), sslContext), m_context(context) {}
+
+void mock_session_t::run() {
+  beast::get_lowest_layer(m_stream).expires_after(std::chrono::seconds(30));
+  m_stream.async_handshake(
+      net::ssl::stream_base::server,
+      [self = shared_from_this()](beast::error_code const ec) {
+        if (ec)
+          return spdlog::error("TLS handshake failed: {}", ec.message());
+        self->read_request();
+      });
+}
+
+void mock_session_t::read_request() {
+  m_parser.emplace();
+  m_parser->body_limit(1024 * 1024);
+  beast::get_lowest_layer(m_stream).expires_after(std::chrono::seconds(30));
+  http::async_read(m_stream, m_buffer, *m_parser,
+                   [self = shared_from_this()](beast::error_code const ec,
+                                               std::size_t const) {
+                     self->on_request_read(ec);
+                   });
+}
+
+void mock_session_t::on_request_read(beast::error_code const ec) {
+  if (ec == http::error::end_of_stream)
+    return shutdown();
+  if (ec)
+    return;
+
+  auto request = m_parser->release();
+  auto const host = request[http::field::host];
+  auto const target = request.target();
+  std::string_view const hostView(host.data(), host.size());
+  std::string_view const targetView(target.data(), target.size());
+
+  if (websocket::is_upgrade(request)) {
+    if (auto route = route_feed(hostView, targetView); route)
+      return upgrade(std::move(*route), std::move(request));
+  } else if (auto body = m_context.market.rest_response(
+                 hostView, request.method(), targetView);
+             body) {
+    string_response_t response{http::status::ok, request.version()};
+    response.set(http::field::content_type, "application/json");
+    response.keep_alive(request.keep_alive());
+    response.body() = std::move(*body);
+    response.prepare_payload();
+    return send_response(std::move(response));
+  }
+
+  spdlog::warn("no mock for {} {}{}", std::string(request.method_string()),
+               hostView, targetView);
+  string_response_t response{http::status::not_found, request.version()};
+  response.set(http::field::content_type, "application/json");
+  response.keep_alive(request.keep_alive());
+  response.body() = R"({"code":"404","msg":"not mocked"})";
+  response.prepare_payload();
+  send_response(std::move(response));
+}
+
+void mock_session_t::upgrade(feed_route_t route, upgrade_request_t request) {
+  // the feed owns the connection from here on
+  beast::get_lowest_layer(m_stream).expires_never();
+  make_feed(std::move(route), std::move(m_stream), m_context)
+      ->run(std::move(request));
+}
+
+void mock_session_t::send_response(string_response_t &&response) {
+  m_response.emplace(std::move(response));
+  http::async_write(m_stream, *m_response,
+                    [self = shared_from_this()](beast::error_code const ec,
+                                                std::size_t const) {
+                      if (ec)
+                        return;
+                      if (!self->m_response->keep_alive())
+                        return self->shutdown();
+                      self->m_response.reset();
+                      self->read_request();
+                    });
+}
+
+void mock_session_t::shutdown() {
+  beast::get_lowest_layer(m_stream).expires_after(std::chrono::seconds(5));
+  m_stream.async_shutdown(
+      [self = shared_from_this()](beast::error_code const) {});
+}
+} // namespace keep_my_journal
@@ -10,7 +10,10 @@
 #include <set>
 
 #include "json_utils.hpp"
-#include "price_stream/commodity.hpp"
+#include "price_stream/instrument_sink.hpp"
+#include "price_stream/symbol_registry.hpp"
+#include "reconnect_policy.hpp"
+#include "websocket_connector.hpp"
 
 namespace keep_my_journal {
 
@@ -24,8 +27,6 @@ class https_rest_api_t;
 
 class binance_price_stream_t
     : public std::enable_shared_from_this<binance_price_stream_t> {
-  using resolver = ip::tcp::resolver;
-  using results_type = resolver::results_type;
 
   char const *const m_restApiHost;
   char const *const m_wsHostname;
@@ -33,26 +34,23 @@ class binance_price_stream_t
   net::io_context &m_ioContext;
   net::ssl::context &m_sslContext;
   instrument_sink_t::list_t &m_tradedInstruments;
+  symbol_registry_t &m_symbols;
   trade_type_e const m_tradeType;
 
-  std::optional<resolver> m_resolver;
-  std::optional<websocket::stream<beast::ssl_stream<beast::tcp_stream>>>
-      m_sslWebStream;
+  std::optional<ssl_websocket_stream_t> m_sslWebStream;
   std::optional<beast::flat_buffer> m_buffer;
   std::unique_ptr<https_rest_api_t> m_httpClient = nullptr;
+  std::size_t m_lastFrameSize = 0;
+  reconnect_policy_t m_reconnect;
 
 private:
   void rest_api_initiate_connection();
   void rest_api_on_data_received(std::string const &);
-  void negotiate_websocket_connection();
   void initiate_websocket_connection();
-  void websocket_perform_ssl_handshake(results_type::endpoint_type const &);
-  void websocket_connect_to_resolved_names(results_type const &);
-  void perform_websocket_handshake();
   void wait_for_messages();
-  void process_pushed_tickers_data(json::array_t const &);
   void interpret_generic_messages();
   void process_pushed_instruments_data(json::array_t const &);
+  void report_error_and_retry(beast::error_code);
 
 protected:
   virtual std::string rest_api_get_target() const = 0;
@@ -63,6 +61,8 @@ public:
                          char const *wsPortNumber);
   virtual ~binance_price_stream_t() = default;
   void run();
+  // handles a `!ticker@arr` frame, read off the websocket or replayed
+  void process_frame(std::string_view frame, std::int64_t receivedAt);
 };
 
 class binance_spot_price_stream_t : public binance_price_stream_t {
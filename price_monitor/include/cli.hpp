@@ -0,0 +1,42 @@
+// Copyright (C) 2023-2024 Joshua and Jordan Ogunyinka
+
+#pragma once
+
+#include <cstddef>
+#include <string>
+#include <vector>
+
+#include "enumerations.hpp"
+
+namespace keep_my_journal {
+struct command_line_interface_t {
+  // capacity of each exchange's instrument queue, 0 means unbounded
+  std::size_t queue_capacity{0};
+  queue_overflow_policy_e overflow_policy{queue_overflow_policy_e::drop_oldest};
+  // publish only the latest price per instrument
+  bool conflate{false};
+  io_threading_model_e io_model{io_threading_model_e::shared};
+  // threads running the io_context when it is shared by every stream
+  std::size_t io_threads{3};
+  // cores the io_context threads are pinned to, round-robin
+  std::vector<int> cpu_affinity{};
+  // every websocket frame received is appended to this file
+  std::string capture_file{};
+  // frames are replayed from this capture instead of the exchanges
+  std::string replay_file{};
+  // replay as fast as possible rather than at the recorded pace
+  bool replay_max_speed{false};
+  std::size_t replay_loops{1};
+  // "host=address:port" redirections, e.g. to the local mock exchange
+  std::vector<std::string> host_overrides{};
+  // trusted in place of the system's CA bundle
+  std::string ca_file{};
+  // most price records published in one zmq frame, 1 disables batching
+  std::size_t batch_size{64};
+  // longest a record waits for its frame to fill up
+  std::size_t batch_interval_us{250};
+  // instruments per exchange in the /dev/shm price table, 0 doesn't share
+  // one
+  std::size_t shared_table_capacity{0};
+};
+} // namespace keep_my_journal
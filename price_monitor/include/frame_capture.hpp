@@ -0,0 +1,107 @@
+// Copyright (C) 2023-2024 Joshua and Jordan Ogunyinka
+#pragma once
+
+#include <array>
+#include <cstdint>
+#include <functional>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <string_view>
+
+#include "enumerations.hpp"
+
+namespace keep_my_journal {
+// A capture file is `capture_magic` followed by one record per websocket
+// frame: a `capture_record_header_t`, then the frame itself padded to 8
+// bytes. Everything is in the host's byte order, captures are meant to be
+// replayed on the same kind of box they were recorded on. A record with a
+// zero size marks the end (the file is grown in chunks and a process that
+// died mid-capture leaves the rest of the last chunk zeroed).
+inline constexpr char capture_magic[8] = {'K', 'M', 'J', 'C',
+                                          'A', 'P', '0', '1'};
+
+struct capture_record_header_t {
+  std::uint32_t size = 0; // of the frame, without the padding
+  std::uint8_t exchange = 0;
+  std::uint8_t tradeType = 0;
+  std::uint16_t reserved = 0;
+  std::int64_t receivedAt = 0; // microseconds since the epoch
+};
+static_assert(sizeof(capture_record_header_t) == 16);
+
+// appends frames to a memory-mapped capture file, shared by every stream
+class frame_recorder_t {
+public:
+  // starts capturing into `path` (truncating it), must be called before any
+  // stream is started. Returns false if the file can't be set up.
+  static bool open(std::string const &path);
+  // null unless capturing
+  static frame_recorder_t *get() { return instance().get(); }
+  // trims and closes the capture, once every stream has stopped
+  static void close();
+
+  ~frame_recorder_t();
+  void record(exchange_e exchange, trade_type_e tradeType,
+              std::int64_t receivedAt, std::string_view frame);
+
+private:
+  static std::unique_ptr<frame_recorder_t> &instance();
+
+  frame_recorder_t(int fd, std::string path);
+  bool map_chunk(std::size_t minimumSize);
+
+  std::mutex m_mutex{};
+  std::string const m_path;
+  int const m_fd;
+  char *m_map = nullptr;
+  std::size_t m_mappedSize = 0;
+  std::size_t m_offset = 0;
+};
+
+// a no-op unless price_monitor was started with --capture-file
+inline void capture_frame(exchange_e const exchange,
+                          trade_type_e const tradeType,
+                          std::int64_t const receivedAt,
+                          std::string_view const frame) {
+  if (auto *recorder = frame_recorder_t::get())
+    recorder->record(exchange, tradeType, receivedAt, frame);
+}
+
+// feeds a capture back into the streams' frame handlers, from the calling
+// thread and in recorded order, with no network involved
+class frame_replayer_t {
+public:
+  using frame_handler_t =
+      std::function<void(std::string_view frame, std::int64_t receivedAt)>;
+
+  // `keepPace` replays at the recorded pace, otherwise as fast as possible
+  frame_replayer_t(std::string path, bool keepPace, std::size_t loops);
+
+  void add_stream(exchange_e exchange, trade_type_e tradeType,
+                  frame_handler_t handler);
+  // any stream with a `process_frame(std::string_view, std::int64_t)`
+  template <typename Stream>
+  void add_stream(exchange_e const exchange, trade_type_e const tradeType,
+                  std::shared_ptr<Stream> stream) {
+    add_stream(exchange, tradeType,
+               [stream = std::move(stream)](std::string_view const frame,
+                                            std::int64_t const receivedAt) {
+                 stream->process_frame(frame, receivedAt);
+               });
+  }
+  // returns false if the capture can't be read
+  bool run(bool const &running);
+
+private:
+  static constexpr auto trade_type_count =
+      static_cast<std::size_t>(trade_type_e::total);
+
+  std::string const m_path;
+  bool const m_keepPace;
+  std::size_t const m_loops;
+  std::array<frame_handler_t,
+             static_cast<std::size_t>(exchange_e::total) * trade_type_count>
+      m_handlers{};
+};
+} // namespace keep_my_journal
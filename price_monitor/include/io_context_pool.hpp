@@ -0,0 +1,64 @@
+// Copyright (C) 2023-2024 Joshua and Jordan Ogunyinka
+#pragma once
+
+#include <boost/asio/executor_work_guard.hpp>
+#include <boost/asio/io_context.hpp>
+#include <boost/asio/steady_timer.hpp>
+#include <chrono>
+#include <cstdint>
+#include <memory>
+#include <string>
+#include <thread>
+#include <vector>
+
+#include "enumerations.hpp"
+
+namespace keep_my_journal {
+namespace net = boost::asio;
+
+// owns the io_contexts the price streams run on and the threads running them.
+// Depending on the model, every stream shares one context, each exchange gets
+// its own or each (exchange, trade type) stream gets its own, so a slow
+// handler on one context can't hold back reads queued on another.
+class io_context_pool_t {
+  struct context_entry_t {
+    std::string name;
+    std::size_t threadCount;
+    net::io_context ioContext;
+    net::executor_work_guard<net::io_context::executor_type> workGuard;
+    // fires every `probe_interval`; how late it runs is how long a handler
+    // posted now would wait in the context's queue
+    net::steady_timer probe;
+    std::uint64_t samples = 0;
+    std::chrono::microseconds totalDelay{};
+    std::chrono::microseconds maxDelay{};
+    std::vector<std::thread> threads{};
+
+    context_entry_t(std::string name, std::size_t threadCount);
+  };
+
+  static constexpr auto probe_interval = std::chrono::seconds(1);
+  static constexpr std::uint64_t samples_per_report = 30;
+
+  io_threading_model_e const m_model;
+  std::size_t const m_sharedThreadCount;
+  std::vector<int> const m_cpus;
+  // indexed by exchange * trade_type_e::total + trade type
+  std::vector<context_entry_t *> m_index;
+  std::vector<std::unique_ptr<context_entry_t>> m_contexts{};
+
+  void probe_queue_latency(context_entry_t &entry);
+
+public:
+  // `cpus` is the list of cores the context threads are pinned to, in a
+  // round-robin, an empty list leaves the scheduler to decide
+  io_context_pool_t(io_threading_model_e model, std::size_t sharedThreadCount,
+                    std::vector<int> cpus);
+
+  // must not be called after `run`
+  net::io_context &get(exchange_e exchange, trade_type_e tradeType);
+  void run();
+  void stop();
+  void join();
+};
+} // namespace keep_my_journal
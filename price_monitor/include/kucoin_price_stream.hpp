@@ -9,7 +9,10 @@
 #include <boost/beast/websocket/stream.hpp>
 
 #include "json_utils.hpp"
-#include "price_stream/commodity.hpp"
+#include "price_stream/instrument_sink.hpp"
+#include "price_stream/symbol_registry.hpp"
+#include "reconnect_policy.hpp"
+#include "websocket_connector.hpp"
 #include "uri.hpp"
 #include <optional>
 #include <set>
@@ -40,14 +43,10 @@ class kucoin_price_stream_t
     int encryptProtocol = 0; // bool encrypt or not
   };
 
-  using resolver = ip::tcp::resolver;
-  using results_type = resolver::results_type;
 
   net::io_context &m_ioContext;
   ssl::context &m_sslContext;
-  std::optional<resolver> m_resolver = std::nullopt;
-  std::optional<ws::stream<beast::ssl_stream<beast::tcp_stream>>>
-      m_sslWebStream = std::nullopt;
+  std::optional<ssl_websocket_stream_t> m_sslWebStream = std::nullopt;
   std::optional<beast::flat_buffer> m_readWriteBuffer = std::nullopt;
   std::optional<net::deadline_timer> m_pingTimer;
   std::unique_ptr<https_rest_api_t> m_httpClient = nullptr;
@@ -58,15 +57,19 @@ class kucoin_price_stream_t
   std::vector<instance_server_data_t> m_instanceServers;
   uri_t m_uri;
   trade_type_e const m_tradeType;
+  reconnect_policy_t m_reconnect;
 
 public:
   kucoin_price_stream_t(net::io_context &ioContext, ssl::context &sslContext,
                         trade_type_e);
   virtual ~kucoin_price_stream_t() = default;
   void run();
+  // handles a ticker push, read off the websocket or replayed
+  void process_frame(std::string_view frame, std::int64_t receivedAt);
 
 protected:
   instrument_sink_t::list_t &m_tradedInstruments;
+  symbol_registry_t &m_symbols;
   bool m_tokensSubscribedFor = false;
 
   virtual void reset_counter() { m_tokensSubscribedFor = false; }
@@ -83,11 +86,7 @@ private:
   void reset_ping_timer();
   void on_ping_timer_tick(boost::system::error_code const &);
   void report_error_and_retry(beast::error_code);
-  void negotiate_websocket_connection();
   void initiate_websocket_connection();
-  void websocket_perform_ssl_handshake();
-  void websocket_connect_to_resolved_names(results_type const &);
-  void perform_websocket_handshake();
   void wait_for_messages();
   void send_ticker_subscription();
   void interpret_generic_messages();
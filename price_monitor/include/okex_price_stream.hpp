@@ -11,7 +11,10 @@
 #include <set>
 
 #include "json_utils.hpp"
-#include "price_stream/commodity.hpp"
+#include "price_stream/instrument_sink.hpp"
+#include "price_stream/symbol_registry.hpp"
+#include "reconnect_policy.hpp"
+#include "websocket_connector.hpp"
 
 namespace keep_my_journal {
 
@@ -30,34 +33,29 @@ class okex_price_stream_t
   static char const *const api_host;
   static char const *const api_service;
 
-  using resolver = ip::tcp::resolver;
-  using results_type = resolver::results_type;
 
   net::io_context &m_ioContext;
   net::ssl::context &m_sslContext;
   instrument_sink_t::list_t &m_tradedInstruments;
+  symbol_registry_t &m_symbols;
   std::set<std::string> m_instruments{};
-  std::optional<resolver> m_resolver;
-  std::optional<websock::stream<beast::ssl_stream<beast::tcp_stream>>>
-      m_sslWebStream;
+  std::optional<ssl_websocket_stream_t> m_sslWebStream;
   std::optional<std::string> m_sendingBufferText;
   std::optional<beast::flat_buffer> m_buffer;
   std::unique_ptr<https_rest_api_t> m_httpClient = nullptr;
   trade_type_e const m_tradeType;
+  reconnect_policy_t m_reconnect;
 
 private:
   void rest_api_initiate_connection();
   void rest_api_on_data_received(std::string const &);
 
   void initiate_websocket_connection();
-  void connect_to_resolved_names(results_type const &);
-  void perform_ssl_handshake();
-  void perform_websocket_handshake();
   void on_tickers_subscribed();
   void wait_for_messages();
   void interpret_generic_messages();
   void process_pushed_instruments_data(json::array_t const &);
-  void process_pushed_tickers_data(json::array_t const &);
+  void process_pushed_tickers_data(std::string_view, std::int64_t receivedAt);
   void ticker_subscribe();
   void report_error_and_retry(beast::error_code);
 
@@ -65,5 +63,7 @@ public:
   okex_price_stream_t(net::io_context &, net::ssl::context &, trade_type_e);
   ~okex_price_stream_t() = default;
   void run();
+  // handles a push, read off the websocket or replayed
+  void process_frame(std::string_view frame, std::int64_t receivedAt);
 };
 } // namespace keep_my_journal
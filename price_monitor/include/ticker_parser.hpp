@@ -0,0 +1,158 @@
+// Copyright (C) 2023-2024 Joshua and Jordan Ogunyinka
+#pragma once
+
+#include <cstdint>
+#include <string_view>
+
+#include "decimal.hpp"
+#include "enumerations.hpp"
+#include "price_stream/commodity.hpp"
+
+namespace keep_my_journal {
+namespace details {
+// a forward-only JSON reader over a websocket frame. It never builds a tree
+// and never allocates, every value it returns is a view into the frame.
+// Escape sequences inside strings are skipped over but not decoded, which is
+// fine for the symbols and prices exchanges send.
+class json_cursor_t {
+  char const *m_current;
+  char const *m_end;
+
+  void skip_whitespace();
+  bool skip_string();
+  bool skip_literal();
+  bool skip_container(char open, char close);
+
+public:
+  explicit json_cursor_t(std::string_view const view)
+      : m_current(view.data()), m_end(view.data() + view.size()) {}
+
+  bool consume(char ch);
+  bool peek(char ch);
+  bool read_string(std::string_view &value);
+  // strings are returned without their quotes, objects and arrays are
+  // returned as their raw span (brackets included) and other literals as-is
+  bool read_value(std::string_view &value);
+  bool skip_value();
+
+  // func(std::string_view key, json_cursor_t &) -> bool. The callback must
+  // consume the member's value (read or skip) and return false to abort.
+  template <typename Func> bool for_each_member(Func &&func) {
+    if (!consume('{'))
+      return false;
+    if (consume('}'))
+      return true;
+    do {
+      std::string_view key;
+      if (!read_string(key) || !consume(':') || !func(key, *this))
+        return false;
+    } while (consume(','));
+    return consume('}');
+  }
+
+  // func(json_cursor_t &) -> bool, same contract as `for_each_member`
+  template <typename Func> bool for_each_element(Func &&func) {
+    if (!consume('['))
+      return false;
+    if (consume(']'))
+      return true;
+    do {
+      if (!func(*this))
+        return false;
+    } while (consume(','));
+    return consume(']');
+  }
+};
+} // namespace details
+
+struct ticker_view_t {
+  std::string_view name;
+  std::string_view currentPrice;
+  std::string_view open24h;
+  std::string_view eventTime;
+};
+
+struct okex_frame_view_t {
+  std::string_view event;
+  std::string_view code;
+  std::string_view message;
+  std::string_view channel;
+  std::string_view data;
+};
+
+struct kucoin_ticker_view_t {
+  std::string_view subject;
+  std::string_view symbol;
+  std::string_view price;
+  std::string_view bestBidPrice;
+  std::string_view bestAskPrice;
+  std::string_view eventTime;
+};
+
+// prices are kept exactly as the exchange sent them, see `decimal_t`
+bool parse_price_string(std::string_view str, decimal_t &result);
+// exchanges stamp their events in milliseconds, KuCoin futures in
+// nanoseconds; `micros` is always in microseconds since the epoch
+bool parse_event_time(std::string_view str, std::int64_t &micros);
+// stamps a ticker from a frame read at `receivedAt` and records how long the
+// exchange took to get it to us
+void stamp_received(price_timestamps_t &timestamps, std::string_view eventTime,
+                    std::int64_t receivedAt);
+
+// Binance `!ticker@arr`:
+// [{"E": 1672515782136, "s": "BTCUSDT", "c": "...", "o": "..."}, ...]
+template <typename Func>
+bool parse_binance_tickers(std::string_view const frame, Func &&onTicker) {
+  details::json_cursor_t cursor(frame);
+  return cursor.for_each_element([&onTicker](details::json_cursor_t &element) {
+    ticker_view_t ticker;
+    bool const isValid = element.for_each_member(
+        [&ticker](std::string_view const key, details::json_cursor_t &c) {
+          if (key == "s")
+            return c.read_value(ticker.name);
+          if (key == "c")
+            return c.read_value(ticker.currentPrice);
+          if (key == "o")
+            return c.read_value(ticker.open24h);
+          if (key == "E")
+            return c.read_value(ticker.eventTime);
+          return c.skip_value();
+        });
+    if (isValid && !ticker.name.empty())
+      onTicker(ticker);
+    return isValid;
+  });
+}
+
+// splits an OKX push into its `event`/`code`/`msg`/`arg.channel` and the raw
+// `data` array; the array itself is walked by `parse_okex_tickers`
+bool parse_okex_frame(std::string_view frame, okex_frame_view_t &result);
+
+// OKX `tickers` data:
+// [{"instId": "BTC-USDT", "last": "...", "sodUtc8": "...", "ts": "..."}]
+template <typename Func>
+bool parse_okex_tickers(std::string_view const data, Func &&onTicker) {
+  details::json_cursor_t cursor(data);
+  return cursor.for_each_element([&onTicker](details::json_cursor_t &element) {
+    ticker_view_t ticker;
+    bool const isValid = element.for_each_member(
+        [&ticker](std::string_view const key, details::json_cursor_t &c) {
+          if (key == "instId")
+            return c.read_value(ticker.name);
+          if (key == "last")
+            return c.read_value(ticker.currentPrice);
+          if (key == "sodUtc8")
+            return c.read_value(ticker.open24h);
+          if (key == "ts")
+            return c.read_value(ticker.eventTime);
+          return c.skip_value();
+        });
+    if (isValid && !ticker.name.empty())
+      onTicker(ticker);
+    return isValid;
+  });
+}
+
+// KuCoin `/market/ticker:all` and `/contractMarket/tickerV2` pushes
+bool parse_kucoin_ticker(std::string_view frame, kucoin_ticker_view_t &result);
+} // namespace keep_my_journal
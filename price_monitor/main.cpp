@@ -4,89 +4,220 @@
 #define _CRT_SECURE_NO_WARNINGS
 #endif
 
+#include <CLI/CLI11.hpp>
 #include <boost/asio/io_context.hpp>
+#include <boost/asio/post.hpp>
 #include <boost/asio/signal_set.hpp>
 #include <boost/asio/ssl/context.hpp>
 
 #include <cstdlib>
 #include <filesystem>
 #include <iostream>
+#include <optional>
 #include <thread>
 
+#include "cli.hpp"
+#include "dns_cache.hpp"
+#include "frame_capture.hpp"
+#include "io_context_pool.hpp"
+#include "price_stream/instrument_sink.hpp"
+#include "websocket_connector.hpp"
+
+#ifdef CRYPTOLOG_USING_MSGPACK
+#include "price_stream/price_wire.hpp"
+#endif
+
 namespace net = boost::asio;
 namespace ssl = net::ssl;
 
 namespace keep_my_journal {
-// all functions here are implemented in each exchanges' price_stream source
-void binance_price_watcher(net::io_context &, ssl::context &);
-void okexchange_price_watcher(net::io_context &, ssl::context &);
-void kucoin_price_watcher(net::io_context &, ssl::context &);
+// all functions here are implemented in each exchanges' price_stream source,
+// given a replayer they hand it their streams instead of starting them
+void binance_price_watcher(io_context_pool_t &, ssl::context &,
+                           frame_replayer_t *);
+void okexchange_price_watcher(io_context_pool_t &, ssl::context &,
+                              frame_replayer_t *);
+void kucoin_price_watcher(io_context_pool_t &, ssl::context &,
+                          frame_replayer_t *);
 
 #ifdef CRYPTOLOG_USING_MSGPACK
-void start_prices_deposit_into_storage(bool &);
+void start_prices_deposit_into_storage(bool &, price_batch_config_t const &,
+                                       std::size_t);
 #endif
 
 } // namespace keep_my_journal
 
-int main() {
-  unsigned int const native_thread_size = std::thread::hardware_concurrency();
-  net::io_context ioContext((int)native_thread_size);
+int main(int argc, char *argv[]) {
+  using keep_my_journal::exchange_e;
+  using keep_my_journal::instrument_sink_t;
+  using keep_my_journal::io_threading_model_e;
+  using keep_my_journal::queue_overflow_policy_e;
+
+  CLI::App cli_parser{"streams the latest prices from the supported exchanges"};
+  keep_my_journal::command_line_interface_t args{};
+
+  std::map<std::string, queue_overflow_policy_e> const policies{
+      {"block", queue_overflow_policy_e::block},
+      {"drop_oldest", queue_overflow_policy_e::drop_oldest},
+      {"drop_newest", queue_overflow_policy_e::drop_newest}};
+  std::map<std::string, io_threading_model_e> const ioModels{
+      {"shared", io_threading_model_e::shared},
+      {"per_exchange", io_threading_model_e::per_exchange},
+      {"per_stream", io_threading_model_e::per_stream}};
+  cli_parser.add_option("-c,--queue-capacity", args.queue_capacity,
+                        "per-exchange price queue capacity, 0 is unbounded");
+  cli_parser
+      .add_option("-o,--overflow-policy", args.overflow_policy,
+                  "what to do when a bounded price queue is full")
+      ->transform(CLI::CheckedTransformer(policies, CLI::ignore_case));
+  cli_parser.add_flag("--conflate", args.conflate,
+                      "only publish the latest price of each instrument, "
+                      "ignores the queue capacity");
+  cli_parser
+      .add_option("--io-model", args.io_model,
+                  "one io_context for all streams, one per exchange or one "
+                  "per stream, each run on its own thread")
+      ->transform(CLI::CheckedTransformer(ioModels, CLI::ignore_case));
+  cli_parser.add_option("--io-threads", args.io_threads,
+                        "threads running the shared io_context");
+  cli_parser.add_option("--cpu-affinity", args.cpu_affinity,
+                        "CPUs to pin the io_context threads to, round-robin")
+      ->delimiter(',');
+  auto *captureOption =
+      cli_parser.add_option("--capture-file", args.capture_file,
+                            "append every websocket frame received to this "
+                            "(memory-mapped) capture file");
+  cli_parser
+      .add_option("--replay-file", args.replay_file,
+                  "feed the streams from this capture instead of connecting "
+                  "to the exchanges, then exit")
+      ->excludes(captureOption);
+  cli_parser.add_flag("--replay-max-speed", args.replay_max_speed,
+                      "replay as fast as possible, not at the recorded pace");
+  cli_parser.add_option("--replay-loops", args.replay_loops,
+                        "how many times the capture is replayed");
+  cli_parser.add_option("--host-override", args.host_overrides,
+                        "host=address:port, connect to address:port whenever "
+                        "host is asked for; '*' matches every host");
+  cli_parser.add_option("--ca-file", args.ca_file,
+                        "verify the exchanges' certificates against this CA "
+                        "file instead of the system's");
+  cli_parser.add_option("--batch-size", args.batch_size,
+                        "most price records sent in one frame to the "
+                        "subscribers, 1 sends each on its own");
+  cli_parser.add_option("--batch-interval-us", args.batch_interval_us,
+                        "microseconds a price record may wait for its frame "
+                        "to fill up");
+  cli_parser.add_option("--shared-table", args.shared_table_capacity,
+                        "also keep the latest prices in a /dev/shm table with "
+                        "room for this many instruments per exchange");
+  CLI11_PARSE(cli_parser, argc, argv)
+
+  auto &dnsCache = keep_my_journal::dns_cache_t::instance();
+  for (auto const &hostOverride : args.host_overrides) {
+    if (!dnsCache.add_override(hostOverride)) {
+      std::cerr << "invalid host override: " << hostOverride << std::endl;
+      return EXIT_FAILURE;
+    }
+  }
+
+  if (!args.capture_file.empty() &&
+      !keep_my_journal::frame_recorder_t::open(args.capture_file))
+    return EXIT_FAILURE;
+
+  // the sinks are created on first use, so this has to happen before any of
+  // the price streams is launched
+  instrument_sink_t::configure(
+      {args.queue_capacity, args.overflow_policy, args.conflate});
+
+  keep_my_journal::io_context_pool_t ioContextPool(
+      args.io_model, args.io_threads, args.cpu_affinity);
   ssl::context sslContext(ssl::context::tlsv12_client);
   sslContext.set_default_verify_paths();
   char const *dir = std::getenv(X509_get_default_cert_dir_env());
   if (!dir)
     dir = X509_get_default_cert_dir();
 
-  if (auto const verify_file = std::filesystem::path(dir) / "ca-bundle.crt";
-      dir && std::filesystem::exists(verify_file)) {
+  if (!args.ca_file.empty()) {
+    sslContext.set_verify_mode(ssl::verify_peer);
+    sslContext.load_verify_file(args.ca_file);
+  } else if (auto const verify_file =
+                 std::filesystem::path(dir) / "ca-bundle.crt";
+             dir && std::filesystem::exists(verify_file)) {
     sslContext.set_verify_mode(ssl::verify_peer);
     sslContext.load_verify_file(verify_file.string());
   } else {
     sslContext.set_verify_mode(ssl::verify_none);
   }
+  keep_my_journal::tls_session_cache_t::install(sslContext);
 
-  net::signal_set signalSet(ioContext, SIGTERM);
+  // signals are waited on here, away from the price streams' contexts
+  net::io_context signalContext(1);
+  net::signal_set signalSet(signalContext, SIGTERM);
   signalSet.add(SIGABRT);
   bool running = true;
 
   signalSet.async_wait(
-      [&ioContext, &running](boost::system::error_code const &error,
-                             int const signalNumber) {
-        if (!ioContext.stopped()) {
-          ioContext.stop();
-          running = false;
-        }
+      [&ioContextPool, &running](boost::system::error_code const &error,
+                                 int const signalNumber) {
+        ioContextPool.stop();
+        running = false;
       });
 
-  std::thread binanceWatcher{[&ioContext, &sslContext] {
-    keep_my_journal::binance_price_watcher(ioContext, sslContext);
-  }};
-
-  std::thread okWatcher{[&ioContext, &sslContext] {
-    keep_my_journal::okexchange_price_watcher(ioContext, sslContext);
-  }};
+  std::optional<keep_my_journal::frame_replayer_t> replayer;
+  if (!args.replay_file.empty())
+    replayer.emplace(args.replay_file, !args.replay_max_speed,
+                     args.replay_loops);
+  auto *const replayerPtr = replayer ? &*replayer : nullptr;
+
+  // the watchers only queue up the streams' first async operations, they
+  // run once the pool starts its threads
+  keep_my_journal::binance_price_watcher(ioContextPool, sslContext,
+                                         replayerPtr);
+  keep_my_journal::okexchange_price_watcher(ioContextPool, sslContext,
+                                            replayerPtr);
+  keep_my_journal::kucoin_price_watcher(ioContextPool, sslContext,
+                                        replayerPtr);
+  ioContextPool.run();
 
-  std::thread kucoinWatcher{[&ioContext, &sslContext] {
-    keep_my_journal::kucoin_price_watcher(ioContext, sslContext);
+#ifdef CRYPTOLOG_USING_MSGPACK
+  keep_my_journal::price_batch_config_t const batching{
+      args.batch_size, std::chrono::microseconds(args.batch_interval_us)};
+  std::thread dataTransmitter{[&running, &batching, &args] {
+    keep_my_journal::start_prices_deposit_into_storage(
+        running, batching, args.shared_table_capacity);
   }};
+#endif
 
+  std::thread replayThread;
+  if (replayer) {
+    replayThread = std::thread([&replayer, &running, &signalContext,
+                                &signalSet] {
+      replayer->run(running);
 #ifdef CRYPTOLOG_USING_MSGPACK
-  std::thread dataTransmitter{[&running] {
-    keep_my_journal::start_prices_deposit_into_storage(running);
-  }};
+      // let the publishers drain what's been replayed
+      for (std::size_t i = 0; i < (std::size_t)exchange_e::total; ++i) {
+        auto &sink = instrument_sink_t::get_all_listed_instruments(
+            static_cast<exchange_e>(i));
+        while (running && !sink.empty())
+          std::this_thread::sleep_for(std::chrono::milliseconds(10));
+      }
 #endif
+      // then stop, the same way a signal does
+      net::post(signalContext, [&signalSet] { signalSet.cancel(); });
+    });
+  }
 
-  // wait a bit for all tasks to start up and have async "actions" lined up
-  binanceWatcher.join();
-  okWatcher.join();
-  kucoinWatcher.join();
+  signalContext.run();
+  ioContextPool.join();
+  if (replayThread.joinable())
+    replayThread.join();
+  keep_my_journal::frame_recorder_t::close();
 
 #ifdef CRYPTOLOG_USING_MSGPACK
   dataTransmitter.join();
 #endif
 
-  ioContext.run();
-
   std::cout << "Done running stuff..." << std::endl;
   return EXIT_SUCCESS;
 }
@@ -1,7 +1,11 @@
 // Copyright (C) 2023 Joshua and Jordan Ogunyinka
 #include "binance_price_stream.hpp"
 #include "crypto_utils.hpp"
+#include "frame_capture.hpp"
 #include "https_rest_client.hpp"
+#include "io_context_pool.hpp"
+#include "latency_histogram.hpp"
+#include "ticker_parser.hpp"
 #include <spdlog/spdlog.h>
 
 namespace keep_my_journal {
@@ -27,22 +31,25 @@ binance_price_stream_t::binance_price_stream_t(net::io_context &ioContext,
       m_sslContext{sslContext},
       m_tradedInstruments(
           instrument_sink_t::get_all_listed_instruments(exchange_e::binance)),
-      m_tradeType(tradeType), m_resolver{}, m_sslWebStream{} {}
+      m_symbols(symbol_registry_t::get(exchange_e::binance)),
+      m_tradeType(tradeType), m_sslWebStream{},
+      m_reconnect(ioContext, fmt::format("Binance -> '{}'", ws_host)) {}
 
 void binance_price_stream_t::run() { rest_api_initiate_connection(); }
 
 void binance_price_stream_t::rest_api_initiate_connection() {
-  m_resolver.emplace(m_ioContext);
   m_sslWebStream.emplace(m_ioContext, m_sslContext);
 
   m_httpClient = std::make_unique<https_rest_api_t>(
-      m_ioContext, m_sslContext, m_sslWebStream->next_layer(), *m_resolver,
+      m_ioContext, m_sslContext, m_sslWebStream->next_layer(),
       m_restApiHost, "https", rest_api_get_target());
 
   auto onError = [self =
                       shared_from_this()](beast::error_code const errorCode) {
     spdlog::error("Binance -> '{}' gave this error: {}", self->m_restApiHost,
                   errorCode.message());
+    self->m_reconnect.schedule(
+        [self] { self->rest_api_initiate_connection(); });
   };
 
   auto onSuccess = [self = shared_from_this()](std::string const &data) {
@@ -66,73 +73,7 @@ void binance_price_stream_t::rest_api_on_data_received(
 
 void binance_price_stream_t::initiate_websocket_connection() {
   m_httpClient.reset();
-  m_resolver.emplace(m_ioContext);
-
-  m_resolver->async_resolve(
-      m_wsHostname, m_wsPortNumber,
-      [self = shared_from_this()](
-          auto const error_code,
-          net::ip::tcp::resolver::results_type const &results) {
-        if (error_code) {
-          return spdlog::error(error_code.message());
-        }
-        self->websocket_connect_to_resolved_names(results);
-      });
-}
-
-void binance_price_stream_t::websocket_connect_to_resolved_names(
-    results_type const &resolved_names) {
-  m_resolver.reset();
   m_sslWebStream.emplace(m_ioContext, m_sslContext);
-  beast::get_lowest_layer(*m_sslWebStream)
-      .expires_after(std::chrono::seconds(30));
-
-  beast::get_lowest_layer(*m_sslWebStream)
-      .async_connect(
-          resolved_names,
-          [self = shared_from_this()](
-              auto const error_code,
-              net::ip::tcp::resolver::results_type::endpoint_type const
-                  &connected_name) {
-            if (error_code) {
-              return spdlog::error(error_code.message());
-            }
-            self->websocket_perform_ssl_handshake(connected_name);
-          });
-}
-
-void binance_price_stream_t::websocket_perform_ssl_handshake(
-    results_type::endpoint_type const &ep) {
-  auto const host = fmt::format("{}:{}", m_wsHostname, ep.port());
-
-  // Set a timeout on the operation
-  beast::get_lowest_layer(*m_sslWebStream)
-      .expires_after(std::chrono::seconds(30));
-
-  // Set SNI Hostname (many hosts need this to handshake successfully)
-  if (!SSL_set_tlsext_host_name(m_sslWebStream->next_layer().native_handle(),
-                                host.c_str())) {
-    auto const ec = beast::error_code(static_cast<int>(::ERR_get_error()),
-                                      net::error::get_ssl_category());
-    return spdlog::error(ec.message());
-  }
-  negotiate_websocket_connection();
-}
-
-void binance_price_stream_t::negotiate_websocket_connection() {
-  m_sslWebStream->next_layer().async_handshake(
-      net::ssl::stream_base::client,
-      [self = shared_from_this()](beast::error_code const ec) {
-        if (ec) {
-          return spdlog::error(ec.message());
-        }
-        beast::get_lowest_layer(*self->m_sslWebStream).expires_never();
-        return self->perform_websocket_handshake();
-      });
-}
-
-void binance_price_stream_t::perform_websocket_handshake() {
-  static auto const binance_handshake_path = "/ws/!ticker@arr";
 
   auto opt = websock::stream_base::timeout();
   opt.idle_timeout = std::chrono::seconds(20);
@@ -140,21 +81,13 @@ void binance_price_stream_t::perform_websocket_handshake() {
   opt.keep_alive_pings = true;
   m_sslWebStream->set_option(opt);
 
-  m_sslWebStream->control_callback(
-      [self = shared_from_this()](auto const frame_type, auto const &) {
-        if (frame_type == websock::frame_type::close) {
-          self->m_sslWebStream.reset();
-          return self->initiate_websocket_connection();
-        }
-      });
-
-  m_sslWebStream->async_handshake(
-      m_wsHostname, binance_handshake_path,
-      [self = shared_from_this()](beast::error_code const ec) {
-        if (ec) {
-          return spdlog::error(ec.message());
-        }
+  websocket_connector_t::connect(
+      *m_sslWebStream, {m_wsHostname, m_wsPortNumber, "/ws/!ticker@arr"},
+      [self = shared_from_this()](beast::error_code const &ec) {
+        if (ec)
+          return self->report_error_and_retry(ec);
 
+        self->m_reconnect.on_connected();
         self->wait_for_messages();
       });
 }
@@ -164,53 +97,73 @@ void binance_price_stream_t::wait_for_messages() {
   m_sslWebStream->async_read(
       *m_buffer, [self = shared_from_this()](beast::error_code const error_code,
                                              std::size_t const) {
-        if (error_code == net::error::operation_aborted) {
+        // a close frame from the server also ends up here, as
+        // websocket::error::closed
+        if (error_code == net::error::operation_aborted)
           return spdlog::error(error_code.message());
-        } else if (error_code) {
-          spdlog::error(error_code.message());
-          self->m_sslWebStream.reset();
-          return self->initiate_websocket_connection();
-        }
+        else if (error_code)
+          return self->report_error_and_retry(error_code);
         self->interpret_generic_messages();
       });
 }
 
+void binance_price_stream_t::report_error_and_retry(
+    beast::error_code const ec) {
+  spdlog::error(ec.message());
+  m_sslWebStream.reset();
+  m_reconnect.schedule(
+      [self = shared_from_this()] { self->initiate_websocket_connection(); });
+}
+
 void binance_price_stream_t::process_pushed_instruments_data(
     json::array_t const &data_list) {
+  std::vector<price_record_t> records;
+  records.reserve(data_list.size());
+
   for (auto const &data_json : data_list) {
     auto const data_object = data_json.get<json::object_t>();
-    instrument_type_t instrument{};
-    instrument.name = data_object.at("symbol").get<json::string_t>();
-    instrument.tradeType = m_tradeType;
-    m_tradedInstruments.append(std::move(instrument));
+    price_record_t record{};
+    record.id = m_symbols.intern(
+        m_tradeType, data_object.at("symbol").get<json::string_t>());
+    records.push_back(record);
   }
+  m_tradedInstruments.append_list(std::move(records));
 }
 
 void binance_price_stream_t::interpret_generic_messages() {
+  auto const receivedAt = micros_since_epoch();
   char const *buffer_cstr = static_cast<char const *>(m_buffer->cdata().data());
   std::string_view const buffer(buffer_cstr, m_buffer->size());
 
-  try {
-    process_pushed_tickers_data(json::parse(buffer).get<json::array_t>());
-  } catch (std::exception const &e) {
-    spdlog::error(e.what());
-  }
-
+  capture_frame(exchange_e::binance, m_tradeType, receivedAt, buffer);
+  process_frame(buffer, receivedAt);
   return wait_for_messages();
 }
 
-void binance_price_stream_t::process_pushed_tickers_data(
-    json::array_t const &data_list) {
-  for (auto const &data_json : data_list) {
-    instrument_type_t data{};
-    auto const data_object = data_json.get<json::object_t>();
+void binance_price_stream_t::process_frame(std::string_view const frame,
+                                           std::int64_t const receivedAt) {
+  // the whole frame is published in one go, so the sink's lock is taken once
+  // per frame rather than once per ticker
+  std::vector<price_record_t> records;
+  records.reserve(m_lastFrameSize);
+
+  auto onTicker = [this, &records, receivedAt](ticker_view_t const &ticker) {
+    price_record_t data{};
+    if (!parse_price_string(ticker.currentPrice, data.currentPrice) ||
+        !parse_price_string(ticker.open24h, data.open24h))
+      return;
     // symbol => BTCDOGE, DOGEUSDT etc
-    data.name = data_object.at("s").get<json::string_t>();
-    data.currentPrice = std::stod(data_object.at("c").get<json::string_t>());
-    data.open24h = std::stod(data_object.at("o").get<json::string_t>());
-    data.tradeType = m_tradeType;
-    m_tradedInstruments.append(std::move(data));
-  }
+    data.id = m_symbols.intern(m_tradeType, ticker.name);
+    stamp_received(data.timestamps, ticker.eventTime, receivedAt);
+    records.push_back(data);
+  };
+
+  if (!parse_binance_tickers(frame, onTicker))
+    spdlog::error("Binance: malformed ticker frame of size {}", frame.size());
+
+  m_lastFrameSize = records.size();
+  if (!records.empty())
+    m_tradedInstruments.append_list(std::move(records));
 }
 
 // ===========================================================
@@ -228,16 +181,22 @@ binance_futures_price_stream_t::binance_futures_price_stream_t(
 
 // ===========================================================
 
-void binance_price_watcher(net::io_context &io_context,
-                           net::ssl::context &ssl_context) {
-  auto spot =
-      std::make_shared<binance_spot_price_stream_t>(io_context, ssl_context);
-  auto futures =
-      std::make_shared<binance_futures_price_stream_t>(io_context, ssl_context);
+void binance_price_watcher(io_context_pool_t &pool,
+                           net::ssl::context &ssl_context,
+                           frame_replayer_t *replayer) {
+  auto spot = std::make_shared<binance_spot_price_stream_t>(
+      pool.get(exchange_e::binance, trade_type_e::spot), ssl_context);
+  auto futures = std::make_shared<binance_futures_price_stream_t>(
+      pool.get(exchange_e::binance, trade_type_e::futures), ssl_context);
+
+  if (replayer) {
+    replayer->add_stream(exchange_e::binance, trade_type_e::spot, spot);
+    replayer->add_stream(exchange_e::binance, trade_type_e::futures, futures);
+    return;
+  }
 
   spot->run();
   futures->run();
-  io_context.run();
 }
 
 } // namespace keep_my_journal
@@ -1,14 +1,24 @@
 // Copyright (C) 2023 Joshua & Jordan Ogunyinka
 
+#include <algorithm>
+#include <array>
+#include <chrono>
 #include <cppzmq/zmq.hpp>
 #include <filesystem>
+#include <map>
 #include <msgpack.hpp>
 #include <thread>
 
+#include "allocation_counter.hpp"
+#include "latency_histogram.hpp"
 #include "macro_defines.hpp"
-#include "price_stream/commodity.hpp"
+#include "price_stream/instrument_sink.hpp"
+#include "price_stream/price_wire.hpp"
+#include "price_stream/shared_price_table.hpp"
+#include "price_stream/symbol_registry.hpp"
 #include "spdlog/spdlog.h"
 #include "string_utils.hpp"
+#include "zmq_buffer.hpp"
 
 namespace keep_my_journal {
 namespace utils {
@@ -16,59 +26,461 @@ bool validate_address_paradigm(char const *address);
 }
 
 void store_exchanges_price_into_storage(zmq::context_t &context, bool &running,
-                                        exchange_e const exchange) {
+                                        exchange_e const exchange,
+                                        price_batch_config_t const &batching,
+                                        shared_price_table_t *sharedTable) {
   auto const filename = utils::exchangesToString(exchange);
   auto const address =
       fmt::format("ipc://{}/{}", PRICE_MONITOR_STREAM_DEPOSIT_PATH, filename);
   spdlog::info("The address is {}", address);
   auto &instruments = instrument_sink_t::get_all_listed_instruments(exchange);
 
+  auto &symbols = symbol_registry_t::get(exchange);
+
   zmq::socket_t senderSocket{context, zmq::socket_type::xpub};
+  zmq::socket_t snapshotSocket{context, zmq::socket_type::rep};
   try {
+    // pass every subscription and unsubscription up, not just the first and
+    // last for a given topic, so that each new subscriber is sent the symbol
+    // mappings and the topics' subscribers can be counted
+    senderSocket.set(zmq::sockopt::xpub_verboser, 1);
     senderSocket.bind(address);
+    snapshotSocket.bind(fmt::format("{}{}", address, price_snapshot_suffix));
   } catch (zmq::error_t const &e) {
     spdlog::error(e.what());
     throw;
   }
 
   msgpack::sbuffer serialBuffer;
+  // records taken off the sink but not yet sent, the oldest was taken at
+  // `firstPendingTime`
+  std::vector<price_record_t> pendingRecords;
+  auto firstPendingTime = std::chrono::steady_clock::now();
+  auto const maxRecords = std::clamp<std::size_t>(batching.maxRecords, 1,
+                                                  price_binary_max_records);
+  // the binary feed's deltas are against what it last sent of each symbol
+  price_binary_encoder_t binaryEncoder;
+  auto const binaryTopicAll =
+      price_topic_in(price_wire_format_e::binary, price_topic_all);
+  // records are numbered from the time price_monitor started, so a
+  // restarted one carries on from higher numbers than its subscribers saw
+  auto feedSequence = static_cast<std::uint64_t>(micros_since_epoch());
+  // the latest record of every id, for the snapshots
+  std::vector<price_record_t> latestRecords;
+  price_snapshot_t snapshot;
+  std::vector<std::string> snapshotTopics;
+  msgpack_reader_t snapshotReader;
+  std::size_t publishedSymbols = 0;
+  std::size_t tabledSymbols = 0;
+  // subscribers per topic; an instrument's own topic, indexed by its id, and
+  // the formats in which a subscription is a prefix of it, a bit each
+  std::map<std::string, std::size_t, std::less<>> subscriptions;
+  std::vector<std::string> symbolTopics;
+  std::vector<std::uint8_t> watchedFormats;
+  // instruments' topics, or prefixes of them, subscribed to this turn
+  std::vector<std::string> newSymbolSubscriptions;
+  std::size_t sentFrames = 0;
+  std::size_t sentRecords = 0;
+  utils::ring_buffer_stats_t lastStats{};
+  auto lastStatsReport = std::chrono::steady_clock::now();
 
-  while (running) {
-    auto instrument = instruments.get();
-    msgpack::pack(serialBuffer, instrument);
+  allocation_stats_t allocationStats(
+      fmt::format("price_monitor {} publisher", filename));
 
-    std::string_view view(serialBuffer.data(), serialBuffer.size());
-    zmq::message_t message(view);
+  // the packed buffer is handed to zmq as it is, not copied. The topic is
+  // `topic` behind the format's `prefix`, if any.
+  auto sendBuffer = [&senderSocket, &serialBuffer, &allocationStats](
+                        std::string_view const prefix,
+                        std::string_view const topic) {
+    zmq::message_t topicMessage(prefix.size() + topic.size());
+    std::copy(prefix.begin(), prefix.end(), topicMessage.data<char>());
+    std::copy(topic.begin(), topic.end(),
+              topicMessage.data<char>() + prefix.size());
+    auto message = release_to_message(serialBuffer);
+    senderSocket.send(topicMessage, zmq::send_flags::sndmore);
     auto const optSize = senderSocket.send(message, zmq::send_flags::none);
-    if (!optSize.has_value()) {
+
+    if (!optSize.has_value())
       spdlog::error("Unable to send message...");
-      continue;
+    allocationStats.messages_done();
+  };
+
+  auto subscribersOf = [&subscriptions](std::string_view const topic) {
+    auto const iter = subscriptions.find(topic);
+    return iter == subscriptions.end() ? std::size_t{} : iter->second;
+  };
+
+  constexpr std::array<price_wire_format_e, 2> formats{
+      price_wire_format_e::msgpack, price_wire_format_e::binary};
+  auto formatPrefix = [](price_wire_format_e const format) {
+    return format == price_wire_format_e::binary ? price_topic_binary_prefix
+                                                 : std::string_view{};
+  };
+  auto formatBit = [](price_wire_format_e const format) {
+    return static_cast<std::uint8_t>(1u << static_cast<unsigned>(format));
+  };
+
+  // the formats in which someone subscribes to a prefix of `topic`
+  auto topicWatchers = [&](std::string_view const topic) {
+    std::uint8_t result = 0;
+    for (auto const format : formats) {
+      auto const prefix = formatPrefix(format);
+      auto const symbolsPrefix =
+          std::string(prefix).append(price_topic_prefix);
+      // only the per-instrument subscriptions are prefixes worth checking
+      for (auto iter = subscriptions.lower_bound(symbolsPrefix);
+           iter != subscriptions.end() &&
+           iter->first.compare(0, symbolsPrefix.size(), symbolsPrefix) == 0;
+           ++iter) {
+        auto const watched =
+            std::string_view(iter->first).substr(prefix.size());
+        if (topic.compare(0, watched.size(), watched) == 0) {
+          result |= formatBit(format);
+          break;
+        }
+      }
+    }
+    return result;
+  };
+
+  auto isSymbolTopic = [](std::string_view topic) {
+    if (topic.compare(0, price_topic_binary_prefix.size(),
+                      price_topic_binary_prefix) == 0)
+      topic.remove_prefix(price_topic_binary_prefix.size());
+    return topic.compare(0, price_topic_prefix.size(), price_topic_prefix) ==
+           0;
+  };
+
+  // catches the topics up with newly interned symbols, and re-evaluates
+  // all of them when the subscriptions changed
+  auto updateWatchedTopics = [&](bool const subscriptionsChanged) {
+    auto const firstNew = symbolTopics.size();
+    for (auto const &mapping : symbols.symbols_from(
+             static_cast<instrument_id_t>(symbolTopics.size()))) {
+      symbolTopics.push_back(
+          price_topic(exchange, mapping.tradeType, mapping.name));
+    }
+
+    watchedFormats.resize(symbolTopics.size());
+    for (auto id = subscriptionsChanged ? 0 : firstNew;
+         id < watchedFormats.size(); ++id)
+      watchedFormats[id] = topicWatchers(symbolTopics[id]);
+  };
+
+  // sends `count` pending records from `first` as one frame, stamped now
+  auto sendRecords = [&](std::size_t const first, std::size_t const count) {
+    auto const published = micros_since_epoch();
+    for (std::size_t i = first; i < first + count; ++i) {
+      auto &timestamps = pendingRecords[i].timestamps;
+      timestamps.published = published;
+      latency_stats_t::record(latency_stage_e::receive_to_publish,
+                              timestamps.received, timestamps.published);
+    }
+
+    if (subscribersOf(price_topic_all) != 0) {
+      if (count == 1)
+        pack_price_record(serialBuffer, pendingRecords[first]);
+      else
+        pack_price_batch(serialBuffer, pendingRecords.data() + first, count);
+      sendBuffer({}, price_topic_all);
+    }
+    if (subscribersOf(binaryTopicAll) != 0) {
+      try {
+        binaryEncoder.encode_batch(serialBuffer,
+                                   pendingRecords.data() + first, count);
+        sendBuffer({}, binaryTopicAll);
+      } catch (std::range_error const &e) {
+        spdlog::error("{}: binary frame not sent, {}", filename, e.what());
+      }
+    }
+    ++sentFrames;
+    sentRecords += count;
+  };
+
+  // replies the latest record of the symbols whose topic starts with one
+  // of those asked for, of every symbol if none are
+  auto sendSnapshot = [&](std::string_view const request) {
+    snapshot.sequence = feedSequence;
+    snapshot.mappings.clear();
+    snapshot.records.clear();
+    bool isValid = true;
+    try {
+      snapshotReader.read(request, snapshotTopics);
+    } catch (std::exception const &e) {
+      spdlog::error("{}: bad snapshot request, {}", filename, e.what());
+      isValid = false;
+    }
+
+    auto const published = micros_since_epoch();
+    for (std::size_t id = 0; isValid && id < latestRecords.size(); ++id) {
+      auto const &record = latestRecords[id];
+      if (record.sequence == 0 || id >= symbolTopics.size())
+        continue;
+      std::string_view const topic = symbolTopics[id];
+      if (!snapshotTopics.empty() &&
+          std::none_of(snapshotTopics.begin(), snapshotTopics.end(),
+                       [topic](std::string const &wanted) {
+                         return topic.substr(0, wanted.size()) == wanted;
+                       }))
+        continue;
+
+      auto const *mapping =
+          symbols.find_symbol(static_cast<instrument_id_t>(id));
+      if (!mapping)
+        continue;
+      snapshot.mappings.push_back(*mapping);
+      snapshot.records.push_back(record);
+      snapshot.records.back().timestamps.published = published;
+    }
+
+    pack_price_snapshot(serialBuffer, snapshot);
+    auto message = release_to_message(serialBuffer);
+    if (!snapshotSocket.send(message, zmq::send_flags::none).has_value())
+      spdlog::error("Unable to send the snapshot...");
+  };
+
+  // sends the latest record of every symbol whose topic starts with
+  // `subscribed`, in its format, on the symbol's own topic. Sent after the
+  // subscription came in, it's the price a new subscriber starts from, and
+  // the stream carries on from it with nothing missed in between. Those
+  // already subscribed drop it as a repeat.
+  auto sendLatestRecords = [&](std::string_view subscribed) {
+    auto const isBinary =
+        subscribed.compare(0, price_topic_binary_prefix.size(),
+                           price_topic_binary_prefix) == 0;
+    if (isBinary)
+      subscribed.remove_prefix(price_topic_binary_prefix.size());
+
+    auto const published = micros_since_epoch();
+    auto const count = std::min(latestRecords.size(), symbolTopics.size());
+    for (std::size_t id = 0; id < count; ++id) {
+      auto record = latestRecords[id];
+      if (record.sequence == 0 ||
+          symbolTopics[id].compare(0, subscribed.size(), subscribed) != 0)
+        continue;
+
+      record.timestamps.published = published;
+      if (isBinary) {
+        if (price_binary_encoder_t::encode_record(serialBuffer, record))
+          sendBuffer(price_topic_binary_prefix, symbolTopics[id]);
+      } else {
+        pack_price_record(serialBuffer, record);
+        sendBuffer({}, symbolTopics[id]);
+      }
     }
+  };
 
-    serialBuffer.clear();
+  // the shared table gets every price as soon as it's taken off the sink,
+  // batching only delays what goes out on zmq
+  auto writeSharedTable = [&](std::size_t const first) {
+    auto const capacity = sharedTable->capacity();
+    if (auto const count = symbols.size();
+        count > tabledSymbols && tabledSymbols < capacity) {
+      auto const mappings =
+          symbols.symbols_from(static_cast<instrument_id_t>(tabledSymbols));
+      for (auto const &mapping : mappings) {
+        // every symbol from here on is left out, readers of the table fall
+        // back to not finding them
+        if (mapping.id >= capacity) {
+          spdlog::error("{}: the shared price table is full at {} symbols, "
+                        "{} and those after it are not in it; raise "
+                        "--shared-table",
+                        filename, capacity, mapping.name);
+          break;
+        }
+        // a name too long for a slot still takes its id's slot
+        if (!sharedTable->add_symbol(mapping))
+          spdlog::warn("{}: {} is not in the shared price table", filename,
+                       mapping.name);
+        ++tabledSymbols;
+      }
+    }
+
+    auto const written = micros_since_epoch();
+    for (std::size_t i = first; i < pendingRecords.size(); ++i) {
+      auto record = pendingRecords[i];
+      record.timestamps.published = written;
+      sharedTable->write(record);
+    }
+  };
+
+  while (running) {
+    auto const alreadyPending = pendingRecords.size();
+    if (pendingRecords.empty()) {
+      // take everything the streams have queued in one go
+      instruments.get_all(pendingRecords);
+      firstPendingTime = std::chrono::steady_clock::now();
+    } else if (!instruments.empty()) {
+      // a batch is filling up: top it up without blocking
+      instruments.get_all(pendingRecords);
+    } else {
+      auto const waited = std::chrono::steady_clock::now() - firstPendingTime;
+      if (waited < batching.maxDelay)
+        std::this_thread::sleep_for(std::min<std::chrono::microseconds>(
+            std::chrono::duration_cast<std::chrono::microseconds>(
+                batching.maxDelay - waited),
+            std::chrono::microseconds(20)));
+    }
+    for (std::size_t i = alreadyPending; i < pendingRecords.size(); ++i) {
+      auto &record = pendingRecords[i];
+      record.sequence = ++feedSequence;
+      if (record.id >= latestRecords.size())
+        latestRecords.resize(record.id + 1);
+      latestRecords[record.id] = record;
+    }
+    if (sharedTable && pendingRecords.size() != alreadyPending)
+      writeSharedTable(alreadyPending);
+
+    bool subscriptionsChanged = false;
+    zmq::message_t subscription;
+    while (senderSocket.recv(subscription, zmq::recv_flags::dontwait)) {
+      if (subscription.size() == 0)
+        continue;
+
+      // first byte is 1 for a subscription, 0 for an unsubscription
+      auto const topic = subscription.to_string_view().substr(1);
+      if (subscription.data<char>()[0] == 1) {
+        ++subscriptions[std::string(topic)];
+        if (topic == price_topic_mappings)
+          publishedSymbols = 0;
+        // a new subscriber has nothing to apply deltas to
+        if (topic == binaryTopicAll)
+          binaryEncoder.reset();
+        if (isSymbolTopic(topic))
+          newSymbolSubscriptions.emplace_back(topic);
+      } else if (auto iter = subscriptions.find(topic);
+                 iter != subscriptions.end() && --iter->second == 0) {
+        subscriptions.erase(iter);
+      }
+      subscriptionsChanged = subscriptionsChanged || isSymbolTopic(topic);
+    }
+
+    // every id in `pendingRecords` was interned before it was queued, so
+    // the mappings always go out ahead of the prices that use them
+    if (symbols.size() > publishedSymbols) {
+      auto const mappings =
+          symbols.symbols_from(static_cast<instrument_id_t>(publishedSymbols));
+      publishedSymbols += mappings.size();
+      pack_symbol_mappings(serialBuffer, mappings);
+      sendBuffer({}, price_topic_mappings);
+    }
+
+    // a watched instrument's prices go out on its own topic as soon as
+    // they're taken, a message each
+    if (subscriptionsChanged || symbols.size() > symbolTopics.size())
+      updateWatchedTopics(subscriptionsChanged);
+    for (auto const &subscribed : newSymbolSubscriptions)
+      sendLatestRecords(subscribed);
+    newSymbolSubscriptions.clear();
+
+    // answered between two sends, so the stream carries on from the
+    // snapshot's sequence
+    zmq::message_t snapshotRequest;
+    while (snapshotSocket.recv(snapshotRequest, zmq::recv_flags::dontwait))
+      sendSnapshot(snapshotRequest.to_string_view());
+
+    for (std::size_t i = alreadyPending; i < pendingRecords.size(); ++i) {
+      auto record = pendingRecords[i];
+      auto const watchers =
+          record.id < watchedFormats.size() ? watchedFormats[record.id] : 0;
+      if (watchers == 0)
+        continue;
+
+      record.timestamps.published = micros_since_epoch();
+      if (watchers & formatBit(price_wire_format_e::msgpack)) {
+        pack_price_record(serialBuffer, record);
+        sendBuffer({}, symbolTopics[record.id]);
+      }
+      if ((watchers & formatBit(price_wire_format_e::binary)) &&
+          price_binary_encoder_t::encode_record(serialBuffer, record))
+        sendBuffer(price_topic_binary_prefix, symbolTopics[record.id]);
+    }
+
+    // no one is taking the whole feed, there's no point batching it
+    if (subscribersOf(price_topic_all) == 0 &&
+        subscribersOf(binaryTopicAll) == 0)
+      pendingRecords.clear();
+
+    // full batches go straight away, what's left waits for more records
+    // until the oldest of them has waited `maxDelay`
+    std::size_t sent = 0;
+    for (; pendingRecords.size() - sent >= maxRecords; sent += maxRecords)
+      sendRecords(sent, maxRecords);
+    if (sent != pendingRecords.size() &&
+        (std::chrono::steady_clock::now() - firstPendingTime >=
+             batching.maxDelay ||
+         !running)) {
+      sendRecords(sent, pendingRecords.size() - sent);
+      sent = pendingRecords.size();
+    }
+    pendingRecords.erase(pendingRecords.begin(),
+                         pendingRecords.begin() + (std::ptrdiff_t)sent);
+    latency_stats_t::report_every(std::chrono::seconds(30));
+
+    if (auto const now = std::chrono::steady_clock::now();
+        now - lastStatsReport >= std::chrono::seconds(30)) {
+      lastStatsReport = now;
+      if (sentFrames != 0) {
+        spdlog::info("{}: {} records in {} frames, {:.1f} per frame",
+                     filename, sentRecords, sentFrames,
+                     static_cast<double>(sentRecords) /
+                         static_cast<double>(sentFrames));
+        sentFrames = sentRecords = 0;
+      }
+      if (auto const stats = instruments.stats();
+          stats.droppedOldest != lastStats.droppedOldest ||
+          stats.droppedNewest != lastStats.droppedNewest ||
+          stats.blocked != lastStats.blocked) {
+        spdlog::warn("{}: sink overflowed, dropped oldest: {}, dropped "
+                     "newest: {}, producers blocked: {}",
+                     filename, stats.droppedOldest - lastStats.droppedOldest,
+                     stats.droppedNewest - lastStats.droppedNewest,
+                     stats.blocked - lastStats.blocked);
+        lastStats = stats;
+      }
+    }
   }
 
   spdlog::info("Closing/unbinding socket...");
+  snapshotSocket.close();
   senderSocket.close();
 }
 
-void start_prices_deposit_into_storage(bool &running) {
+void start_prices_deposit_into_storage(bool &running,
+                                       price_batch_config_t const &batching,
+                                       std::size_t const sharedTableCapacity) {
   if (!utils::validate_address_paradigm(PRICE_MONITOR_STREAM_DEPOSIT_PATH))
     return;
 
+  // one table per exchange, unlinked again when price_monitor exits
+  constexpr auto exchange_count = static_cast<std::size_t>(exchange_e::total);
+  std::array<std::unique_ptr<shared_price_table_t>, exchange_count>
+      sharedTables{};
+  if (sharedTableCapacity != 0) {
+    for (std::size_t i = 0; i < exchange_count; ++i)
+      sharedTables[i] = shared_price_table_t::create(
+          static_cast<exchange_e>(i), sharedTableCapacity);
+  }
+  auto tableOf = [&sharedTables](exchange_e const exchange) {
+    return sharedTables[static_cast<std::size_t>(exchange)].get();
+  };
+
   int const threadCount = (int)std::thread::hardware_concurrency();
   zmq::context_t context{threadCount};
 
-  std::thread binanceDataSender{[&context, &running] {
-    store_exchanges_price_into_storage(context, running, exchange_e::binance);
+  std::thread binanceDataSender{[&context, &running, &batching, &tableOf] {
+    store_exchanges_price_into_storage(context, running, exchange_e::binance,
+                                       batching, tableOf(exchange_e::binance));
   }};
 
-  std::thread kucoinDataSender{[&context, &running] {
-    store_exchanges_price_into_storage(context, running, exchange_e::kucoin);
+  std::thread kucoinDataSender{[&context, &running, &batching, &tableOf] {
+    store_exchanges_price_into_storage(context, running, exchange_e::kucoin,
+                                       batching, tableOf(exchange_e::kucoin));
   }};
 
-  std::thread okDataSender{[&context, &running] {
-    store_exchanges_price_into_storage(context, running, exchange_e::okex);
+  std::thread okDataSender{[&context, &running, &batching, &tableOf] {
+    store_exchanges_price_into_storage(context, running, exchange_e::okex,
+                                       batching, tableOf(exchange_e::okex));
   }};
 
   binanceDataSender.join();
@@ -0,0 +1,210 @@
+// Copyright (C) 2023-2024 Joshua and Jordan Ogunyinka
+
+#include "frame_capture.hpp"
+
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+#include <algorithm>
+#include <cerrno>
+#include <chrono>
+#include <cstring>
+#include <spdlog/spdlog.h>
+#include <thread>
+
+#include "latency_histogram.hpp"
+
+namespace keep_my_journal {
+namespace {
+constexpr std::size_t capture_chunk_size = 64 * 1024 * 1024;
+
+constexpr std::size_t padded(std::size_t const size) {
+  return (size + 7) & ~std::size_t(7);
+}
+} // namespace
+
+std::unique_ptr<frame_recorder_t> &frame_recorder_t::instance() {
+  static std::unique_ptr<frame_recorder_t> recorder = nullptr;
+  return recorder;
+}
+
+bool frame_recorder_t::open(std::string const &path) {
+  int const fd = ::open(path.c_str(), O_RDWR | O_CREAT | O_TRUNC, 0644);
+  if (fd == -1) {
+    spdlog::error("Unable to open capture file {}: {}", path,
+                  std::strerror(errno));
+    return false;
+  }
+
+  std::unique_ptr<frame_recorder_t> recorder(new frame_recorder_t(fd, path));
+  if (!recorder->map_chunk(sizeof(capture_magic)))
+    return false;
+
+  std::memcpy(recorder->m_map, capture_magic, sizeof(capture_magic));
+  recorder->m_offset = sizeof(capture_magic);
+  instance() = std::move(recorder);
+  spdlog::info("Capturing every websocket frame into {}", path);
+  return true;
+}
+
+frame_recorder_t::frame_recorder_t(int const fd, std::string path)
+    : m_path(std::move(path)), m_fd(fd) {}
+
+void frame_recorder_t::close() {
+  if (auto &recorder = instance(); recorder) {
+    spdlog::info("Captured {} bytes into {}", recorder->m_offset,
+                 recorder->m_path);
+    recorder.reset();
+  }
+}
+
+// this may run as late as static destruction, so it doesn't log
+frame_recorder_t::~frame_recorder_t() {
+  if (m_map)
+    ::munmap(m_map, m_mappedSize);
+  // drop the unused tail of the last chunk
+  [[maybe_unused]] auto const result = ::ftruncate(m_fd, (off_t)m_offset);
+  ::close(m_fd);
+}
+
+// grows the file by whole chunks until `minimumSize` bytes fit, and maps all
+// of it again
+bool frame_recorder_t::map_chunk(std::size_t const minimumSize) {
+  auto newSize = m_mappedSize;
+  while (newSize < minimumSize)
+    newSize += capture_chunk_size;
+
+  if (::ftruncate(m_fd, (off_t)newSize) != 0) {
+    spdlog::error("Unable to grow {}: {}", m_path, std::strerror(errno));
+    return false;
+  }
+
+  if (m_map)
+    ::munmap(m_map, m_mappedSize);
+  auto *map =
+      ::mmap(nullptr, newSize, PROT_READ | PROT_WRITE, MAP_SHARED, m_fd, 0);
+  if (map == MAP_FAILED) {
+    spdlog::error("Unable to map {}: {}", m_path, std::strerror(errno));
+    m_map = nullptr;
+    m_mappedSize = 0;
+    return false;
+  }
+
+  m_map = static_cast<char *>(map);
+  m_mappedSize = newSize;
+  return true;
+}
+
+void frame_recorder_t::record(exchange_e const exchange,
+                              trade_type_e const tradeType,
+                              std::int64_t const receivedAt,
+                              std::string_view const frame) {
+  capture_record_header_t header;
+  header.size = static_cast<std::uint32_t>(frame.size());
+  header.exchange = static_cast<std::uint8_t>(exchange);
+  header.tradeType = static_cast<std::uint8_t>(tradeType);
+  header.receivedAt = receivedAt;
+
+  auto const recordSize = sizeof(header) + padded(frame.size());
+
+  std::lock_guard<std::mutex> lock_g{m_mutex};
+  // leave room for the zero-sized header that ends the capture
+  if (m_offset + recordSize + sizeof(header) > m_mappedSize &&
+      !map_chunk(m_offset + recordSize + sizeof(header)))
+    return;
+
+  std::memcpy(m_map + m_offset, &header, sizeof(header));
+  std::memcpy(m_map + m_offset + sizeof(header), frame.data(), frame.size());
+  m_offset += recordSize;
+}
+
+// ==================================================================
+
+frame_replayer_t::frame_replayer_t(std::string path, bool const keepPace,
+                                   std::size_t const loops)
+    : m_path(std::move(path)), m_keepPace(keepPace),
+      m_loops(std::max<std::size_t>(loops, 1)) {}
+
+void frame_replayer_t::add_stream(exchange_e const exchange,
+                                  trade_type_e const tradeType,
+                                  frame_handler_t handler) {
+  m_handlers[static_cast<std::size_t>(exchange) * trade_type_count +
+             static_cast<std::size_t>(tradeType)] = std::move(handler);
+}
+
+bool frame_replayer_t::run(bool const &running) {
+  int const fd = ::open(m_path.c_str(), O_RDONLY);
+  if (fd == -1) {
+    spdlog::error("Unable to open capture {}: {}", m_path,
+                  std::strerror(errno));
+    return false;
+  }
+
+  struct stat fileStat {};
+  ::fstat(fd, &fileStat);
+  auto const fileSize = static_cast<std::size_t>(fileStat.st_size);
+  void *map = fileSize < sizeof(capture_magic)
+                  ? MAP_FAILED
+                  : ::mmap(nullptr, fileSize, PROT_READ, MAP_PRIVATE, fd, 0);
+  ::close(fd);
+  if (map == MAP_FAILED ||
+      std::memcmp(map, capture_magic, sizeof(capture_magic)) != 0) {
+    spdlog::error("{} is not a capture file", m_path);
+    if (map != MAP_FAILED)
+      ::munmap(map, fileSize);
+    return false;
+  }
+  ::madvise(map, fileSize, MADV_SEQUENTIAL);
+
+  auto const *const data = static_cast<char const *>(map);
+  std::size_t frames = 0;
+  std::size_t bytes = 0;
+  auto const startTime = std::chrono::steady_clock::now();
+
+  for (std::size_t loop = 0; loop < m_loops && running; ++loop) {
+    auto const loopStart = std::chrono::steady_clock::now();
+    std::int64_t firstReceivedAt = 0;
+
+    std::size_t offset = sizeof(capture_magic);
+    while (running && offset + sizeof(capture_record_header_t) <= fileSize) {
+      capture_record_header_t header;
+      std::memcpy(&header, data + offset, sizeof(header));
+      offset += sizeof(header);
+      if (header.size == 0 || offset + header.size > fileSize)
+        break;
+
+      std::string_view const frame(data + offset, header.size);
+      offset += padded(header.size);
+
+      if (m_keepPace) {
+        if (firstReceivedAt == 0)
+          firstReceivedAt = header.receivedAt;
+        std::this_thread::sleep_until(
+            loopStart +
+            std::chrono::microseconds(header.receivedAt - firstReceivedAt));
+      }
+
+      auto const index = std::size_t(header.exchange) * trade_type_count +
+                         std::size_t(header.tradeType);
+      if (index >= m_handlers.size() || !m_handlers[index])
+        continue;
+      // stamped afresh, so the stages after this one measure this run
+      m_handlers[index](frame, micros_since_epoch());
+      ++frames;
+      bytes += header.size;
+    }
+  }
+
+  auto const elapsed = std::chrono::duration<double>(
+                           std::chrono::steady_clock::now() - startTime)
+                           .count();
+  spdlog::info("Replayed {} frames ({} bytes) in {:.3f}s: {:.0f} frames/s, "
+               "{:.1f} MB/s",
+               frames, bytes, elapsed, frames / elapsed,
+               bytes / elapsed / (1024 * 1024));
+  ::munmap(map, fileSize);
+  return true;
+}
+} // namespace keep_my_journal
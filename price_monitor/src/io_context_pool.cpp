@@ -0,0 +1,149 @@
+// Copyright (C) 2023-2024 Joshua and Jordan Ogunyinka
+
+#include "io_context_pool.hpp"
+
+#ifdef __linux__
+#include <pthread.h>
+#include <sched.h>
+#endif
+
+#include <algorithm>
+#include <cstring>
+#include <spdlog/spdlog.h>
+
+namespace keep_my_journal {
+namespace {
+constexpr auto trade_type_count = static_cast<std::size_t>(trade_type_e::total);
+
+// utils::exchangesToString and friends are only built with msgpack
+char const *const exchange_names[] = {"binance", "kucoin", "okex"};
+char const *const trade_type_names[] = {"futures", "spot", "swap"};
+
+void pin_thread_to_cpu(std::thread &thread, int const cpu,
+                       std::string const &name) {
+#ifdef __linux__
+  cpu_set_t cpuSet;
+  CPU_ZERO(&cpuSet);
+  CPU_SET(cpu, &cpuSet);
+  if (auto const result = pthread_setaffinity_np(thread.native_handle(),
+                                                 sizeof(cpuSet), &cpuSet);
+      result != 0) {
+    spdlog::warn("{}: unable to pin thread to CPU {}: {}", name, cpu,
+                 std::strerror(result));
+  }
+#else
+  spdlog::warn("{}: CPU pinning is not supported on this platform", name);
+#endif
+}
+} // namespace
+
+io_context_pool_t::context_entry_t::context_entry_t(std::string name_,
+                                                    std::size_t const count)
+    : name(std::move(name_)), threadCount(count), ioContext((int)count),
+      workGuard(net::make_work_guard(ioContext)), probe(ioContext) {}
+
+io_context_pool_t::io_context_pool_t(io_threading_model_e const model,
+                                     std::size_t const sharedThreadCount,
+                                     std::vector<int> cpus)
+    : m_model(model), m_sharedThreadCount(std::max<std::size_t>(
+                          sharedThreadCount, 1)),
+      m_cpus(std::move(cpus)),
+      m_index(static_cast<std::size_t>(exchange_e::total) * trade_type_count,
+              nullptr) {}
+
+net::io_context &io_context_pool_t::get(exchange_e const exchange,
+                                        trade_type_e const tradeType) {
+  auto const exchangeIndex = static_cast<std::size_t>(exchange);
+  auto const index =
+      exchangeIndex * trade_type_count + static_cast<std::size_t>(tradeType);
+  if (auto *entry = m_index[index]; entry)
+    return entry->ioContext;
+
+  // streams that are to share a context find it through their first slot
+  std::size_t firstIndex = index;
+  std::string name;
+  std::size_t threadCount = 1;
+  switch (m_model) {
+  case io_threading_model_e::shared:
+    firstIndex = 0;
+    name = "shared";
+    threadCount = m_sharedThreadCount;
+    break;
+  case io_threading_model_e::per_exchange:
+    firstIndex = exchangeIndex * trade_type_count;
+    name = exchange_names[exchangeIndex];
+    break;
+  case io_threading_model_e::per_stream:
+    name = std::string(exchange_names[exchangeIndex]) + "/" +
+           trade_type_names[static_cast<std::size_t>(tradeType)];
+    break;
+  }
+
+  auto *entry = m_index[firstIndex];
+  if (!entry) {
+    entry = m_contexts
+                .emplace_back(
+                    std::make_unique<context_entry_t>(name, threadCount))
+                .get();
+    m_index[firstIndex] = entry;
+  }
+  m_index[index] = entry;
+  return entry->ioContext;
+}
+
+void io_context_pool_t::run() {
+  std::size_t threadNumber = 0;
+  for (auto &entry : m_contexts) {
+    probe_queue_latency(*entry);
+    for (std::size_t i = 0; i < entry->threadCount; ++i) {
+      auto &thread = entry->threads.emplace_back(
+          [context = &entry->ioContext] { context->run(); });
+      if (!m_cpus.empty())
+        pin_thread_to_cpu(thread, m_cpus[threadNumber % m_cpus.size()],
+                          entry->name);
+      ++threadNumber;
+    }
+  }
+  spdlog::info("Running {} io_context(s) on {} thread(s)", m_contexts.size(),
+               threadNumber);
+}
+
+void io_context_pool_t::stop() {
+  for (auto &entry : m_contexts) {
+    entry->workGuard.reset();
+    entry->ioContext.stop();
+  }
+}
+
+void io_context_pool_t::join() {
+  for (auto &entry : m_contexts) {
+    for (auto &thread : entry->threads) {
+      if (thread.joinable())
+        thread.join();
+    }
+  }
+}
+
+void io_context_pool_t::probe_queue_latency(context_entry_t &entry) {
+  entry.probe.expires_after(probe_interval);
+  entry.probe.async_wait([this, &entry](boost::system::error_code const ec) {
+    if (ec)
+      return;
+
+    auto const delay = std::chrono::duration_cast<std::chrono::microseconds>(
+        std::chrono::steady_clock::now() - entry.probe.expiry());
+    ++entry.samples;
+    entry.totalDelay += delay;
+    entry.maxDelay = std::max(entry.maxDelay, delay);
+
+    if (entry.samples == samples_per_report) {
+      spdlog::info("{}: io_context queue latency avg {}us, max {}us",
+                   entry.name, entry.totalDelay.count() / entry.samples,
+                   entry.maxDelay.count());
+      entry.samples = 0;
+      entry.totalDelay = entry.maxDelay = {};
+    }
+    probe_queue_latency(entry);
+  });
+}
+} // namespace keep_my_journal
@@ -1,80 +1,67 @@
 // Copyright (C) 2023 Joshua and Jordan Ogunyinka
 
 #include "kucoin_price_stream.hpp"
+#include "frame_capture.hpp"
 #include "https_rest_client.hpp"
+#include "io_context_pool.hpp"
+#include "latency_histogram.hpp"
 #include "random_utils.hpp"
+#include "ticker_parser.hpp"
 #include <spdlog/spdlog.h>
 
 namespace keep_my_journal {
 
-instrument_type_t get_instrument_from_json(std::string_view const str,
-                                           trade_type_e const tradeType) {
-  json::object_t const jsonObject = json::parse(str);
-  auto dataIter = jsonObject.find("data");
-  if (dataIter == jsonObject.end() || !dataIter->second.is_object())
-    return {};
-
-  auto const dataObject = dataIter->second.get<json::object_t>();
-  instrument_type_t inst;
-  inst.tradeType = tradeType;
+bool get_price_record_from_json(std::string_view const str,
+                                trade_type_e const tradeType,
+                                symbol_registry_t &symbols,
+                                std::int64_t const receivedAt,
+                                price_record_t &record) {
+  kucoin_ticker_view_t ticker;
+  if (!parse_kucoin_ticker(str, ticker))
+    return false;
 
+  std::string_view name;
   if (tradeType == trade_type_e::spot) {
-    auto subjectIter = jsonObject.find("subject");
-    if (subjectIter == jsonObject.end() || !subjectIter->second.is_string())
-      return {};
-    inst.name = subjectIter->second.get<json::string_t>();
-    auto priceIter = dataObject.find("price");
-    if (priceIter == dataObject.end()) {
-#ifdef _DEBUG
-      assert(false);
-#else
-      return {};
-#endif
-    }
-    if (priceIter->second.is_string())
-      inst.currentPrice = std::stod(priceIter->second.get<json::string_t>());
-    else if (priceIter->second.is_number())
-      inst.currentPrice = priceIter->second.get<json::number_float_t>();
+    if (ticker.subject.empty() || ticker.price.empty())
+      return false;
+    if (!parse_price_string(ticker.price, record.currentPrice))
+      return false;
+    name = ticker.subject;
   } else {
-    auto symbolIter = dataObject.find("symbol");
-    if (symbolIter == dataObject.end() || !symbolIter->second.is_string())
-      return {};
-    inst.name = symbolIter->second.get<json::string_t>();
-    auto bestBidIter = dataObject.find("bestBidPrice");
-    auto bestAskIter = dataObject.find("bestAskPrice");
-    if (bestAskIter == dataObject.end() || bestBidIter == dataObject.end() ||
-        !(bestBidIter->second.is_string() && bestAskIter->second.is_string())) {
-#ifdef _DEBUG
-      assert(false);
-#else
-      return {};
-#endif
-    }
-    auto const bidPrice = std::stod(bestBidIter->second.get<json::string_t>()),
-               askPrice = std::stod(bestAskIter->second.get<json::string_t>());
-    inst.currentPrice = (bidPrice + askPrice) / 2.0;
+    decimal_t bidPrice, askPrice;
+    if (ticker.symbol.empty() ||
+        !parse_price_string(ticker.bestBidPrice, bidPrice) ||
+        !parse_price_string(ticker.bestAskPrice, askPrice))
+      return false;
+    name = ticker.symbol;
+    // (bid + ask) / 2, exactly
+    record.currentPrice = (bidPrice + askPrice) * decimal_t(5, -1);
   }
-  return inst;
+  record.id = symbols.intern(tradeType, name);
+  stamp_received(record.timestamps, ticker.eventTime, receivedAt);
+  return true;
 }
 
 kucoin_price_stream_t::kucoin_price_stream_t(net::io_context &ioContext,
                                              ssl::context &sslContext,
                                              trade_type_e const tradeType)
     : m_ioContext(ioContext), m_sslContext(sslContext), m_tradeType(tradeType),
+      m_reconnect(ioContext, fmt::format("KuCoin -> '{}'", (int)tradeType)),
       m_tradedInstruments(
-          instrument_sink_t::get_all_listed_instruments(exchange_e::kucoin)) {}
+          instrument_sink_t::get_all_listed_instruments(exchange_e::kucoin)),
+      m_symbols(symbol_registry_t::get(exchange_e::kucoin)) {}
 
 void kucoin_price_stream_t::rest_api_initiate_connection() {
   if (!m_tradedInstruments.empty())
     return rest_api_obtain_token();
 
-  m_resolver.emplace(m_ioContext);
   m_sslWebStream.emplace(m_ioContext, m_sslContext);
   m_tokensSubscribedFor = false;
 
   auto onError = [self = shared_from_this()](beast::error_code const ec) {
     spdlog::error("KuCoin -> '{}' gave this error: {}", (int)self->m_tradeType,
                   ec.message());
+    self->report_error_and_retry(ec);
   };
 
   auto onSuccess = [self = shared_from_this()](std::string const &data) {
@@ -83,7 +70,7 @@ void kucoin_price_stream_t::rest_api_initiate_connection() {
   };
 
   m_httpClient = std::make_unique<https_rest_api_t>(
-      m_ioContext, m_sslContext, m_sslWebStream->next_layer(), *m_resolver,
+      m_ioContext, m_sslContext, m_sslWebStream->next_layer(),
       m_apiHost.c_str(), m_apiService.c_str(), rest_api_target());
   m_httpClient->set_method(http_method_e::get);
   m_httpClient->set_callbacks(std::move(onError), std::move(onSuccess));
@@ -97,12 +84,12 @@ void kucoin_price_stream_t::run() {
 }
 
 void kucoin_price_stream_t::rest_api_obtain_token() {
-  m_resolver.emplace(m_ioContext);
   m_sslWebStream.emplace(m_ioContext, m_sslContext);
 
   auto onError = [self = shared_from_this()](beast::error_code const ec) {
     spdlog::error("KuCoin -> '{}' gave this error: {}", (int)self->m_tradeType,
                   ec.message());
+    self->report_error_and_retry(ec);
   };
 
   auto onSuccess = [self = shared_from_this()](std::string const &data) {
@@ -111,7 +98,7 @@ void kucoin_price_stream_t::rest_api_obtain_token() {
   };
 
   m_httpClient = std::make_unique<https_rest_api_t>(
-      m_ioContext, m_sslContext, m_sslWebStream->next_layer(), *m_resolver,
+      m_ioContext, m_sslContext, m_sslWebStream->next_layer(),
       m_apiHost.c_str(), m_apiService.c_str(), "/api/v1/bullet-public");
   m_httpClient->set_method(http_method_e::post);
   m_httpClient->set_callbacks(std::move(onError), std::move(onSuccess));
@@ -181,70 +168,16 @@ void kucoin_price_stream_t::initiate_websocket_connection() {
 
   m_uri = uri_t(m_instanceServers.back().endpoint);
   auto const service = m_uri.protocol() != "wss" ? m_uri.protocol() : "443";
-  m_resolver.emplace(m_ioContext);
-  m_resolver->async_resolve(
-      m_uri.host(), service,
-      [self = shared_from_this()](auto const &errorCode,
-                                  resolver::results_type const &results) {
-        if (errorCode)
-          return self->report_error_and_retry(errorCode);
-        self->websocket_connect_to_resolved_names(results);
-      });
-}
-
-void kucoin_price_stream_t::websocket_connect_to_resolved_names(
-    resolver::results_type const &resolvedNames) {
-  m_resolver.reset();
-  m_sslWebStream.emplace(m_ioContext, m_sslContext);
-
-  beast::get_lowest_layer(*m_sslWebStream)
-      .expires_after(std::chrono::seconds(30));
-  beast::get_lowest_layer(*m_sslWebStream)
-      .async_connect(resolvedNames,
-                     [self = shared_from_this()](
-                         auto const errorCode,
-                         resolver::results_type::endpoint_type const &) {
-                       if (errorCode)
-                         return self->report_error_and_retry(errorCode);
-                       self->websocket_perform_ssl_handshake();
-                     });
-}
-
-void kucoin_price_stream_t::websocket_perform_ssl_handshake() {
-  auto const host = m_uri.host();
-  beast::get_lowest_layer(*m_sslWebStream)
-      .expires_after(std::chrono::seconds(10));
-  if (!SSL_set_tlsext_host_name(m_sslWebStream->next_layer().native_handle(),
-                                host.c_str())) {
-    auto const errorCode = beast::error_code(
-        static_cast<int>(::ERR_get_error()), net::error::get_ssl_category());
-    return spdlog::error(errorCode.message());
-  }
-
-  negotiate_websocket_connection();
-}
-
-void kucoin_price_stream_t::negotiate_websocket_connection() {
-  m_sslWebStream->next_layer().async_handshake(
-      ssl::stream_base::client,
-      [self = shared_from_this()](beast::error_code const &ec) {
-        if (ec) {
-          if (ec.category() == net::error::get_ssl_category())
-            spdlog::error("SSL Category error");
-          return;
-        }
-        beast::get_lowest_layer(*self->m_sslWebStream).expires_never();
-        self->perform_websocket_handshake();
-      });
-}
-
-void kucoin_price_stream_t::perform_websocket_handshake() {
   auto const path = m_uri.path() + "?token=" + m_requestToken +
                     "&connectId=" + utils::getRandomString(10);
-  m_sslWebStream->async_handshake(
-      m_uri.host(), path, [self = shared_from_this()](auto const errorCode) {
+  m_sslWebStream.emplace(m_ioContext, m_sslContext);
+
+  websocket_connector_t::connect(
+      *m_sslWebStream, {m_uri.host(), service, path},
+      [self = shared_from_this()](beast::error_code const &errorCode) {
         if (errorCode)
           return self->report_error_and_retry(errorCode);
+        self->m_reconnect.on_connected();
         self->start_ping_timer();
         self->wait_for_messages();
       });
@@ -304,14 +237,13 @@ void kucoin_price_stream_t::wait_for_messages() {
 }
 
 void kucoin_price_stream_t::interpret_generic_messages() {
+  auto const receivedAt = micros_since_epoch();
   char const *const bufferCstr =
       static_cast<char const *>(m_readWriteBuffer->cdata().data());
   size_t const dataLength = m_readWriteBuffer->size();
   auto const buffer = std::string_view(bufferCstr, dataLength);
-  auto const inst =
-      keep_my_journal::get_instrument_from_json(buffer, m_tradeType);
-  if (!inst.name.empty())
-    m_tradedInstruments.append(inst);
+  capture_frame(exchange_e::kucoin, m_tradeType, receivedAt, buffer);
+  process_frame(buffer, receivedAt);
 
   if (!m_tokensSubscribedFor)
     return send_ticker_subscription();
@@ -319,6 +251,13 @@ void kucoin_price_stream_t::interpret_generic_messages() {
   return wait_for_messages();
 }
 
+void kucoin_price_stream_t::process_frame(std::string_view const frame,
+                                          std::int64_t const receivedAt) {
+  if (price_record_t record{}; get_price_record_from_json(
+          frame, m_tradeType, m_symbols, receivedAt, record))
+    m_tradedInstruments.append(record);
+}
+
 void kucoin_price_stream_t::send_ticker_subscription() {
   if (m_subscriptionString.empty())
     m_subscriptionString = get_subscription_json();
@@ -339,10 +278,8 @@ void kucoin_price_stream_t::report_error_and_retry(beast::error_code const ec) {
   m_tradedInstruments.clear();
   reset_ping_timer();
   reset_counter();
-
-  // wait a bit and then retry
-  std::this_thread::sleep_for(std::chrono::seconds(5));
-  rest_api_initiate_connection();
+  m_reconnect.schedule(
+      [self = shared_from_this()] { self->rest_api_initiate_connection(); });
 }
 
 // ===================================================
@@ -373,6 +310,8 @@ void kucoin_futures_price_stream_t::on_instruments_received(
     instrument_type_t data;
     data.tradeType = trade_type_e::futures;
     m_fInstruments.reserve(tickers.size());
+    std::vector<price_record_t> records;
+    records.reserve(tickers.size());
 
     for (auto const &tickerItem : tickers) {
       auto const tickerObject = tickerItem.get<json::object_t>();
@@ -381,14 +320,20 @@ void kucoin_futures_price_stream_t::on_instruments_received(
         continue;
 
       if (lastPrice.is_number())
-        data.currentPrice = lastPrice.get<json::number_float_t>();
+        data.currentPrice =
+            decimal_t::from_double(lastPrice.get<json::number_float_t>());
       else if (lastPrice.is_string())
-        data.currentPrice = std::stod(lastPrice.get<json::string_t>());
+        parse_price_string(lastPrice.get<json::string_t>(), data.currentPrice);
 
       data.name = tickerObject.find("symbol")->second.get<json::string_t>();
       m_fInstruments.push_back(data);
-      m_tradedInstruments.append(data);
+
+      price_record_t record{};
+      record.id = m_symbols.intern(data.tradeType, data.name);
+      record.currentPrice = data.currentPrice;
+      records.push_back(record);
     }
+    m_tradedInstruments.append_list(std::move(records));
   } catch (std::exception const &e) {
     spdlog::error(e.what());
   }
@@ -438,8 +383,8 @@ void kucoin_spot_price_stream_t::on_instruments_received(
   if (tickerIter == dataObject.end() || !tickerIter->second.is_array())
     return;
   auto const tickers = tickerIter->second.get<json::array_t>();
-  instrument_type_t data;
-  data.tradeType = trade_type_e::spot;
+  std::vector<price_record_t> records;
+  records.reserve(tickers.size());
 
   for (auto const &tickerItem : tickers) {
     auto const tickerObject = tickerItem.get<json::object_t>();
@@ -447,18 +392,23 @@ void kucoin_spot_price_stream_t::on_instruments_received(
     if (temp.is_null())
       continue;
 
+    price_record_t data{};
     if (temp.is_string())
-      data.currentPrice = std::stod(temp.get<json::string_t>());
+      parse_price_string(temp.get<json::string_t>(), data.currentPrice);
     else if (temp.is_number())
-      data.currentPrice = temp.get<json::number_float_t>();
+      data.currentPrice =
+          decimal_t::from_double(temp.get<json::number_float_t>());
     else {
       spdlog::error(json(tickerObject).dump());
       throw std::runtime_error("Unknown data sent in on_instruments_received");
     }
 
-    data.name = tickerObject.find("symbol")->second.get<json::string_t>();
-    m_tradedInstruments.append(data);
+    data.id = m_symbols.intern(
+        trade_type_e::spot,
+        tickerObject.find("symbol")->second.get<json::string_t>());
+    records.push_back(data);
   }
+  m_tradedInstruments.append_list(std::move(records));
 }
 
 std::string kucoin_spot_price_stream_t::get_subscription_json() {
@@ -472,15 +422,21 @@ std::string kucoin_spot_price_stream_t::get_subscription_json() {
   return json(obj).dump();
 }
 
-void kucoin_price_watcher(net::io_context &ioContext,
-                          ssl::context &sslContext) {
-  auto spotWatcher =
-      std::make_shared<kucoin_spot_price_stream_t>(ioContext, sslContext);
-  auto futuresWatcher =
-      std::make_shared<kucoin_futures_price_stream_t>(ioContext, sslContext);
+void kucoin_price_watcher(io_context_pool_t &pool, ssl::context &sslContext,
+                          frame_replayer_t *replayer) {
+  auto spotWatcher = std::make_shared<kucoin_spot_price_stream_t>(
+      pool.get(exchange_e::kucoin, trade_type_e::spot), sslContext);
+  auto futuresWatcher = std::make_shared<kucoin_futures_price_stream_t>(
+      pool.get(exchange_e::kucoin, trade_type_e::futures), sslContext);
+
+  if (replayer) {
+    replayer->add_stream(exchange_e::kucoin, trade_type_e::spot, spotWatcher);
+    replayer->add_stream(exchange_e::kucoin, trade_type_e::futures,
+                         futuresWatcher);
+    return;
+  }
 
   spotWatcher->run();
   futuresWatcher->run();
-  ioContext.run();
 }
 } // namespace keep_my_journal
@@ -2,7 +2,11 @@
 #include "okex_price_stream.hpp"
 
 #include "crypto_utils.hpp"
+#include "frame_capture.hpp"
 #include "https_rest_client.hpp"
+#include "io_context_pool.hpp"
+#include "latency_histogram.hpp"
+#include "ticker_parser.hpp"
 #include <spdlog/spdlog.h>
 
 namespace keep_my_journal {
@@ -31,12 +35,14 @@ okex_price_stream_t::okex_price_stream_t(net::io_context &ioContext,
     : m_ioContext{ioContext}, m_sslContext{sslContext},
       m_tradedInstruments(
           instrument_sink_t::get_all_listed_instruments(exchange_e::okex)),
-      m_sslWebStream{}, m_resolver{}, m_tradeType(tradeType) {}
+      m_symbols(symbol_registry_t::get(exchange_e::okex)),
+      m_sslWebStream{}, m_tradeType(tradeType),
+      m_reconnect(ioContext,
+                  "OKX -> '" + trade_type_to_string(tradeType) + "'") {}
 
 void okex_price_stream_t::run() { rest_api_initiate_connection(); }
 
 void okex_price_stream_t::rest_api_initiate_connection() {
-  m_resolver.emplace(m_ioContext);
   m_sslWebStream.emplace(m_ioContext, m_sslContext);
 
   auto onError = [self = shared_from_this()](beast::error_code const ec) {
@@ -51,7 +57,7 @@ void okex_price_stream_t::rest_api_initiate_connection() {
 
   auto const tradeTypeStr = trade_type_to_string(m_tradeType);
   m_httpClient = std::make_unique<https_rest_api_t>(
-      m_ioContext, m_sslContext, m_sslWebStream->next_layer(), *m_resolver,
+      m_ioContext, m_sslContext, m_sslWebStream->next_layer(),
       api_host, api_service,
       "/api/v5/public/instruments?instType=" + tradeTypeStr);
   m_httpClient->set_callbacks(std::move(onError), std::move(onSuccess));
@@ -79,91 +85,29 @@ void okex_price_stream_t::rest_api_on_data_received(std::string const &data) {
 
 void okex_price_stream_t::report_error_and_retry(beast::error_code const ec) {
   spdlog::error(ec.message());
-
-  // wait a bit and then retry
-  std::this_thread::sleep_for(std::chrono::seconds(5));
-  rest_api_initiate_connection();
+  m_reconnect.schedule(
+      [self = shared_from_this()] { self->rest_api_initiate_connection(); });
 }
 
 void okex_price_stream_t::initiate_websocket_connection() {
-  m_resolver.emplace(m_ioContext);
   m_tradedInstruments.clear();
-
-  m_resolver->async_resolve(
-      okex_price_stream_t::ws_host, okex_price_stream_t::ws_port_number,
-      [self = shared_from_this()](
-          auto const error_code,
-          net::ip::tcp::resolver::results_type const &results) {
-        if (error_code)
-          return self->report_error_and_retry(error_code);
-        self->connect_to_resolved_names(results);
-      });
-}
-
-void okex_price_stream_t::connect_to_resolved_names(
-    results_type const &resolved_names) {
-
-  m_resolver.reset();
   m_sslWebStream.emplace(m_ioContext, m_sslContext);
-  beast::get_lowest_layer(*m_sslWebStream)
-      .expires_after(std::chrono::seconds(30));
-
-  beast::get_lowest_layer(*m_sslWebStream)
-      .async_connect(resolved_names,
-                     [self = shared_from_this()](
-                         auto const error_code,
-                         [[maybe_unused]] results_type::endpoint_type const
-                             &connected_name) {
-                       if (error_code)
-                         return self->report_error_and_retry(error_code);
-                       self->perform_ssl_handshake();
-                     });
-}
-
-void okex_price_stream_t::perform_ssl_handshake() {
-  // Set a timeout on the operation
-  beast::get_lowest_layer(*m_sslWebStream)
-      .expires_after(std::chrono::seconds(30));
-
-  // Set SNI Hostname (many hosts need this to handshake successfully)
-  if (!SSL_set_tlsext_host_name(m_sslWebStream->next_layer().native_handle(),
-                                ws_host)) {
-    auto const ec = beast::error_code(static_cast<int>(::ERR_get_error()),
-                                      net::error::get_ssl_category());
-    return spdlog::error(ec.message());
-  }
-
-  m_sslWebStream->next_layer().async_handshake(
-      net::ssl::stream_base::client,
-      [self = shared_from_this()](beast::error_code const ec) {
-        if (ec)
-          return self->report_error_and_retry(ec);
-        beast::get_lowest_layer(*self->m_sslWebStream).expires_never();
-        return self->perform_websocket_handshake();
-      });
-}
-
-void okex_price_stream_t::perform_websocket_handshake() {
-  static auto const okex_handshake_path = "/ws/v5/public";
 
   auto opt = websock::stream_base::timeout();
   opt.idle_timeout = std::chrono::seconds(20);
   opt.handshake_timeout = std::chrono::seconds(5);
   opt.keep_alive_pings = true;
-
+  // a close frame from the server fails the pending read with
+  // websocket::error::closed, which reconnects
   m_sslWebStream->set_option(opt);
-  m_sslWebStream->control_callback(
-      [self = shared_from_this()](auto const frame_type, auto const &) {
-        if (frame_type == websock::frame_type::close)
-          return self->report_error_and_retry(beast::error_code{});
-      });
 
-  m_sslWebStream->async_handshake(
-      ws_host, okex_handshake_path,
-      [self = shared_from_this()](beast::error_code const ec) {
+  websocket_connector_t::connect(
+      *m_sslWebStream, {ws_host, ws_port_number, "/ws/v5/public"},
+      [self = shared_from_this()](beast::error_code const &ec) {
         if (ec)
           return self->report_error_and_retry(ec);
 
+        self->m_reconnect.on_connected();
         self->m_buffer.reset();
         self->ticker_subscribe();
       });
@@ -220,37 +164,38 @@ void okex_price_stream_t::wait_for_messages() {
 }
 
 void okex_price_stream_t::interpret_generic_messages() {
+  auto const receivedAt = micros_since_epoch();
   char const *buffer_cstr = static_cast<char const *>(m_buffer->cdata().data());
   std::string_view const buffer(buffer_cstr, m_buffer->size());
 
-  try {
-    json::object_t const root = json::parse(buffer).get<json::object_t>();
-    if (auto event_iter = root.find("event"); event_iter != root.end()) {
-      if (auto const error_code = root.find("code");
-          error_code != root.cend()) {
-        // print error and continue as though nothing's happened
-        spdlog::error(root.at("msg").get<json::string_t>());
-      }
-    } else if (auto data_iter = root.find("data"); data_iter != root.end()) {
-      if (auto arg_iter = root.find("arg"); arg_iter != root.end()) {
-        json::object_t const arg_object =
-            arg_iter->second.get<json::object_t>();
-        auto const channel = arg_object.at("channel").get<json::string_t>();
-        if (channel == "instruments") {
-          process_pushed_instruments_data(
-              data_iter->second.get<json::array_t>());
-        } else if (channel == "tickers") {
-          process_pushed_tickers_data(data_iter->second.get<json::array_t>());
-        }
+  capture_frame(exchange_e::okex, m_tradeType, receivedAt, buffer);
+  process_frame(buffer, receivedAt);
+  return wait_for_messages();
+}
+
+void okex_price_stream_t::process_frame(std::string_view const buffer,
+                                        std::int64_t const receivedAt) {
+  okex_frame_view_t frame;
+  if (!parse_okex_frame(buffer, frame)) {
+    spdlog::error("OKX: malformed frame: {}", buffer);
+  } else if (!frame.event.empty()) {
+    // print error and continue as though nothing's happened
+    if (!frame.code.empty())
+      spdlog::error(frame.message);
+  } else if (!frame.data.empty() && !frame.channel.empty()) {
+    if (frame.channel == "tickers") {
+      process_pushed_tickers_data(frame.data, receivedAt);
+    } else if (frame.channel == "instruments") {
+      try {
+        process_pushed_instruments_data(
+            json::parse(frame.data).get<json::array_t>());
+      } catch (std::exception const &e) {
+        spdlog::error(e.what());
       }
-    } else {
-      spdlog::info(buffer);
     }
-  } catch (std::exception const &e) {
-    spdlog::error(e.what());
+  } else if (frame.data.empty()) {
+    spdlog::info(buffer);
   }
-
-  return wait_for_messages();
 }
 
 void okex_price_stream_t::process_pushed_instruments_data(
@@ -262,36 +207,52 @@ void okex_price_stream_t::process_pushed_instruments_data(
 }
 
 void okex_price_stream_t::process_pushed_tickers_data(
-    json::array_t const &data_list) {
-  instrument_type_t data{};
-  data.tradeType = m_tradeType;
+    std::string_view const data_list, std::int64_t const receivedAt) {
+  std::vector<price_record_t> records;
 
-  for (auto const &data_json : data_list) {
-    auto const data_object = data_json.get<json::object_t>();
+  auto onTicker = [this, &records, receivedAt](ticker_view_t const &ticker) {
+    price_record_t data{};
+    if (!parse_price_string(ticker.currentPrice, data.currentPrice) ||
+        !parse_price_string(ticker.open24h, data.open24h))
+      return;
+    data.id = m_symbols.intern(m_tradeType, ticker.name);
+    stamp_received(data.timestamps, ticker.eventTime, receivedAt);
+    records.push_back(data);
+  };
 
-    data.name = data_object.at("instId").get<json::string_t>();
-    data.currentPrice = std::stod(data_object.at("last").get<json::string_t>());
-    data.open24h = std::stod(data_object.at("sodUtc8").get<json::string_t>());
-    m_tradedInstruments.append(data);
-  }
+  if (!parse_okex_tickers(data_list, onTicker))
+    spdlog::error("OKX: malformed tickers data: {}", data_list);
+
+  if (!records.empty())
+    m_tradedInstruments.append_list(std::move(records));
 }
 
-void okexchange_price_watcher(net::io_context &ioContext,
-                              net::ssl::context &sslContext) {
-  auto spotStream = std::make_shared<okex_price_stream_t>(ioContext, sslContext,
-                                                          trade_type_e::spot);
+void okexchange_price_watcher(io_context_pool_t &pool,
+                              net::ssl::context &sslContext,
+                              frame_replayer_t *replayer) {
+  auto spotStream = std::make_shared<okex_price_stream_t>(
+      pool.get(exchange_e::okex, trade_type_e::spot), sslContext,
+      trade_type_e::spot);
 
-  auto swapStream = std::make_shared<okex_price_stream_t>(ioContext, sslContext,
-                                                          trade_type_e::swap);
+  auto swapStream = std::make_shared<okex_price_stream_t>(
+      pool.get(exchange_e::okex, trade_type_e::swap), sslContext,
+      trade_type_e::swap);
 
   auto futuresStream = std::make_shared<okex_price_stream_t>(
-      ioContext, sslContext, trade_type_e::futures);
+      pool.get(exchange_e::okex, trade_type_e::futures), sslContext,
+      trade_type_e::futures);
+
+  if (replayer) {
+    replayer->add_stream(exchange_e::okex, trade_type_e::spot, spotStream);
+    replayer->add_stream(exchange_e::okex, trade_type_e::swap, swapStream);
+    replayer->add_stream(exchange_e::okex, trade_type_e::futures,
+                         futuresStream);
+    return;
+  }
 
   spotStream->run();
   swapStream->run();
   futuresStream->run();
-
-  ioContext.run();
 }
 
 } // namespace keep_my_journal
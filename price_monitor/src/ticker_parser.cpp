@@ -0,0 +1,203 @@
+// Copyright (C) 2023-2024 Joshua and Jordan Ogunyinka
+#include "ticker_parser.hpp"
+#include "latency_histogram.hpp"
+
+#include <charconv>
+
+namespace keep_my_journal {
+namespace details {
+void json_cursor_t::skip_whitespace() {
+  while (m_current != m_end && (*m_current == ' ' || *m_current == '\n' ||
+                                *m_current == '\r' || *m_current == '\t'))
+    ++m_current;
+}
+
+bool json_cursor_t::peek(char const ch) {
+  skip_whitespace();
+  return m_current != m_end && *m_current == ch;
+}
+
+bool json_cursor_t::consume(char const ch) {
+  if (!peek(ch))
+    return false;
+  ++m_current;
+  return true;
+}
+
+bool json_cursor_t::skip_string() {
+  // assumes the opening quote has been consumed
+  while (m_current != m_end) {
+    if (*m_current == '\\') {
+      if (++m_current == m_end)
+        return false;
+    } else if (*m_current == '"') {
+      ++m_current;
+      return true;
+    }
+    ++m_current;
+  }
+  return false;
+}
+
+bool json_cursor_t::skip_literal() {
+  char const *const begin = m_current;
+  while (m_current != m_end && *m_current != ',' && *m_current != '}' &&
+         *m_current != ']' && *m_current != ' ' && *m_current != '\n' &&
+         *m_current != '\r' && *m_current != '\t')
+    ++m_current;
+  return m_current != begin;
+}
+
+bool json_cursor_t::skip_container(char const open, char const close) {
+  // assumes the opening bracket has been consumed
+  std::size_t depth = 1;
+  while (m_current != m_end) {
+    char const ch = *m_current++;
+    if (ch == '"') {
+      if (!skip_string())
+        return false;
+    } else if (ch == open) {
+      ++depth;
+    } else if (ch == close && --depth == 0) {
+      return true;
+    }
+  }
+  return false;
+}
+
+bool json_cursor_t::read_string(std::string_view &value) {
+  if (!consume('"'))
+    return false;
+  char const *const begin = m_current;
+  if (!skip_string())
+    return false;
+  value = std::string_view(begin, (m_current - begin) - 1);
+  return true;
+}
+
+bool json_cursor_t::read_value(std::string_view &value) {
+  skip_whitespace();
+  if (m_current == m_end)
+    return false;
+  if (*m_current == '"')
+    return read_string(value);
+
+  char const *const begin = m_current;
+  if (!skip_value())
+    return false;
+  value = std::string_view(begin, m_current - begin);
+  return true;
+}
+
+bool json_cursor_t::skip_value() {
+  skip_whitespace();
+  if (m_current == m_end)
+    return false;
+
+  switch (*m_current) {
+  case '"':
+    ++m_current;
+    return skip_string();
+  case '{':
+    ++m_current;
+    return skip_container('{', '}');
+  case '[':
+    ++m_current;
+    return skip_container('[', ']');
+  default:
+    return skip_literal();
+  }
+}
+} // namespace details
+
+bool parse_price_string(std::string_view const str, decimal_t &result) {
+  return parse_decimal(str, result);
+}
+
+bool parse_event_time(std::string_view const str, std::int64_t &micros) {
+  // from_chars would take a minus sign
+  if (str.empty() || str.front() < '0' || str.front() > '9')
+    return false;
+
+  // rejects anything past INT64_MAX rather than overflowing
+  std::int64_t value = 0;
+  auto const end = str.data() + str.size();
+  auto const [last, ec] = std::from_chars(str.data(), end, value);
+  if (ec != std::errc{} || last != end)
+    return false;
+
+  // told apart by magnitude: any date since 2001 has 13 digits in ms
+  if (value >= 100'000'000'000'000'000)
+    micros = value / 1'000;
+  else if (value >= 100'000'000'000'000)
+    micros = value;
+  else
+    micros = value * 1'000;
+  return true;
+}
+
+void stamp_received(price_timestamps_t &timestamps,
+                    std::string_view const eventTime,
+                    std::int64_t const receivedAt) {
+  timestamps.received = receivedAt;
+  if (parse_event_time(eventTime, timestamps.exchange)) {
+    latency_stats_t::record(latency_stage_e::exchange_to_receive,
+                            timestamps.exchange, receivedAt);
+  }
+}
+
+bool parse_okex_frame(std::string_view const frame,
+                      okex_frame_view_t &result) {
+  details::json_cursor_t cursor(frame);
+  return cursor.for_each_member([&result](std::string_view const key,
+                                          details::json_cursor_t &c) {
+    if (key == "event")
+      return c.read_value(result.event);
+    if (key == "code")
+      return c.read_value(result.code);
+    if (key == "msg")
+      return c.read_value(result.message);
+    if (key == "data")
+      return c.read_value(result.data);
+    if (key == "arg") {
+      return c.for_each_member(
+          [&result](std::string_view const argKey, details::json_cursor_t &a) {
+            if (argKey == "channel")
+              return a.read_value(result.channel);
+            return a.skip_value();
+          });
+    }
+    return c.skip_value();
+  });
+}
+
+bool parse_kucoin_ticker(std::string_view const frame,
+                         kucoin_ticker_view_t &result) {
+  details::json_cursor_t cursor(frame);
+  return cursor.for_each_member([&result](std::string_view const key,
+                                          details::json_cursor_t &c) {
+    if (key == "subject")
+      return c.read_value(result.subject);
+    if (key != "data")
+      return c.skip_value();
+    if (!c.peek('{')) // welcome, ack and pong messages carry no data object
+      return c.skip_value();
+
+    return c.for_each_member([&result](std::string_view const dataKey,
+                                       details::json_cursor_t &d) {
+      if (dataKey == "price")
+        return d.read_value(result.price);
+      if (dataKey == "symbol")
+        return d.read_value(result.symbol);
+      if (dataKey == "bestBidPrice")
+        return d.read_value(result.bestBidPrice);
+      if (dataKey == "bestAskPrice")
+        return d.read_value(result.bestAskPrice);
+      // spot tickers carry `time` (ms), futures `ts` (ns)
+      if (dataKey == "time" || dataKey == "ts")
+        return d.read_value(result.eventTime);
+      return d.skip_value();
+    });
+  });
+}
+} // namespace keep_my_journal
@@ -1,6 +1,9 @@
 #include "progress_based_task.hpp"
 #include "dbus/use_cases/price_task_result_client_impl.hpp"
 #include "price_stream/adaptor/commodity_adaptor.hpp"
+#include "price_stream/instrument_store.hpp"
+#include "price_stream/price_subscriptions.hpp"
+#include "price_stream/shared_price_table.hpp"
 
 #include <boost/asio/deadline_timer.hpp>
 #include <thread>
@@ -23,23 +26,31 @@ inline void send_price_task_result(scheduled_progress_task_result_t &&res) {
   scheduled_task_results.append(std::move(res));
 }
 
-inline bool is_lesser_or_equals(double const a, double const b) {
+inline bool is_lesser_or_equals(decimal_t const &a, decimal_t const &b) {
   return a <= b;
 }
 
-inline bool is_greater_or_equals(double const a, double const b) {
+inline bool is_greater_or_equals(decimal_t const &a, decimal_t const &b) {
   return a >= b;
 }
 
 class progress_based_watch_price_t::progress_based_watch_price_impl_t
     : public std::enable_shared_from_this<progress_based_watch_price_impl_t> {
-  using progress_comparator_t = bool (*)(double, double);
+  using progress_comparator_t = bool (*)(decimal_t const &, decimal_t const &);
 
   net::io_context &m_ioContext;
-  utils::unique_elements_t<instrument_type_t> &m_instruments;
+  instrument_store_t &m_instruments;
   scheduled_price_task_t const m_task;
   dbus::adaptor::dbus_progress_struct_t const m_dbusTask;
   std::vector<instrument_type_t> m_snapshots;
+  // tokens without a price yet, their snapshot is taken at their first one
+  std::vector<std::string> m_pendingTokens;
+  // price * (100 + percentage) / 100, computed without rounding
+  decimal_t m_factor;
+  // the task's tokens the store has had since the last check, so that only
+  // the prices that moved are compared; the first check takes all of them
+  std::vector<instrument_type_t> m_changed;
+  std::uint64_t m_checkedSequence = 0;
   std::optional<net::deadline_timer> m_periodicTimer = std::nullopt;
   progress_comparator_t m_comparator = nullptr;
 
@@ -48,32 +59,59 @@ public:
                                     scheduled_price_task_t const &task)
       : m_ioContext(ioContext), m_instruments(uniqueInstruments[task.exchange]),
         m_task(task),
-        m_dbusTask(dbus::adaptor::scheduled_task_to_dbus_progress(task)) {
-    auto const snapshot = m_instruments.to_list();
+        m_dbusTask(dbus::adaptor::scheduled_task_to_dbus_progress(task)),
+        m_factor(decimal_t(100) + task.percentProp->percentage) {
+    // only the watched symbols are subscribed to, a new task's symbols may
+    // not have been seen yet
+    price_subscriptions_t::instance().watch(task.exchange, task.tradeType,
+                                            task.tokens);
+
+    // the tokens that have a price, in the tokens' order
+    std::vector<instrument_type_t> snapshot;
+    if (auto &tables = shared_price_tables_t::instance(); tables.is_enabled()) {
+      if (auto const table = tables.get(task.exchange); table)
+        table->find_all(task.tradeType, task.tokens, snapshot);
+    } else {
+      m_instruments.find_all(task.tradeType, task.tokens, snapshot);
+    }
+
     m_snapshots.reserve(task.tokens.size());
 
     auto const percentage = task.percentProp->percentage;
+    auto priced = snapshot.begin();
     for (auto const &token : task.tokens) {
-      auto const iter = std::find_if(
-          snapshot.cbegin(), snapshot.cend(),
-          [token, trade = task.tradeType](instrument_type_t const &instr) {
-            return instr.tradeType == trade && instr.name == token;
-          });
-
-      if (iter != snapshot.cend()) {
-        auto instr = *iter;
-        auto const t = (instr.currentPrice * (percentage / 100.0));
-        if (percentage < 0)
-          instr.currentPrice -= t;
-        else
-          instr.currentPrice += t;
-        m_snapshots.push_back(instr);
-      }
+      if (priced != snapshot.end() && priced->name == token)
+        take_snapshot(std::move(*priced++));
+      else
+        m_pendingTokens.push_back(token);
     }
 
     m_comparator =
-        (percentage < 0.0) ? is_lesser_or_equals : is_greater_or_equals;
-    assert(m_snapshots.size() == task.tokens.size());
+        percentage.is_negative() ? is_lesser_or_equals : is_greater_or_equals;
+  }
+
+  // the price the task fires at, `percentage` percent away from the one now:
+  // below it for a negative percentage, above it otherwise. `scaled(-2)` is
+  // the exact division by 100. The comparator takes the current price
+  // first, so a task at its snapshot's price doesn't fire.
+  void take_snapshot(instrument_type_t instrument) {
+    instrument.currentPrice = (instrument.currentPrice * m_factor).scaled(-2);
+    m_snapshots.push_back(std::move(instrument));
+  }
+
+  void snapshot_pending_tokens() {
+    instrument_type_t key;
+    key.tradeType = m_task.tradeType;
+    auto iter = m_pendingTokens.begin();
+    while (iter != m_pendingTokens.end()) {
+      key.name = *iter;
+      if (auto instrument = latest_price(key); instrument) {
+        take_snapshot(std::move(*instrument));
+        iter = m_pendingTokens.erase(iter);
+      } else {
+        ++iter;
+      }
+    }
   }
 
   void next_timer() {
@@ -99,18 +137,59 @@ public:
 
   scheduled_price_task_t task_data() const { return m_task; }
 
+  std::optional<instrument_type_t>
+  latest_price(instrument_type_t const &instrument) {
+    if (auto &tables = shared_price_tables_t::instance(); tables.is_enabled()) {
+      auto const table = tables.get(m_task.exchange);
+      if (!table)
+        return std::nullopt;
+      return table->find(instrument.tradeType, instrument.name);
+    }
+    return m_instruments.find_item(instrument);
+  }
+
+  // the price stored for `instrument` since the last check, if any
+  std::optional<instrument_type_t>
+  changed_price(instrument_type_t const &instrument) const {
+    auto const iter =
+        std::find_if(m_changed.cbegin(), m_changed.cend(),
+                     [&instrument](instrument_type_t const &changed) {
+                       return changed.tradeType == instrument.tradeType &&
+                              changed.name == instrument.name;
+                     });
+    if (iter == m_changed.cend())
+      return std::nullopt;
+    return *iter;
+  }
+
   void check_prices() {
+    // a shared table can't tell what changed, every token is read from it
+    bool const isIncremental =
+        !shared_price_tables_t::instance().is_enabled();
+    if (isIncremental) {
+      m_checkedSequence = m_instruments.find_all(
+          m_task.tradeType, m_task.tokens, m_checkedSequence, m_changed);
+      if (m_changed.empty())
+        return next_timer();
+    }
+
     scheduled_progress_task_result_t result;
+    if (!m_pendingTokens.empty())
+      snapshot_pending_tokens();
 
     for (auto const &instrument : m_snapshots) {
-      auto optInstr = m_instruments.find_item(instrument);
-      assert(optInstr.has_value());
+      auto optInstr = isIncremental ? changed_price(instrument)
+                                    : latest_price(instrument);
+      // unchanged since the last check, or not in the shared table
       if (!optInstr.has_value())
         continue;
 
-      if (m_comparator(instrument.currentPrice, optInstr->currentPrice))
-        result.tokens.emplace_back(instrument.name, instrument.currentPrice,
-                                   instrument.open24h);
+      // current against target: at or below it going down, at or above it
+      // going up
+      if (m_comparator(optInstr->currentPrice, instrument.currentPrice))
+        result.tokens.emplace_back(instrument.name,
+                                   instrument.currentPrice.to_double(),
+                                   instrument.open24h.to_double());
     }
 
     if (!result.tokens.empty()) {
@@ -129,7 +208,7 @@ public:
     }
 
     // then stop the run when the snapshot's empty
-    if (m_snapshots.empty())
+    if (m_snapshots.empty() && m_pendingTokens.empty())
       return stop();
     next_timer();
   }
@@ -141,7 +220,11 @@ public:
     }
   }
 
-  ~progress_based_watch_price_impl_t() { stop(); }
+  ~progress_based_watch_price_impl_t() {
+    stop();
+    price_subscriptions_t::instance().unwatch(m_task.exchange,
+                                              m_task.tradeType, m_task.tokens);
+  }
 };
 
 progress_based_watch_price_t::progress_based_watch_price_t(
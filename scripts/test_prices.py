@@ -1,5 +1,5 @@
 from typing import Dict, List, Any
-import random, string, json
+import random, string, json, subprocess
 import requests
 import time
 
@@ -199,6 +199,68 @@ def test_getting_price():
 			print(f"{data['name']} -> {data['price']} -> {data['type']} ({exchange_name})")
 
 
+def test_trading_pairs_not_modified():
+    # the list's ETag doubles as its `since` token, and a client sending
+    # both for a list that hasn't changed gets a 304 either way
+    url = "http://localhost:3421/trading_pairs/binance"
+    response = requests.get(url)
+    response.raise_for_status()
+    etag = response.headers.get("ETag")
+    if etag is None:
+        print("No ETag, the server reads the shared price table")
+        return
+    for query in [{}, {"since": etag.strip('"')}]:
+        response = requests.get(url, params=query,
+                                headers={"If-None-Match": etag})
+        # a symbol the feed saw in between changes the list and its ETag
+        if response.status_code == 200:
+            assert response.headers.get("ETag") != etag
+            continue
+        assert response.status_code == 304, response.status_code
+        assert response.headers.get("ETag") == etag
+
+
+def start_watching_progress_results():
+    # the progress tasks' results go to the result stream over the system bus
+    match = ("interface='keep.my.journal.prices.interface.result',"
+             "member='broadcast_progress_price_result'")
+    return subprocess.Popen(["dbus-monitor", "--system", match],
+                            stdout=subprocess.PIPE, text=True)
+
+
+def test_progress_tasks_at_snapshot_price():
+    # a task only fires once the price has moved by its percentage, so one
+    # asking for a 50% move either way stays quiet for a few seconds
+    symbols = [token["name"] for token in global_tokens["binance"]
+               if token["type"] == "spot"][:5]
+    assert len(symbols) != 0
+    user_id = generate_random_string(15)
+    tasks = []
+    monitor = start_watching_progress_results()
+    for direction in ["up", "down"]:
+        task_id = generate_random_string(20)
+        send_pricing_task({
+            "task_id": task_id,
+            "user_id": user_id,
+            "contracts": [{
+                "symbols": symbols,
+                "trade": "spot",
+                "exchange": "binance",
+                "percentage": 50.0,
+                "direction": direction,
+            }],
+        })
+        tasks.append(DataF(task_id, 1))
+
+    print("Waiting 10 seconds for progress results...")
+    time.sleep(10)
+    stop_task(user_id, tasks)
+    monitor.terminate()
+    results, _ = monitor.communicate()
+    for task in tasks:
+        assert task.task_id not in results, f"{task.task_id} fired at once"
+
+
 def main():
     user_tasks: Dict[str, List[DataF]] = {}
     total_tasks = 10
@@ -215,6 +277,8 @@ def main():
 
     check_user_task_matches(user_tasks)
     test_getting_price()
+    test_trading_pairs_not_modified()
+    test_progress_tasks_at_snapshot_price()
 
 if __name__ == "__main__":
     get_all_tokens()
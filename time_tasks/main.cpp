@@ -1,21 +1,48 @@
+#include <CLI/CLI11.hpp>
+
 #include "dbus/time_task_adaptor.hpp"
+#include "price_stream/price_feed_client.hpp"
+#include "price_stream/shared_price_table.hpp"
 
 using keep_my_journal::instrument_exchange_set_t;
 instrument_exchange_set_t uniqueInstruments{};
 
 namespace keep_my_journal {
-void monitor_tokens_latest_prices(bool &isRunning);
 void result_sender_callback(bool &);
 } // namespace keep_my_journal
 
-int main() {
+int main(int argc, char *argv[]) {
+  CLI::App cli_parser{"runs the time-based price tasks"};
+  bool sharedPrices = false;
+  cli_parser.add_flag("--shared-prices", sharedPrices,
+                      "read the latest prices from price_monitor's shared "
+                      "tables instead of subscribing to them");
+  bool binaryPrices = false;
+  cli_parser.add_flag("--binary-prices", binaryPrices,
+                      "subscribe to price_monitor's binary price format "
+                      "rather than msgpack");
+  CLI11_PARSE(cli_parser, argc, argv)
+
   bool isRunning = true;
-  // connect to the price watching process and get the latest prices from the
-  // price_stream
-  std::thread{[&isRunning] {
-    // defined in latest_prices_watcher.cpp
-    keep_my_journal::monitor_tokens_latest_prices(isRunning);
-  }}.detach();
+  if (sharedPrices) {
+    keep_my_journal::shared_price_tables_t::instance().enable();
+  } else {
+    // connect to the price watching process and get the latest prices of
+    // the symbols the tasks watch from the price_stream
+    keep_my_journal::price_feed_options_t options{};
+    options.name = "time_tasks";
+    options.format = binaryPrices
+                         ? keep_my_journal::price_wire_format_e::binary
+                         : keep_my_journal::price_wire_format_e::msgpack;
+    options.wholeFeed = false;
+    std::thread{[&isRunning, options] {
+      // every exchange's feed, on this one thread
+      zmq::context_t context{1};
+      keep_my_journal::price_feed_client_t client(context, uniqueInstruments,
+                                                  options);
+      client.run(isRunning);
+    }}.detach();
+  }
 
   std::thread{[&isRunning] {
     // defined in time_based_watch.cpp
@@ -1,6 +1,9 @@
 #include "time_based_watch.hpp"
 #include "dbus/use_cases/price_task_result_client_impl.hpp"
 #include "price_stream/adaptor/commodity_adaptor.hpp"
+#include "price_stream/instrument_store.hpp"
+#include "price_stream/price_subscriptions.hpp"
+#include "price_stream/shared_price_table.hpp"
 
 #include <boost/asio/deadline_timer.hpp>
 #include <thread>
@@ -26,9 +29,12 @@ inline void send_price_task_result(scheduled_time_task_result_t &&res) {
 class time_based_watch_price_t::time_based_watch_price_impl_t
     : public std::enable_shared_from_this<time_based_watch_price_impl_t> {
   net::io_context &m_ioContext;
-  utils::unique_elements_t<instrument_type_t> &m_instruments;
+  instrument_store_t &m_instruments;
   scheduled_price_task_t const m_task;
   dbus::adaptor::dbus_time_task_t const m_dbusTask;
+  // the tokens' prices as of the last fire, and the store's sequence then
+  std::vector<instrument_type_t> m_prices;
+  std::uint64_t m_pricesSequence = 0;
   std::optional<net::deadline_timer> m_timer = std::nullopt;
 
   void next_timer();
@@ -38,9 +44,16 @@ public:
                                 scheduled_price_task_t const &task)
       : m_ioContext(ioContext), m_instruments(uniqueInstruments[task.exchange]),
         m_task(task),
-        m_dbusTask(dbus::adaptor::scheduled_task_to_dbus_time(task)) {}
+        m_dbusTask(dbus::adaptor::scheduled_task_to_dbus_time(task)) {
+    price_subscriptions_t::instance().watch(task.exchange, task.tradeType,
+                                            task.tokens);
+  }
 
-  ~time_based_watch_price_impl_t() { stop(); }
+  ~time_based_watch_price_impl_t() {
+    stop();
+    price_subscriptions_t::instance().unwatch(m_task.exchange,
+                                              m_task.tradeType, m_task.tokens);
+  }
   scheduled_price_task_t task_data() const { return m_task; }
 
   void call();
@@ -63,22 +76,26 @@ void time_based_watch_price_t::time_based_watch_price_impl_t::next_timer() {
 }
 
 void time_based_watch_price_t::time_based_watch_price_impl_t::fetch_prices() {
-  auto const instruments = m_instruments.to_list();
-  scheduled_time_task_result_t data;
-  data.tokens.reserve(m_task.tokens.size());
-
-  for (auto const &instrument : m_task.tokens) {
-    auto const iter =
-        std::find_if(instruments.cbegin(), instruments.cend(),
-                     [instrument, this](instrument_type_t const &instr) {
-                       return instr.tradeType == m_task.tradeType &&
-                              instr.name == instrument;
-                     });
-    if (iter != instruments.cend()) {
-      data.tokens.emplace_back(iter->name, iter->currentPrice, iter->open24h);
-    }
+  // only the task's tokens are read, those without a price are left out
+  if (auto &tables = shared_price_tables_t::instance(); tables.is_enabled()) {
+    if (auto const table = tables.get(m_task.exchange); table)
+      table->find_all(m_task.tradeType, m_task.tokens, m_prices);
+    else
+      m_prices.clear();
+  } else if (auto const sequence = m_instruments.sequence();
+             sequence != m_pricesSequence) {
+    // otherwise nothing was stored since the last fire, its prices stand
+    m_instruments.find_all(m_task.tradeType, m_task.tokens, m_prices);
+    m_pricesSequence = sequence;
   }
 
+  scheduled_time_task_result_t data;
+  data.tokens.reserve(m_prices.size());
+  for (auto const &instrument : m_prices)
+    data.tokens.emplace_back(instrument.name,
+                             instrument.currentPrice.to_double(),
+                             instrument.open24h.to_double());
+
   if (!data.tokens.empty()) {
     data.task = m_dbusTask;
     send_price_task_result(std::move(data));